@@ -125,6 +125,14 @@ def define_options(parser):
         help="Recycle latency for ruby controller input buffers",
     )
 
+    parser.add_argument(
+        "--ruby-transition-sample-period",
+        type=int,
+        default=0,
+        help="Profile one out of this many SLICC transitions of each "
+        "controller, 0 disables the transition profiler",
+    )
+
     protocol = buildEnv["PROTOCOL"]
     exec(f"from . import {protocol}")
     eval(f"{protocol}.define_options(parser)")
@@ -294,6 +302,7 @@ def create_system(
     ruby.number_of_virtual_networks = ruby.network.number_of_virtual_networks
     ruby._cpu_ports = cpu_sequencers
     ruby.num_of_sequencers = len(cpu_sequencers)
+    ruby.transition_sample_period = options.ruby_transition_sample_period
 
     # Create a backing copy of physical memory in case required
     if options.access_backing_store:
@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/binary_trace.hh"
+
+#include <algorithm>
+#include <sstream>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+
+namespace gem5
+{
+
+namespace trace
+{
+
+namespace
+{
+
+/** Marker telling whether a trace was written in host byte order. */
+constexpr uint32_t byteOrderMark = 0x01020304;
+
+std::atomic<uint32_t> nextGeneration{1};
+
+template <typename T>
+void
+write(std::ostream &os, const T &value)
+{
+    os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void
+writeString(std::ostream &os, const char *s, uint32_t len)
+{
+    write(os, len);
+    os.write(s, len);
+}
+
+template <typename T>
+bool
+read(std::istream &is, T &value)
+{
+    return bool(is.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+bool
+readString(std::istream &is, std::string &s)
+{
+    uint32_t len;
+    if (!read(is, len))
+        return false;
+    s.resize(len);
+    return bool(is.read(s.data(), len));
+}
+
+/** Bounds checked reader of the entries of a chunk. */
+class ChunkReader
+{
+  private:
+    const char *pos;
+    const char *const end;
+
+  public:
+    ChunkReader(const std::vector<char> &chunk)
+        : pos(chunk.data()), end(chunk.data() + chunk.size())
+    {}
+
+    bool done() const { return pos == end; }
+
+    template <typename T>
+    bool
+    get(T &value)
+    {
+        if (size_t(end - pos) < sizeof(value))
+            return false;
+        std::memcpy(&value, pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+
+    bool
+    getString(std::string &s)
+    {
+        uint32_t len;
+        if (!get(len) || size_t(end - pos) < len)
+            return false;
+        s.assign(pos, len);
+        pos += len;
+        return true;
+    }
+};
+
+template <typename T>
+bool
+addArg(ChunkReader &reader, cp::Print &print)
+{
+    T value;
+    if (!reader.get(value))
+        return false;
+    print.addArg(value);
+    return true;
+}
+
+/** Decode an argument and pass it to cprintf as its original type. */
+bool
+decodeArg(ChunkReader &reader, cp::Print &print)
+{
+    uint8_t type;
+    if (!reader.get(type))
+        return false;
+
+    switch (type) {
+      case BinaryTrace::BoolArg:
+        return addArg<bool>(reader, print);
+      case BinaryTrace::CharArg:
+        return addArg<char>(reader, print);
+      case BinaryTrace::SignedCharArg:
+        return addArg<signed char>(reader, print);
+      case BinaryTrace::UnsignedCharArg:
+        return addArg<unsigned char>(reader, print);
+      case BinaryTrace::ShortArg:
+        return addArg<short>(reader, print);
+      case BinaryTrace::UnsignedShortArg:
+        return addArg<unsigned short>(reader, print);
+      case BinaryTrace::IntArg:
+        return addArg<int>(reader, print);
+      case BinaryTrace::UnsignedIntArg:
+        return addArg<unsigned int>(reader, print);
+      case BinaryTrace::LongArg:
+        return addArg<long>(reader, print);
+      case BinaryTrace::UnsignedLongArg:
+        return addArg<unsigned long>(reader, print);
+      case BinaryTrace::LongLongArg:
+        return addArg<long long>(reader, print);
+      case BinaryTrace::UnsignedLongLongArg:
+        return addArg<unsigned long long>(reader, print);
+      case BinaryTrace::FloatArg:
+        return addArg<float>(reader, print);
+      case BinaryTrace::DoubleArg:
+        return addArg<double>(reader, print);
+      case BinaryTrace::CStringArg:
+      case BinaryTrace::StringArg:
+        {
+            std::string s;
+            if (!reader.getString(s))
+                return false;
+            if (type == BinaryTrace::CStringArg)
+                print.addArg(s.c_str());
+            else
+                print.addArg(s);
+            return true;
+        }
+      default:
+        return false;
+    }
+}
+
+} // anonymous namespace
+
+BinaryTrace::Buffer::~Buffer()
+{
+    if (!owner)
+        return;
+
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    owner->writeChunk(*this);
+    auto &list = owner->buffers;
+    list.erase(std::find(list.begin(), list.end(), this));
+}
+
+int
+BinaryTrace::LineBuffer::overflow(int c)
+{
+    if (c == traits_type::eof())
+        return traits_type::not_eof(c);
+    line += traits_type::to_char_type(c);
+    if (c == '\n')
+        sync();
+    return c;
+}
+
+std::streamsize
+BinaryTrace::LineBuffer::xsputn(const char *s, std::streamsize n)
+{
+    for (std::streamsize i = 0; i < n; ++i)
+        overflow(traits_type::to_int_type(s[i]));
+    return n;
+}
+
+int
+BinaryTrace::LineBuffer::sync()
+{
+    if (!line.empty()) {
+        trace.recordText(MaxTick, "", "", line);
+        line.clear();
+    }
+    return 0;
+}
+
+BinaryTrace::BinaryTrace(std::ostream &_stream)
+    : stream(_stream), generation(nextGeneration++),
+      lineBuffer(*this), textStream(&lineBuffer)
+{
+    stream.write(magic, sizeof(magic));
+    write(stream, version);
+    write(stream, byteOrderMark);
+}
+
+BinaryTrace::~BinaryTrace()
+{
+    flush();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto *buffer : buffers)
+        buffer->owner = nullptr;
+}
+
+BinaryTrace::Buffer &
+BinaryTrace::local()
+{
+    thread_local Buffer buffer;
+
+    if (GEM5_UNLIKELY(buffer.owner != this)) {
+        if (buffer.owner) {
+            std::lock_guard<std::mutex> lock(buffer.owner->mutex);
+            buffer.owner->writeChunk(buffer);
+            auto &list = buffer.owner->buffers;
+            list.erase(std::find(list.begin(), list.end(), &buffer));
+        }
+        buffer.data.resize(bufferSize);
+        buffer.names.clear();
+        buffer.owner = this;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.push_back(&buffer);
+    }
+    return buffer;
+}
+
+uint64_t
+BinaryTrace::registerSite(CallSite &site, const char *fmt)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint64_t key = site.key.load(std::memory_order_relaxed);
+    if ((key >> 32) == generation)
+        return key;
+
+    // The format is only set once, as other threads may be reading it
+    if (key == 0)
+        site.format = fmt;
+    const uint32_t id = ++numSites;
+
+    stream.put(SiteRecord);
+    write(stream, id);
+    writeString(stream, site.flag, std::strlen(site.flag));
+    writeString(stream, site.format.data(), site.format.size());
+
+    key = (uint64_t(generation) << 32) | id;
+    site.key.store(key, std::memory_order_release);
+    return key;
+}
+
+uint32_t
+BinaryTrace::registerName(Buffer &buffer, const std::string &name)
+{
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [it, inserted] = nameIds.emplace(name, nameIds.size() + 1);
+        id = it->second;
+        if (inserted) {
+            stream.put(NameRecord);
+            write(stream, id);
+            writeString(stream, name.data(), name.size());
+        }
+    }
+
+    // Names are mostly returned by reference from long lived objects,
+    // the cache only grows past the bound if they are temporaries
+    if (buffer.names.size() >= maxCachedNames)
+        buffer.names.clear();
+    buffer.names[&name] = {name, id};
+    return id;
+}
+
+void
+BinaryTrace::makeRoom(Buffer &buffer, size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        writeChunk(buffer);
+    }
+    if (size > buffer.data.size())
+        buffer.data.resize(size);
+}
+
+void
+BinaryTrace::writeChunk(Buffer &buffer)
+{
+    if (buffer.used == 0)
+        return;
+
+    stream.put(ChunkRecord);
+    write(stream, uint32_t(buffer.used));
+    stream.write(buffer.data.data(), buffer.used);
+    buffer.used = 0;
+}
+
+void
+BinaryTrace::recordText(Tick when, const std::string &name,
+                        const std::string &flag, const std::string &message)
+{
+    Buffer &buffer = local();
+    const uint32_t name_id = nameId(buffer, name);
+    const uint32_t flag_id = nameId(buffer, flag);
+
+    char *p = reserve(buffer, 1 + 8 + 4 + 4 + 4 + message.size());
+    put(p, uint8_t(TextEntry));
+    put(p, uint64_t(when));
+    put(p, name_id);
+    put(p, flag_id);
+    putString(p, message.data(), message.size());
+}
+
+void
+BinaryTrace::flush()
+{
+    textStream.flush();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto *buffer : buffers)
+        writeChunk(*buffer);
+    stream.flush();
+}
+
+bool
+BinaryTrace::decode(std::istream &in, Logger &logger)
+{
+    char file_magic[sizeof(magic)];
+    uint32_t file_version, byte_order;
+    if (!in.read(file_magic, sizeof(file_magic)) ||
+            std::memcmp(file_magic, magic, sizeof(magic)) != 0 ||
+            !read(in, file_version) || file_version != version ||
+            !read(in, byte_order) || byte_order != byteOrderMark) {
+        return false;
+    }
+
+    struct Site
+    {
+        std::string flag;
+        std::string format;
+    };
+
+    // ids start at 1
+    std::vector<Site> sites(1);
+    std::vector<std::string> names(1);
+    std::vector<char> chunk;
+
+    for (int kind = in.get(); kind != EOF; kind = in.get()) {
+        switch (kind) {
+          case SiteRecord:
+            {
+                uint32_t id;
+                Site site;
+                if (!read(in, id) || id != sites.size() ||
+                        !readString(in, site.flag) ||
+                        !readString(in, site.format)) {
+                    return false;
+                }
+                sites.push_back(std::move(site));
+                break;
+            }
+          case NameRecord:
+            {
+                uint32_t id;
+                std::string name;
+                if (!read(in, id) || id != names.size() ||
+                        !readString(in, name)) {
+                    return false;
+                }
+                names.push_back(std::move(name));
+                break;
+            }
+          case ChunkRecord:
+            {
+                uint32_t size;
+                if (!read(in, size))
+                    return false;
+                chunk.resize(size);
+                if (!in.read(chunk.data(), size))
+                    return false;
+
+                ChunkReader reader(chunk);
+                while (!reader.done()) {
+                    uint8_t entry;
+                    uint64_t when;
+                    uint32_t name_id;
+                    if (!reader.get(entry) || !reader.get(when))
+                        return false;
+
+                    if (entry == MessageEntry) {
+                        uint32_t site_id;
+                        uint8_t num_args;
+                        if (!reader.get(site_id) || !reader.get(name_id) ||
+                                !reader.get(num_args) ||
+                                site_id == 0 || site_id >= sites.size() ||
+                                name_id == 0 || name_id >= names.size()) {
+                            return false;
+                        }
+
+                        const Site &site = sites[site_id];
+                        std::ostringstream line;
+                        {
+                            cp::Print print(line, site.format);
+                            for (unsigned i = 0; i < num_args; ++i) {
+                                if (!decodeArg(reader, print))
+                                    return false;
+                            }
+                            print.endArgs();
+                        }
+                        logger.logMessage(when, names[name_id], site.flag,
+                                          line.str());
+                    } else if (entry == TextEntry) {
+                        uint32_t flag_id;
+                        std::string message;
+                        if (!reader.get(name_id) || !reader.get(flag_id) ||
+                                !reader.getString(message) ||
+                                name_id == 0 || name_id >= names.size() ||
+                                flag_id == 0 || flag_id >= names.size()) {
+                            return false;
+                        }
+                        logger.logMessage(when, names[name_id],
+                                          names[flag_id], message);
+                    } else {
+                        return false;
+                    }
+                }
+                break;
+            }
+          default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace trace
+} // namespace gem5
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_BINARY_TRACE_HH__
+#define __BASE_BINARY_TRACE_HH__
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/compiler.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace trace
+{
+
+class Logger;
+
+/**
+ * Static state of a DPRINTF call site. A site is registered with a
+ * binary trace the first time it logs a message to it, which records
+ * its format string and flag once, so that the messages that follow
+ * only have to record the site id and the raw arguments.
+ */
+struct CallSite
+{
+    /** Name of the debug flag of the site, empty if it has none. */
+    const char *const flag;
+
+    /**
+     * Copy of the format string of the site, set when first registered.
+     * Sites logging a runtime format string may pass buffers reused
+     * with other contents, so the format is compared by its contents.
+     */
+    std::string format;
+
+    /**
+     * Generation of the binary trace the site is registered with in
+     * the upper 32 bits, and its id in that trace in the lower ones.
+     */
+    std::atomic<uint64_t> key{0};
+
+    CallSite(const char *_flag) : flag(_flag) {}
+};
+
+/**
+ * Binary encoding of the debug messages. Instead of formatting each
+ * message as it is logged, the tick, the id of the call site, the id
+ * of the object name and the raw arguments are appended to a buffer
+ * private to the logging thread. Full buffers are written to the
+ * output as a single chunk. The format strings and names are written
+ * once, the first time they are used, and decode() later rebuilds the
+ * text exactly as the regular logger would have printed it.
+ *
+ * Messages whose arguments can not be encoded, that is anything else
+ * than the fundamental arithmetic types and strings, as well as the
+ * messages logged without a call site (e.g., DDUMP), are formatted as
+ * usual and stored as text records.
+ *
+ * The file starts with a header, followed by records, each starting
+ * with a one byte kind. Values are stored in host byte order.
+ */
+class BinaryTrace
+{
+  public:
+    /** Kinds of the records of a trace file. */
+    enum RecordKind : uint8_t
+    {
+        SiteRecord = 1,
+        NameRecord,
+        ChunkRecord,
+    };
+
+    /** Kinds of the entries of a chunk. */
+    enum EntryKind : uint8_t
+    {
+        MessageEntry = 1,
+        TextEntry,
+    };
+
+    /** Type tags of the message arguments. */
+    enum ArgType : uint8_t
+    {
+        NoArg = 0,
+        BoolArg,
+        CharArg,
+        SignedCharArg,
+        UnsignedCharArg,
+        ShortArg,
+        UnsignedShortArg,
+        IntArg,
+        UnsignedIntArg,
+        LongArg,
+        UnsignedLongArg,
+        LongLongArg,
+        UnsignedLongLongArg,
+        FloatArg,
+        DoubleArg,
+        CStringArg,
+        StringArg,
+    };
+
+    /** Type tag of an argument type, NoArg if it can not be encoded. */
+    template <typename T>
+    static constexpr ArgType
+    argType()
+    {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>)
+            return BoolArg;
+        else if constexpr (std::is_same_v<U, char>)
+            return CharArg;
+        else if constexpr (std::is_same_v<U, signed char>)
+            return SignedCharArg;
+        else if constexpr (std::is_same_v<U, unsigned char>)
+            return UnsignedCharArg;
+        else if constexpr (std::is_same_v<U, short>)
+            return ShortArg;
+        else if constexpr (std::is_same_v<U, unsigned short>)
+            return UnsignedShortArg;
+        else if constexpr (std::is_same_v<U, int>)
+            return IntArg;
+        else if constexpr (std::is_same_v<U, unsigned int>)
+            return UnsignedIntArg;
+        else if constexpr (std::is_same_v<U, long>)
+            return LongArg;
+        else if constexpr (std::is_same_v<U, unsigned long>)
+            return UnsignedLongArg;
+        else if constexpr (std::is_same_v<U, long long>)
+            return LongLongArg;
+        else if constexpr (std::is_same_v<U, unsigned long long>)
+            return UnsignedLongLongArg;
+        else if constexpr (std::is_same_v<U, float>)
+            return FloatArg;
+        else if constexpr (std::is_same_v<U, double>)
+            return DoubleArg;
+        else if constexpr (std::is_same_v<U, char *> ||
+                           std::is_same_v<U, const char *>)
+            return CStringArg;
+        else if constexpr (std::is_same_v<U, std::string>)
+            return StringArg;
+        else
+            return NoArg;
+    }
+
+  private:
+    /** Messages logged by a thread and not yet written out. */
+    struct Buffer
+    {
+        BinaryTrace *owner = nullptr;
+        std::vector<char> data;
+        size_t used = 0;
+
+        /** Ids of the names recently logged by the thread. */
+        std::unordered_map<const std::string *,
+                           std::pair<std::string, uint32_t>> names;
+
+        ~Buffer();
+    };
+
+    /** Line buffer turning the raw output into text entries. */
+    class LineBuffer : public std::streambuf
+    {
+      private:
+        BinaryTrace &trace;
+        std::string line;
+
+      protected:
+        int overflow(int c) override;
+        std::streamsize xsputn(const char *s, std::streamsize n) override;
+        int sync() override;
+
+      public:
+        LineBuffer(BinaryTrace &_trace) : trace(_trace) {}
+    };
+
+    /** Size of the buffer of each thread. */
+    static constexpr size_t bufferSize = 1 << 20;
+
+    /** Size of the fixed part of a message entry. */
+    static constexpr size_t messageSize = 1 + 8 + 4 + 4 + 1;
+
+    std::ostream &stream;
+
+    /** Generation of this trace, used to tell if a site is registered. */
+    const uint32_t generation;
+
+    /** Protects the stream and everything below. */
+    std::mutex mutex;
+
+    uint32_t numSites = 0;
+    std::unordered_map<std::string, uint32_t> nameIds;
+    std::vector<Buffer *> buffers;
+
+    LineBuffer lineBuffer;
+    std::ostream textStream;
+
+    /** Bound on the number of names cached by each thread. */
+    static constexpr size_t maxCachedNames = 4096;
+
+    /** Buffer of the calling thread, bound to this trace. */
+    Buffer &local();
+
+    uint64_t registerSite(CallSite &site, const char *fmt);
+    uint32_t registerName(Buffer &buffer, const std::string &name);
+    void makeRoom(Buffer &buffer, size_t size);
+
+    /** Write the contents of a buffer as a chunk, with the lock held. */
+    void writeChunk(Buffer &buffer);
+
+    /** Id of a name, names are cached by address by each thread. */
+    uint32_t
+    nameId(Buffer &buffer, const std::string &name)
+    {
+        auto it = buffer.names.find(&name);
+        if (GEM5_LIKELY(it != buffer.names.end() &&
+                        it->second.first == name)) {
+            return it->second.second;
+        }
+        return registerName(buffer, name);
+    }
+
+    /** Space for an entry of the given size at the end of a buffer. */
+    char *
+    reserve(Buffer &buffer, size_t size)
+    {
+        if (GEM5_UNLIKELY(buffer.used + size > buffer.data.size()))
+            makeRoom(buffer, size);
+        char *p = buffer.data.data() + buffer.used;
+        buffer.used += size;
+        return p;
+    }
+
+    template <typename T>
+    static void
+    put(char *&p, const T &value)
+    {
+        std::memcpy(p, &value, sizeof(value));
+        p += sizeof(value);
+    }
+
+    static void
+    putString(char *&p, const char *s, uint32_t len)
+    {
+        put(p, len);
+        std::memcpy(p, s, len);
+        p += len;
+    }
+
+    /** Add the encoded size of an argument, false if it has none. */
+    template <typename T>
+    static bool
+    argSize(const T &arg, size_t &size)
+    {
+        constexpr ArgType type = argType<T>();
+        if constexpr (type == CStringArg) {
+            // cprintf does not handle null strings either, leave them
+            // to the text path
+            if constexpr (std::is_pointer_v<T>) {
+                if (!arg)
+                    return false;
+            }
+            size += 1 + 4 + std::strlen(arg);
+        } else if constexpr (type == StringArg) {
+            size += 1 + 4 + arg.size();
+        } else {
+            size += 1 + sizeof(T);
+        }
+        return true;
+    }
+
+    template <typename T>
+    static void
+    putArg(char *&p, const T &arg)
+    {
+        constexpr ArgType type = argType<T>();
+        put(p, uint8_t(type));
+        if constexpr (type == CStringArg)
+            putString(p, arg, std::strlen(arg));
+        else if constexpr (type == StringArg)
+            putString(p, arg.data(), arg.size());
+        else
+            put(p, arg);
+    }
+
+  public:
+    /** Magic string at the start of a trace file. */
+    static constexpr char magic[8] = {'g', 'e', 'm', '5', 'd', 'b', 't', 'r'};
+
+    /** Version of the file format. */
+    static constexpr uint32_t version = 1;
+
+    BinaryTrace(std::ostream &_stream);
+    ~BinaryTrace();
+
+    /**
+     * Record a message from a call site. Returns false if the message
+     * can not be encoded, in which case it should be logged as text.
+     */
+    template <typename ...Args>
+    bool
+    record(CallSite &site, Tick when, const std::string &name,
+           const char *fmt, const Args &...args)
+    {
+        if constexpr (((argType<Args>() != NoArg) && ...) &&
+                      sizeof...(Args) < 256) {
+            uint64_t key = site.key.load(std::memory_order_acquire);
+            if (GEM5_UNLIKELY((key >> 32) != generation))
+                key = registerSite(site, fmt);
+            // sites logging runtime format strings are only recorded
+            // with the format they were registered with
+            if (GEM5_UNLIKELY(std::strcmp(site.format.c_str(), fmt) != 0))
+                return false;
+
+            size_t size = messageSize;
+            if (!(argSize(args, size) && ...))
+                return false;
+
+            Buffer &buffer = local();
+            const uint32_t site_id = key;
+            const uint32_t name_id = nameId(buffer, name);
+            char *p = reserve(buffer, size);
+            put(p, uint8_t(MessageEntry));
+            put(p, uint64_t(when));
+            put(p, site_id);
+            put(p, name_id);
+            put(p, uint8_t(sizeof...(Args)));
+            (putArg(p, args), ...);
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    /** Record a message that has already been formatted. */
+    void recordText(Tick when, const std::string &name,
+                    const std::string &flag, const std::string &message);
+
+    /** Stream recording the data written to it as text entries. */
+    std::ostream &output() { return textStream; }
+
+    /**
+     * Write out the messages buffered by all the threads. This must
+     * not be called while other threads are logging messages.
+     */
+    void flush();
+
+    /**
+     * Decode a binary trace, passing the messages to a logger as if
+     * they were being logged now.
+     *
+     * @param in Stream to read the trace from
+     * @param logger Logger to pass the messages to
+     * @return false if the trace is malformed or truncated
+     */
+    static bool decode(std::istream &in, Logger &logger);
+};
+
+} // namespace trace
+} // namespace gem5
+
+#endif // __BASE_BINARY_TRACE_HH__
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/binary_trace.hh"
+#include "base/gtest/cur_tick_fake.hh"
+#include "base/trace.hh"
+
+using namespace gem5;
+
+// Instantiate the mock class to have a valid curTick of 0
+GTestTickHandler tickHandler;
+
+namespace
+{
+
+trace::CallSite intSite("IntFlag");
+trace::CallSite mixedSite("MixedFlag");
+trace::CallSite stringSite("StringFlag");
+trace::CallSite widthSite("");
+trace::CallSite objectSite("ObjectFlag");
+
+struct Unencodable
+{
+    int value;
+};
+
+std::ostream &
+operator<<(std::ostream &os, const Unencodable &u)
+{
+    return os << "<" << u.value << ">";
+}
+
+/** Log the same set of messages to a logger. */
+void
+logMessages(trace::Logger &logger)
+{
+    const std::string obj("system.cpu");
+    const std::string text("a string");
+    char buf[] = "a buffer";
+
+    for (int i = 0; i < 100; ++i) {
+        logger.dprintf_site(intSite, Tick(i), obj, "Value %d %#x\n",
+                            i, uint64_t(i) << 32);
+    }
+    logger.dprintf_site(mixedSite, Tick(1000), obj,
+        "%c %s %5.2f %f %u %lld %d %d\n", 'x', true, 3.14159f, 2.5,
+        uint8_t(200), -5LL, int16_t(-3), uint64_t(-1));
+    logger.dprintf_site(stringSite, Tick(1001), "other",
+        "%s|%10s|%-10s|%s\n", text, "literal", buf,
+        static_cast<const char *>(buf));
+    logger.dprintf_site(widthSite, MaxTick, "", "%*d|%.*f\n",
+                        8, 42, 3, 1.23456);
+    logger.dprintf_site(objectSite, Tick(1002), obj, "object %s %d\n",
+                        Unencodable{7}, 8);
+    logger.logMessage(Tick(1004), obj, "TextFlag", "formatted text\n");
+    logger.getOstream() << "raw output" << std::endl;
+    logger.dump(Tick(1005), obj, "0123456789abcdefghij", 20, "DumpFlag");
+}
+
+} // anonymous namespace
+
+/** Decoding a binary trace gives back the text of the regular logger. */
+TEST(BinaryTraceTest, RoundTrip)
+{
+    std::stringstream expected;
+    trace::OstreamLogger text_logger(expected);
+    logMessages(text_logger);
+
+    std::stringstream binary;
+    {
+        trace::BinaryLogger logger(binary);
+        logMessages(logger);
+        logger.flush();
+    }
+
+    std::stringstream decoded;
+    trace::OstreamLogger decode_logger(decoded);
+    EXPECT_TRUE(trace::BinaryTrace::decode(binary, decode_logger));
+    EXPECT_EQ(expected.str(), decoded.str());
+
+    // The messages are stored in binary form, the trace is smaller
+    EXPECT_LT(binary.str().size(), expected.str().size());
+}
+
+/** Each trace registers the sites it uses, even if used before. */
+TEST(BinaryTraceTest, SeveralTraces)
+{
+    std::stringstream expected;
+    trace::OstreamLogger text_logger(expected);
+    logMessages(text_logger);
+
+    for (int i = 0; i < 2; ++i) {
+        std::stringstream binary;
+        trace::BinaryLogger logger(binary);
+        logMessages(logger);
+        logger.flush();
+
+        std::stringstream decoded;
+        trace::OstreamLogger decode_logger(decoded);
+        EXPECT_TRUE(trace::BinaryTrace::decode(binary, decode_logger));
+        EXPECT_EQ(expected.str(), decoded.str());
+    }
+}
+
+/** A site logging different format strings falls back to text. */
+TEST(BinaryTraceTest, RuntimeFormat)
+{
+    static trace::CallSite site("Flag");
+    const std::string obj("obj");
+    const std::string formats[] = {"first %d\n", "second %d\n"};
+
+    std::stringstream binary;
+    trace::BinaryLogger logger(binary);
+    for (int i = 0; i < 4; ++i)
+        logger.dprintf_site(site, Tick(i), obj, formats[i % 2].c_str(), i);
+    logger.flush();
+
+    std::stringstream decoded;
+    trace::OstreamLogger decode_logger(decoded);
+    EXPECT_TRUE(trace::BinaryTrace::decode(binary, decode_logger));
+    EXPECT_EQ("      0: obj: first 0\n      1: obj: second 1\n"
+              "      2: obj: first 2\n      3: obj: second 3\n",
+              decoded.str());
+}
+
+/** A runtime format rebuilt in the same buffer is not mistaken. */
+TEST(BinaryTraceTest, RuntimeFormatSameBuffer)
+{
+    static trace::CallSite site("Flag");
+    const std::string obj("obj");
+    char format[32];
+
+    std::stringstream binary;
+    trace::BinaryLogger logger(binary);
+    for (int i = 0; i < 4; ++i) {
+        std::strcpy(format, i % 2 ? "odd %d\n" : "even %d\n");
+        logger.dprintf_site(site, Tick(i), obj, format, i);
+    }
+    logger.flush();
+
+    std::stringstream decoded;
+    trace::OstreamLogger decode_logger(decoded);
+    EXPECT_TRUE(trace::BinaryTrace::decode(binary, decode_logger));
+    EXPECT_EQ("      0: obj: even 0\n      1: obj: odd 1\n"
+              "      2: obj: even 2\n      3: obj: odd 3\n",
+              decoded.str());
+}
+
+/** Messages logged by several threads are all recorded. */
+TEST(BinaryTraceTest, Threads)
+{
+    static trace::CallSite site("Flag");
+    const int num_threads = 4;
+    const int num_messages = 100000;
+
+    std::stringstream binary;
+    trace::BinaryLogger logger(binary);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&logger, t]() {
+            const std::string obj = "thread" + std::to_string(t);
+            for (int i = 0; i < num_messages; ++i)
+                logger.dprintf_site(site, Tick(i), obj, "message %d\n", i);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    logger.flush();
+
+    std::stringstream decoded;
+    trace::OstreamLogger decode_logger(decoded);
+    EXPECT_TRUE(trace::BinaryTrace::decode(binary, decode_logger));
+
+    std::vector<int> counts(num_threads, 0);
+    std::string line;
+    while (std::getline(decoded, line)) {
+        auto pos = line.find("thread");
+        ASSERT_NE(std::string::npos, pos);
+        counts[line[pos + 6] - '0']++;
+    }
+    for (int t = 0; t < num_threads; ++t)
+        EXPECT_EQ(num_messages, counts[t]);
+}
+
+/** Truncated and foreign files are reported as malformed. */
+TEST(BinaryTraceTest, Malformed)
+{
+    std::stringstream binary;
+    {
+        trace::BinaryLogger logger(binary);
+        logMessages(logger);
+        logger.flush();
+    }
+    const std::string data = binary.str();
+
+    std::stringstream decoded;
+    trace::OstreamLogger decode_logger(decoded);
+
+    std::istringstream truncated(data.substr(0, data.size() - 3));
+    EXPECT_FALSE(trace::BinaryTrace::decode(truncated, decode_logger));
+
+    std::istringstream text("this is not a binary trace\n");
+    EXPECT_FALSE(trace::BinaryTrace::decode(text, decode_logger));
+}
@@ -86,6 +86,7 @@ allFlags()
 }
 
 bool Flag::_globalEnable = false;
+bool Flag::_windowOpen = true;
 
 Flag *
 findFlag(const std::string &name)
@@ -129,6 +130,22 @@ Flag::globalDisable()
         i.second->sync();
 }
 
+void
+Flag::windowOpen()
+{
+    _windowOpen = true;
+    for (auto& i : allFlags())
+        i.second->sync();
+}
+
+void
+Flag::windowClose()
+{
+    _windowOpen = false;
+    for (auto& i : allFlags())
+        i.second->sync();
+}
+
 SimpleFlag::SimpleFlag(const char *name, const char *desc, bool is_format)
   : Flag(name, desc), _isFormat(is_format)
 {
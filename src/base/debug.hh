@@ -62,6 +62,7 @@ class Flag
 {
   protected:
     static bool _globalEnable; // whether debug tracings are enabled
+    static bool _windowOpen; // whether the trace window is open
 
     bool _tracing = false; // tracing is enabled and flag is on
 
@@ -86,6 +87,14 @@ class Flag
 
     static void globalEnable();
     static void globalDisable();
+
+    /**
+     * Open or close the trace window. While it is closed no flag is
+     * tracing, so that restricting the trace to a window costs nothing
+     * outside of it, the flags are only updated when it is flipped.
+     */
+    static void windowOpen();
+    static void windowClose();
 };
 
 class SimpleFlag : public Flag
@@ -96,7 +105,11 @@ class SimpleFlag : public Flag
 
     bool _enabled = false; // flag enablement status
 
-    void sync() override { _tracing = _globalEnable && _enabled; }
+    void
+    sync() override
+    {
+        _tracing = _globalEnable && _windowOpen && _enabled;
+    }
 
   public:
     SimpleFlag(const char *name, const char *desc, bool is_format=false);
@@ -99,6 +99,36 @@ TEST(DebugSimpleFlagTest, Enabled)
     ASSERT_FALSE(flag.tracing());
 }
 
+/** Test that flags only trace while the trace window is open. */
+TEST(DebugSimpleFlagTest, Window)
+{
+    debug::Flag::globalEnable();
+    debug::SimpleFlag flag("SimpleFlagWindowTest", "");
+    flag.enable();
+    ASSERT_TRUE(!TRACING_ON || flag.tracing());
+
+    debug::Flag::windowClose();
+    ASSERT_FALSE(flag.tracing());
+
+    // Flags enabled while the window is closed do not trace either
+    debug::SimpleFlag other("SimpleFlagWindowTestOther", "");
+    other.enable();
+    ASSERT_FALSE(other.tracing());
+
+    debug::Flag::windowOpen();
+    ASSERT_TRUE(!TRACING_ON || flag.tracing());
+    ASSERT_TRUE(!TRACING_ON || other.tracing());
+
+    // The window and the global enabler are independent
+    debug::Flag::globalDisable();
+    ASSERT_FALSE(flag.tracing());
+    debug::Flag::windowClose();
+    debug::Flag::globalEnable();
+    ASSERT_FALSE(flag.tracing());
+    debug::Flag::windowOpen();
+    ASSERT_TRUE(!TRACING_ON || flag.tracing());
+}
+
 /**
  * Tests that manipulate the enablement status of the compound flag to change
  * the corresponding status of the kids.
@@ -210,6 +210,13 @@ class RefCountingPtr
     template <bool B = TisConst>
     RefCountingPtr(const NonConstT &r) { copy(r.data); }
 
+    /// Create a new reference counting pointer to a base class of the
+    /// object held by another one.  Adds a reference.
+    template <class U, typename = std::enable_if_t<
+        !std::is_same_v<std::remove_const_t<U>, std::remove_const_t<T>> &&
+        std::is_convertible_v<U *, T *>>>
+    RefCountingPtr(const RefCountingPtr<U> &r) { copy(r.get()); }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
@@ -70,6 +70,11 @@ class TestRC : public RefCounted
 };
 typedef RefCountingPtr<TestRC> Ptr;
 
+class DerivedTestRC : public TestRC
+{
+};
+typedef RefCountingPtr<DerivedTestRC> DerivedPtr;
+
 } // anonymous namespace
 
 TEST(RefcntTest, NullPointerCheck)
@@ -172,3 +177,16 @@ TEST(RefcntTest, EqualityOperators)
     EXPECT_TRUE(equalTestAPtr != equalTestB);
     EXPECT_TRUE(equalTestAPtr != equalTestBPtr);
 }
+
+TEST(RefcntTest, ConversionToBase)
+{
+    // Test that a Ptr to a derived class converts to a Ptr to its base.
+    DerivedPtr derivedPtr = new DerivedTestRC();
+    Ptr basePtr = derivedPtr;
+    EXPECT_EQ(1, liveListSize());
+    EXPECT_TRUE(basePtr.get() == derivedPtr.get());
+    derivedPtr = NULL;
+    EXPECT_EQ(1, liveListSize());
+    basePtr = NULL;
+    EXPECT_EQ(0, liveListSize());
+}
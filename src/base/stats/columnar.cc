@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/columnar.hh"
+
+#include <cstring>
+#include <sstream>
+
+#include "base/logging.hh"
+#include "base/stats/info.hh"
+#include "base/stats/units.hh"
+#include "sim/cur_tick.hh"
+
+namespace gem5
+{
+
+namespace
+{
+
+/** Append an integer to a buffer in little-endian order. */
+void
+putLE(std::string &buf, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        buf.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+uint64_t
+valueBits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+void
+putString(std::string &buf, const std::string &str)
+{
+    const size_t len = std::min<size_t>(str.size(), UINT16_MAX);
+    putLE(buf, len, 2);
+    buf.append(str, 0, len);
+}
+
+} // anonymous namespace
+
+namespace statistics
+{
+
+Columnar::Columnar(const std::string &file, bool desc)
+    : os(simout.create(file, true)), stream(os->stream()),
+      enableDescriptions(desc), onlyChanges(true)
+{
+    fatal_if(!stream->good(),
+             "Unable to open statistics file %s for writing\n", file);
+
+    const std::string header = fileHeader();
+    stream->write(header.data(), header.size());
+}
+
+Columnar::Columnar(bool desc, bool only_changes)
+    : os(nullptr), stream(nullptr), enableDescriptions(desc),
+      onlyChanges(only_changes)
+{
+}
+
+std::string
+Columnar::fileHeader()
+{
+    std::string header("gem5stcf");
+    putLE(header, version, 4);
+    return header;
+}
+
+void
+Columnar::begin()
+{
+    // Room for the header of the dump record, filled in at the end
+    changes.assign(dumpHeaderSize, 0);
+    numChanges = 0;
+}
+
+void
+Columnar::end()
+{
+    std::string header;
+    header.push_back(DumpRecord);
+    putLE(header, curTick(), 8);
+    putLE(header, numChanges, 4);
+    assert(header.size() == dumpHeaderSize);
+    changes.replace(0, dumpHeaderSize, header);
+
+    // The columns first dumped now are described ahead of the dump,
+    // they are kept for the next dump if this one is dropped
+    if (writeDump(newColumns, changes))
+        newColumns.clear();
+}
+
+bool
+Columnar::writeDump(const std::string &columns, const std::string &dump)
+{
+    stream->write(columns.data(), columns.size());
+    stream->write(dump.data(), dump.size());
+    stream->flush();
+    return true;
+}
+
+bool
+Columnar::valid() const
+{
+    return stream->good();
+}
+
+void
+Columnar::beginGroup(const char *name)
+{
+    if (path.empty()) {
+        path.push(name);
+    } else {
+        path.push(path.top() + "." + name);
+    }
+}
+
+void
+Columnar::endGroup()
+{
+    assert(!path.empty());
+    path.pop();
+}
+
+std::string
+Columnar::statName(const std::string &name) const
+{
+    if (path.empty())
+        return name;
+    else
+        return path.top() + "." + name;
+}
+
+Columnar::StatColumns &
+Columnar::columns(const Info &info, size_t num_fixed)
+{
+    if (info.id >= (int)statColumns.size())
+        statColumns.resize(info.id + 1);
+    auto &cols = statColumns[info.id];
+    if (!cols)
+        cols = std::make_unique<StatColumns>();
+    if (cols->fixed.size() < num_fixed)
+        cols->fixed.resize(num_fixed, noColumn);
+    return *cols;
+}
+
+template <class Suffix>
+void
+Columnar::record(uint32_t &column, const Info &info, const Suffix &suffix,
+                 Result value)
+{
+    const uint64_t bits = valueBits(value);
+
+    if (column == noColumn) {
+        // The name of a column is only built the first time it is
+        // dumped
+        column = lastValues.size();
+        lastValues.push_back(bits);
+        newColumns.push_back(ColumnRecord);
+        putLE(newColumns, column, 4);
+        putString(newColumns, statName(info.name) + suffix());
+        putString(newColumns, info.unit->getUnitString());
+        putString(newColumns, enableDescriptions ? info.desc : "");
+    } else if (onlyChanges && lastValues[column] == bits) {
+        return;
+    } else {
+        lastValues[column] = bits;
+    }
+
+    putLE(changes, column, 4);
+    putLE(changes, bits, 8);
+    ++numChanges;
+}
+
+void
+Columnar::visit(const ScalarInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    StatColumns &cols = columns(info, 1);
+    record(cols.fixed[0], info, [] { return std::string(); },
+           info.result());
+}
+
+void
+Columnar::visit(const VectorInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    // The total comes first, so that it keeps its column if the size
+    // of the vector changes
+    const VResult &vec = info.result();
+    const size_type size = vec.size();
+    StatColumns &cols = columns(info, size + 1);
+
+    if (info.flags.isSet(statistics::total) && size > 1) {
+        record(cols.fixed[0], info,
+               [&] { return info.separatorString + "total"; },
+               info.total());
+    }
+
+    for (off_type i = 0; i < size; ++i) {
+        auto suffix = [&]
+        {
+            const bool named = i < info.subnames.size() &&
+                !info.subnames[i].empty();
+            if (size == 1 && !named)
+                return std::string();
+            return info.separatorString +
+                (named ? info.subnames[i] : std::to_string(i));
+        };
+        record(cols.fixed[i + 1], info, suffix, vec[i]);
+    }
+}
+
+void
+Columnar::visit(const Vector2dInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    StatColumns &cols = columns(info, info.x * info.y + 1);
+
+    if (info.flags.isSet(statistics::total) && info.x > 1) {
+        record(cols.fixed[0], info,
+               [&] { return info.separatorString + "total"; },
+               info.total());
+    }
+
+    for (off_type i = 0; i < info.x; ++i) {
+        for (off_type j = 0; j < info.y; ++j) {
+            auto suffix = [&]
+            {
+                const bool x_named = i < info.subnames.size() &&
+                    !info.subnames[i].empty();
+                const bool y_named = j < info.y_subnames.size() &&
+                    !info.y_subnames[j].empty();
+                return "_" +
+                    (x_named ? info.subnames[i] : std::to_string(i)) +
+                    info.separatorString +
+                    (y_named ? info.y_subnames[j] : std::to_string(j));
+            };
+            const off_type idx = i * info.y + j;
+            record(cols.fixed[idx + 1], info, suffix, info.cvec[idx]);
+        }
+    }
+}
+
+void
+Columnar::recordDist(const Info &info, StatColumns &cols, size_t first,
+                     const std::string &prefix, const DistData &data)
+{
+    static const char *const fieldNames[] = {
+        "samples", "sum", "squares", "min_value", "max_value",
+        "underflows", "overflows", "min", "bucket_size",
+    };
+    const Result fields[] = {
+        (Result)data.samples, (Result)data.sum, (Result)data.squares,
+        (Result)data.min_val, (Result)data.max_val,
+        (Result)data.underflow, (Result)data.overflow,
+        (Result)data.min, (Result)data.bucket_size,
+    };
+    constexpr size_t num_fields = sizeof(fields) / sizeof(fields[0]);
+
+    for (size_t f = 0; f < num_fields; ++f) {
+        record(cols.fixed[first + f], info,
+               [&] { return prefix + info.separatorString +
+                            fieldNames[f]; },
+               fields[f]);
+    }
+
+    // Buckets are named by their index, the range they cover follows
+    // from the min and bucket_size columns
+    for (size_t b = 0; b < data.cvec.size(); ++b) {
+        record(cols.fixed[first + num_fields + b], info,
+               [&] { return prefix + info.separatorString + "bucket_" +
+                            std::to_string(b); },
+               data.cvec[b]);
+    }
+}
+
+void
+Columnar::visit(const DistInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    StatColumns &cols = columns(info, 9 + info.data.cvec.size());
+    recordDist(info, cols, 0, "", info.data);
+}
+
+void
+Columnar::visit(const VectorDistInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    const size_type size = info.size();
+    if (size == 0)
+        return;
+
+    const size_t stride = 9 + info.data[0].cvec.size();
+    StatColumns &cols = columns(info, size * stride);
+    for (off_type i = 0; i < size; ++i) {
+        const bool named = i < info.subnames.size() &&
+            !info.subnames[i].empty();
+        recordDist(info, cols, i * stride,
+                   "_" + (named ? info.subnames[i] : std::to_string(i)),
+                   info.data[i]);
+    }
+}
+
+void
+Columnar::visit(const FormulaInfo &info)
+{
+    visit((const VectorInfo &)info);
+}
+
+void
+Columnar::visit(const SparseHistInfo &info)
+{
+    if (!info.flags.isSet(display))
+        return;
+
+    StatColumns &cols = columns(info, 1);
+    const SparseHistData &data = info.data;
+
+    record(cols.fixed[0], info,
+           [&] { return info.separatorString + "samples"; },
+           (Result)data.samples);
+
+    auto suffix = [&](Counter key)
+    {
+        std::ostringstream name;
+        name << info.separatorString << key;
+        return name.str();
+    };
+
+    // Values that are no longer sampled, e.g. after a reset, go back
+    // to zero
+    for (auto &[key, column] : cols.sparse) {
+        auto it = data.cmap.find(key);
+        record(column, info, [&] { return suffix(key); },
+               it == data.cmap.end() ? 0.0 : (Result)it->second);
+    }
+    for (const auto &[key, count] : data.cmap) {
+        auto [it, inserted] = cols.sparse.emplace(key, noColumn);
+        if (inserted) {
+            record(it->second, info, [&] { return suffix(key); },
+                   (Result)count);
+        }
+    }
+}
+
+std::unique_ptr<Output>
+initColumnar(const std::string &filename, bool desc)
+{
+    return std::make_unique<Columnar>(filename, desc);
+}
+
+} // namespace statistics
+} // namespace gem5
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_COLUMNAR_HH__
+#define __BASE_STATS_COLUMNAR_HH__
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stack>
+#include <string>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/stats/output.hh"
+#include "base/stats/types.hh"
+
+namespace gem5
+{
+
+namespace statistics
+{
+
+class Info;
+
+/**
+ * Binary columnar stat output. Every value printed by the text output
+ * (a scalar, a vector element, a histogram bucket, ...) is a column.
+ * The name, unit and description of a column are written the first
+ * time it is dumped, and each dump only holds the columns whose value
+ * changed since the previous dump. This makes periodic dumps of large
+ * systems both cheaper to produce and much smaller than text dumps,
+ * and the file can be loaded as a time series with
+ * util/stats_columnar.py.
+ *
+ * All integers are little-endian, and values are IEEE 754 doubles.
+ * The file starts with the 8 byte magic "gem5stcf" and a 32-bit
+ * version, followed by a sequence of records starting with a kind byte:
+ *
+ * - Column: uint32 column id; name, unit and description, each as a
+ *   uint16 length followed by the characters.
+ * - Dump: uint64 tick; uint32 count; count x (uint32 column id,
+ *   double value).
+ *
+ * Column ids are allocated in order from 0, the column record always
+ * comes before the first dump holding the column.
+ */
+class Columnar : public Output
+{
+  public:
+    static constexpr uint32_t version = 1;
+
+    enum RecordKind : uint8_t
+    {
+        ColumnRecord = 1,
+        DumpRecord = 2,
+    };
+
+    /**
+     * @param file Name of the file in the output directory
+     * @param desc Write the descriptions of the columns
+     */
+    Columnar(const std::string &file, bool desc);
+
+    Columnar() = delete;
+    Columnar(const Columnar &other) = delete;
+
+  public: // Output interface
+    void begin() override;
+    void end() override;
+    bool valid() const override;
+
+    void beginGroup(const char *name) override;
+    void endGroup() override;
+
+    void visit(const ScalarInfo &info) override;
+    void visit(const VectorInfo &info) override;
+    void visit(const DistInfo &info) override;
+    void visit(const VectorDistInfo &info) override;
+    void visit(const Vector2dInfo &info) override;
+    void visit(const FormulaInfo &info) override;
+    void visit(const SparseHistInfo &info) override;
+
+  protected:
+    /**
+     * Build an output that does not write to a file, for outputs
+     * sending the records elsewhere by overriding writeDump().
+     *
+     * @param desc Write the descriptions of the columns
+     * @param only_changes Only hold the changed values in each dump,
+     *     rather than all the values dumped
+     */
+    Columnar(bool desc, bool only_changes);
+
+    /** Magic and version starting a stream of records. */
+    static std::string fileHeader();
+
+    /**
+     * Write the records of a dump.
+     *
+     * @param columns Column records of the columns first dumped
+     * @param dump Dump record
+     * @return false if the dump was dropped, in which case the new
+     *     columns are written along with the next dump
+     */
+    virtual bool writeDump(const std::string &columns,
+                           const std::string &dump);
+
+    /** Columns of a stat, allocated as they are first dumped. */
+    struct StatColumns
+    {
+        /** Columns of the values at fixed positions in the stat. */
+        std::vector<uint32_t> fixed;
+        /** Columns of the buckets of a sparse histogram, by value. */
+        std::map<Counter, uint32_t> sparse;
+    };
+
+    /**
+     * Record the value of a column, creating the column if needed.
+     *
+     * @param column Column id, or noColumn if not allocated yet
+     * @param info Stat the column belongs to
+     * @param suffix Callable returning the suffix of the column name
+     *     after the stat name, only called if the column is created
+     * @param value Current value
+     */
+    template <class Suffix>
+    void record(uint32_t &column, const Info &info, const Suffix &suffix,
+                Result value);
+
+    /** Get the columns of a stat, sized for a number of fixed values. */
+    StatColumns &columns(const Info &info, size_t num_fixed);
+
+    /** Record the values of one distribution. */
+    void recordDist(const Info &info, StatColumns &cols, size_t first,
+                    const std::string &prefix, const DistData &data);
+
+    /** Full name of a stat in the current group. */
+    std::string statName(const std::string &name) const;
+
+  protected:
+    static constexpr uint32_t noColumn = UINT32_MAX;
+
+    /** Size of the header of a dump record. */
+    static constexpr size_t dumpHeaderSize = 13;
+
+    /** Output file, closed along with the output directory. */
+    OutputStream *os;
+    std::ostream *stream;
+    const bool enableDescriptions;
+    const bool onlyChanges;
+
+    /** Object/group path. */
+    std::stack<std::string> path;
+
+    /** Columns of each stat, indexed by the stat id. */
+    std::vector<std::unique_ptr<StatColumns>> statColumns;
+
+    /** Bit pattern of the last value recorded for each column. */
+    std::vector<uint64_t> lastValues;
+
+    /** Column records to write before the current dump. */
+    std::string newColumns;
+
+    /** Dump record of the current dump, with the changed values. */
+    std::string changes;
+    uint32_t numChanges = 0;
+};
+
+std::unique_ptr<Output> initColumnar(const std::string &filename,
+                                     bool desc = true);
+
+} // namespace statistics
+} // namespace gem5
+
+#endif // __BASE_STATS_COLUMNAR_HH__
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/dump.hh"
+
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "base/logging.hh"
+#include "base/stats/group.hh"
+#include "base/stats/info.hh"
+#include "base/stats/output.hh"
+#include "sim/cur_tick.hh"
+
+namespace gem5
+{
+
+namespace statistics
+{
+
+namespace
+{
+
+StatFilter dumpFilter;
+
+unsigned dumpThreads = 1;
+
+bool
+matchAny(const std::vector<std::string> &patterns, const std::string &name)
+{
+    for (const auto &pattern : patterns) {
+        if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0)
+            return true;
+    }
+    return false;
+}
+
+/** Stats of a group selected for a dump, and the path to the group. */
+struct DumpNode
+{
+    std::vector<std::string> path;
+    std::vector<Info *> stats;
+};
+
+void
+collectNodes(const Group &group, std::vector<std::string> &path,
+             StatFilter &filter, std::vector<DumpNode> &nodes)
+{
+    DumpNode node;
+    for (Info *info : group.getStats()) {
+        if (filter.selected(*info, path))
+            node.stats.push_back(info);
+    }
+    if (!node.stats.empty()) {
+        node.path = path;
+        nodes.push_back(std::move(node));
+    }
+
+    for (const auto &[name, child] : group.getStatGroups()) {
+        path.push_back(name);
+        collectNodes(*child, path, filter, nodes);
+        path.pop_back();
+    }
+}
+
+void
+dumpSerial(Output &output, const Group &group,
+           std::vector<std::string> &path, bool prepare, StatFilter &filter)
+{
+    for (Info *info : group.getStats()) {
+        if (!filter.selected(*info, path))
+            continue;
+        if (prepare)
+            info->prepare();
+        info->visit(output);
+    }
+
+    for (const auto &[name, child] : group.getStatGroups()) {
+        output.beginGroup(name.c_str());
+        path.push_back(name);
+        dumpSerial(output, *child, path, prepare, filter);
+        path.pop_back();
+        output.endGroup();
+    }
+}
+
+/**
+ * Dump using multiple threads, each formatting part of the groups.
+ * Returns false if the output cannot be split.
+ */
+bool
+dumpParallel(Output &output, const Group &root,
+             std::vector<std::string> &path, bool prepare,
+             StatFilter &filter)
+{
+    std::unique_ptr<Output> first_partial = output.makePartial();
+    if (!first_partial)
+        return false;
+
+    // The selection is done up front, by the calling thread
+    std::vector<DumpNode> nodes;
+    collectNodes(root, path, filter, nodes);
+
+    size_t num_stats = 0;
+    for (const auto &node : nodes)
+        num_stats += node.stats.size();
+
+    // Split the groups in consecutive chunks of a similar number of
+    // stats, a few per thread to balance the load
+    struct Chunk
+    {
+        size_t first, last;
+        std::unique_ptr<Output> partial;
+    };
+    std::vector<Chunk> chunks;
+    const size_t chunk_stats = num_stats / (4 * dumpThreads) + 1;
+    for (size_t i = 0; i < nodes.size();) {
+        const size_t first = i;
+        size_t count = 0;
+        while (i < nodes.size() && count < chunk_stats)
+            count += nodes[i++].stats.size();
+        chunks.push_back({first, i, first_partial ?
+                          std::move(first_partial) : output.makePartial()});
+    }
+
+    // Some stats, e.g. simTicks, are functors of the current tick,
+    // which is thread local: have the workers see the tick of the
+    // calling thread, as if they were bound to its event queue
+    Tick *cur_tick = Gem5Internal::_curTickPtr;
+
+    std::atomic<size_t> next_chunk(0);
+    auto worker = [&]
+    {
+        Gem5Internal::_curTickPtr = cur_tick;
+        for (size_t c = next_chunk++; c < chunks.size(); c = next_chunk++) {
+            Output &partial = *chunks[c].partial;
+            for (size_t n = chunks[c].first; n < chunks[c].last; ++n) {
+                const DumpNode &node = nodes[n];
+                for (const auto &group : node.path)
+                    partial.beginGroup(group.c_str());
+                for (Info *info : node.stats) {
+                    if (prepare)
+                        info->prepare();
+                    info->visit(partial);
+                }
+                for (size_t g = 0; g < node.path.size(); ++g)
+                    partial.endGroup();
+            }
+        }
+    };
+
+    const unsigned num_threads = std::min<size_t>(dumpThreads,
+                                                  chunks.size());
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < num_threads; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+        thread.join();
+
+    for (auto &chunk : chunks)
+        output.mergePartial(*chunk.partial);
+    return true;
+}
+
+} // anonymous namespace
+
+StatFilter::StatFilter(const std::vector<std::string> &patterns)
+{
+    set(patterns);
+}
+
+void
+StatFilter::set(const std::vector<std::string> &patterns)
+{
+    include.clear();
+    exclude.clear();
+    for (const auto &pattern : patterns) {
+        if (!pattern.empty() && pattern[0] == '!')
+            exclude.push_back(pattern.substr(1));
+        else
+            include.push_back(pattern);
+    }
+    selection.clear();
+}
+
+bool
+StatFilter::selected(const Info &info, const std::vector<std::string> &path)
+{
+    if (all())
+        return true;
+
+    if (info.id >= (int)selection.size())
+        selection.resize(info.id + 1, Unknown);
+    uint8_t &state = selection[info.id];
+
+    if (state == Unknown) {
+        std::string name;
+        for (const auto &group : path)
+            name += group + ".";
+        name += info.name;
+
+        const bool included = include.empty() || matchAny(include, name);
+        state = included && !matchAny(exclude, name) ?
+            Selected : Excluded;
+    }
+    return state == Selected;
+}
+
+void
+setDumpFilter(const std::vector<std::string> &patterns)
+{
+    dumpFilter.set(patterns);
+}
+
+void
+setDumpThreads(unsigned threads)
+{
+    fatal_if(threads == 0, "At least one thread is needed to dump stats\n");
+    dumpThreads = threads;
+}
+
+void
+dumpGroup(Output &output, Group &root,
+          const std::vector<std::string> &path, bool prepare)
+{
+    dumpGroup(output, root, path, prepare, dumpFilter);
+}
+
+void
+dumpGroup(Output &output, Group &root,
+          const std::vector<std::string> &path, bool prepare,
+          StatFilter &filter)
+{
+    std::vector<std::string> group_path(path);
+
+    if (dumpThreads > 1 &&
+        dumpParallel(output, root, group_path, prepare, filter)) {
+        return;
+    }
+
+    for (const auto &group : path)
+        output.beginGroup(group.c_str());
+    dumpSerial(output, root, group_path, prepare, filter);
+    for (size_t g = 0; g < path.size(); ++g)
+        output.endGroup();
+}
+
+} // namespace statistics
+} // namespace gem5
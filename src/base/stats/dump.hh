@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_DUMP_HH__
+#define __BASE_STATS_DUMP_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gem5
+{
+
+namespace statistics
+{
+
+class Group;
+class Info;
+struct Output;
+
+/**
+ * Selection of stats by their full name, e.g. "system.cpu*.ipc".
+ * Patterns are shell globs; a pattern starting with '!' excludes the
+ * stats it matches. If there is any including pattern, only the stats
+ * matching one of them are selected. The full name of a stat is only
+ * built and matched the first time it is looked up, as stats do not
+ * move once the simulation has started.
+ */
+class StatFilter
+{
+  public:
+    StatFilter() = default;
+    explicit StatFilter(const std::vector<std::string> &patterns);
+
+    /** Replace the patterns of the filter. */
+    void set(const std::vector<std::string> &patterns);
+
+    /** Check if the filter selects every stat. */
+    bool all() const { return include.empty() && exclude.empty(); }
+
+    /**
+     * Check if a stat is selected.
+     *
+     * @param info Stat to check
+     * @param path Names of the groups leading to the stat
+     */
+    bool selected(const Info &info, const std::vector<std::string> &path);
+
+  private:
+    std::vector<std::string> include;
+    std::vector<std::string> exclude;
+
+    /** Whether each stat, by id, is selected: 0 if not known yet. */
+    enum : uint8_t { Unknown = 0, Selected, Excluded };
+    std::vector<uint8_t> selection;
+};
+
+/**
+ * Select the stats that are dumped by their full name, with patterns
+ * as described in StatFilter. Stats that are not selected are neither
+ * prepared nor visited when dumping.
+ */
+void setDumpFilter(const std::vector<std::string> &patterns);
+
+/**
+ * Set the number of host threads formatting a dump. Outputs that can
+ * be split (see Output::makePartial()) have the groups of stats
+ * formatted in parallel, while the simulation is stopped for the dump.
+ */
+void setDumpThreads(unsigned threads);
+
+/**
+ * Dump the stats of a group and its sub-groups.
+ *
+ * @param output Output to dump to, between calls to its begin() and
+ *     end()
+ * @param root Group to dump
+ * @param path Names of the groups leading to the root
+ * @param prepare Prepare the stats before visiting them
+ */
+void dumpGroup(Output &output, Group &root,
+               const std::vector<std::string> &path, bool prepare);
+
+/**
+ * Dump the stats of a group and its sub-groups selected by a filter
+ * rather than by the dump filter.
+ */
+void dumpGroup(Output &output, Group &root,
+               const std::vector<std::string> &path, bool prepare,
+               StatFilter &filter);
+
+} // namespace statistics
+} // namespace gem5
+
+#endif // __BASE_STATS_DUMP_HH__
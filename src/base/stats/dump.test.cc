@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/gtest/cur_tick_fake.hh"
+#include "base/statistics.hh"
+#include "base/stats/dump.hh"
+#include "base/stats/text.hh"
+
+using namespace gem5;
+
+// The stats call curTick(), which is provided by the fake tick handler
+GTestTickHandler tickHandler;
+
+namespace
+{
+
+struct LeafStats : public statistics::Group
+{
+    statistics::Scalar hits;
+    statistics::Vector misses;
+    statistics::Value ticks;
+    statistics::Formula rate;
+
+    LeafStats(statistics::Group *parent, const char *name)
+      : statistics::Group(parent, name),
+        hits(this, "hits", statistics::units::Count::get(), "Hits"),
+        misses(this, "misses", statistics::units::Count::get(), "Misses"),
+        ticks(this, "ticks", statistics::units::Tick::get(), "Ticks"),
+        rate(this, "rate", statistics::units::Rate<
+            statistics::units::Count, statistics::units::Tick>::get(),
+            "Hits per tick")
+    {
+        misses.init(3);
+        ticks.functor([] { return curTick(); });
+        rate = hits / ticks;
+    }
+};
+
+/** A tree of groups with enough stats to be split among threads. */
+struct StatTree
+{
+    statistics::Group root;
+    std::vector<std::unique_ptr<statistics::Group>> nodes;
+    std::vector<std::unique_ptr<LeafStats>> leaves;
+
+    StatTree() : root(nullptr)
+    {
+        for (int n = 0; n < 8; ++n) {
+            const std::string node_name = "node" + std::to_string(n);
+            nodes.emplace_back(new statistics::Group(&root,
+                                                     node_name.c_str()));
+            for (int l = 0; l < 8; ++l) {
+                const std::string leaf_name = "leaf" + std::to_string(l);
+                leaves.emplace_back(new LeafStats(nodes.back().get(),
+                                                  leaf_name.c_str()));
+                LeafStats &leaf = *leaves.back();
+                leaf.hits = n * 8 + l;
+                for (int m = 0; m < 3; ++m)
+                    leaf.misses[m] = n + l + m;
+            }
+        }
+    }
+};
+
+std::string
+dump(statistics::Group &root, unsigned threads,
+     const std::vector<std::string> &patterns = {})
+{
+    std::ostringstream stream;
+    statistics::Text text(stream);
+    text.enableUnits = true;
+    text.descriptions = true;
+    statistics::StatFilter filter(patterns);
+    statistics::setDumpThreads(threads);
+    text.begin();
+    statistics::dumpGroup(text, root, {}, true, filter);
+    text.end();
+    statistics::setDumpThreads(1);
+    return stream.str();
+}
+
+} // anonymous namespace
+
+/** Test that a dump split among threads matches a serial dump. */
+TEST(StatsDumpTest, ParallelMatchesSerial)
+{
+    StatTree tree;
+    tickHandler.setCurTick(1000);
+
+    const std::string serial = dump(tree.root, 1);
+    ASSERT_NE(serial.find("node7.leaf7.ticks"), std::string::npos);
+    // The functors are evaluated with the tick of the calling thread
+    ASSERT_NE(serial.find("1000"), std::string::npos);
+
+    for (unsigned threads : {2, 3, 8})
+        ASSERT_EQ(dump(tree.root, threads), serial);
+}
+
+/** Test that the filter selects the stats by their full name. */
+TEST(StatsDumpTest, FilterIncludeExclude)
+{
+    StatTree tree;
+    const auto &stats = tree.leaves[0]->getStats();
+    ASSERT_EQ(stats[0]->name, "hits");
+    ASSERT_EQ(stats[1]->name, "misses");
+    const statistics::Info &hits = *stats[0];
+    const statistics::Info &misses = *stats[1];
+    const std::vector<std::string> path{"node0", "leaf0"};
+
+    statistics::StatFilter all;
+    ASSERT_TRUE(all.all());
+    ASSERT_TRUE(all.selected(hits, path));
+
+    statistics::StatFilter include({"node0.*.hits"});
+    ASSERT_TRUE(include.selected(hits, path));
+    ASSERT_FALSE(include.selected(misses, path));
+
+    statistics::StatFilter exclude({"!*.misses"});
+    ASSERT_TRUE(exclude.selected(hits, path));
+    ASSERT_FALSE(exclude.selected(misses, path));
+
+    statistics::StatFilter both({"node0.*", "!*.leaf0.hits"});
+    ASSERT_FALSE(both.selected(hits, path));
+    ASSERT_TRUE(both.selected(misses, path));
+}
+
+/** Test that a filtered dump only contains the selected stats. */
+TEST(StatsDumpTest, FilteredDump)
+{
+    StatTree tree;
+    const std::vector<std::string> patterns{"node1.leaf2.*", "!*.rate"};
+
+    const std::string serial = dump(tree.root, 1, patterns);
+    ASSERT_NE(serial.find("node1.leaf2.hits"), std::string::npos);
+    ASSERT_NE(serial.find("node1.leaf2.misses"), std::string::npos);
+    ASSERT_EQ(serial.find("node1.leaf2.rate"), std::string::npos);
+    ASSERT_EQ(serial.find("node1.leaf3"), std::string::npos);
+    ASSERT_EQ(serial.find("node0."), std::string::npos);
+
+    ASSERT_EQ(dump(tree.root, 4, patterns), serial);
+}
@@ -42,6 +42,7 @@
 #define __BASE_STATS_OUTPUT_HH__
 
 #include <list>
+#include <memory>
 #include <string>
 
 #include "base/compiler.hh"
@@ -79,6 +80,18 @@ struct Output
     virtual void visit(const Vector2dInfo &info) = 0;
     virtual void visit(const FormulaInfo &info) = 0;
     virtual void visit(const SparseHistInfo &info) = 0; // Sparse histogram
+
+    /**
+     * Create an output formatting part of a dump, to be appended to
+     * this output with mergePartial(). Independent groups of stats can
+     * then be formatted in parallel. Outputs that cannot be split, e.g.
+     * because their output depends on the previous stats, return
+     * nullptr and are dumped by a single thread.
+     */
+    virtual std::unique_ptr<Output> makePartial() { return nullptr; }
+
+    /** Append a partial dump created by makePartial(). */
+    virtual void mergePartial(Output &partial) {}
 };
 
 } // namespace statistics
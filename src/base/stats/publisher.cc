@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/publisher.hh"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+
+#include "base/logging.hh"
+#include "base/stats/group.hh"
+
+namespace gem5
+{
+
+namespace statistics
+{
+
+namespace
+{
+
+#ifdef MSG_NOSIGNAL
+constexpr int sendFlags = MSG_NOSIGNAL;
+#else
+constexpr int sendFlags = 0;
+#endif
+
+/** Longest wait of the background thread before checking for work. */
+constexpr int pollInterval = 50; // ms
+
+/** Unsent data after which a client is considered stuck and dropped. */
+constexpr size_t maxPending = 64 << 20;
+
+void
+putLength(std::string &buf, uint32_t length)
+{
+    for (int i = 0; i < 4; ++i)
+        buf.push_back(static_cast<char>(length >> (8 * i)));
+}
+
+} // anonymous namespace
+
+Publisher::Publisher(const std::string &path,
+                     const std::vector<std::string> &patterns,
+                     size_t ring_size, double _period,
+                     std::function<void()> _request)
+    : Columnar(false, false), filter(patterns), ring(ring_size),
+      period(_period), request(std::move(_request))
+{
+    fatal_if(path.empty(), "No socket given to publish the stats to\n");
+    fatal_if(_period < 0, "The stat publishing period cannot be negative\n");
+
+    if (path[0] == '@') {
+        listener = std::make_unique<ListenSocketUnixAbstract>(
+            "statsPublisher", path.substr(1));
+    } else {
+        std::filesystem::path p(path);
+        listener = std::make_unique<ListenSocketUnixFile>(
+            "statsPublisher",
+            p.has_parent_path() ? p.parent_path().string() : ".",
+            p.filename());
+    }
+    listener->listen();
+
+    server = std::thread(&Publisher::serve, this);
+}
+
+Publisher::~Publisher()
+{
+    stopping = true;
+    server.join();
+}
+
+void
+Publisher::publish(Group &root)
+{
+    // Nobody is watching, the columns are described to the first
+    // client along with its first snapshot
+    if (numClients == 0)
+        return;
+
+    root.preDumpStats();
+    begin();
+    dumpGroup(*this, root, {}, true, filter);
+    end();
+}
+
+bool
+Publisher::writeDump(const std::string &columns, const std::string &dump)
+{
+    entry.clear();
+    putLength(entry, columns.size());
+    entry += columns;
+    entry += dump;
+    if (!ring.push(entry.data(), entry.size())) {
+        ++numDropped;
+        return false;
+    }
+    return true;
+}
+
+bool
+Publisher::flush(Client &client)
+{
+    while (!client.pending.empty()) {
+        const ssize_t sent = ::send(client.fd, client.pending.data(),
+                                    client.pending.size(), sendFlags);
+        if (sent < 0) {
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.pending.erase(0, sent);
+    }
+    return true;
+}
+
+bool
+Publisher::send(Client &client, const std::string &msg)
+{
+    if (client.pending.size() + msg.size() > maxPending)
+        return false;
+    client.pending += msg;
+    return flush(client);
+}
+
+void
+Publisher::serve()
+{
+    using Clock = std::chrono::steady_clock;
+    auto next_request = Clock::now() + period;
+
+    std::vector<pollfd> fds;
+    std::string record;
+    std::string msg;
+
+    auto drop = [this](size_t i) {
+        ::close(clients[i].fd);
+        clients.erase(clients.begin() + i);
+        --numClients;
+    };
+
+    while (!stopping) {
+        int timeout = pollInterval;
+        if (period.count() > 0) {
+            const auto wait = std::chrono::duration_cast<
+                std::chrono::milliseconds>(next_request - Clock::now());
+            timeout = std::clamp<int>(wait.count(), 0, pollInterval);
+        }
+
+        fds.assign(1, {listener->getfd(), POLLIN, 0});
+        for (const auto &client : clients) {
+            fds.push_back({client.fd, static_cast<short>(
+                POLLIN | (client.pending.empty() ? 0 : POLLOUT)), 0});
+        }
+        if (::poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR)
+            break;
+
+        // Clients only send data to hang up, anything else is ignored
+        for (size_t i = clients.size(); i-- > 0;) {
+            const short revents = fds[i + 1].revents;
+            bool alive = !(revents & (POLLERR | POLLNVAL));
+            if (alive && (revents & (POLLIN | POLLHUP))) {
+                char buf[256];
+                const ssize_t got = ::recv(clients[i].fd, buf, sizeof(buf),
+                                           MSG_DONTWAIT);
+                alive = got > 0 || (got < 0 && (errno == EAGAIN ||
+                                                errno == EINTR));
+            }
+            if (alive && (revents & POLLOUT))
+                alive = flush(clients[i]);
+            if (!alive)
+                drop(i);
+        }
+
+        if (fds[0].revents & POLLIN) {
+            const int fd = ListenSocket::acceptCloexec(listener->getfd(),
+                                                       nullptr, nullptr);
+            if (fd >= 0) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                clients.push_back({fd, ""});
+                ++numClients;
+
+                msg = fileHeader();
+                putLength(msg, catalog.size());
+                msg += catalog;
+                if (!send(clients.back(), msg))
+                    drop(clients.size() - 1);
+            }
+        }
+
+        while (ring.pop(record)) {
+            uint32_t columns_size = 0;
+            for (int i = 0; i < 4; ++i)
+                columns_size |= uint32_t(uint8_t(record[i])) << (8 * i);
+
+            msg.clear();
+            putLength(msg, record.size() - 4);
+            msg.append(record, 4, std::string::npos);
+            for (size_t i = clients.size(); i-- > 0;) {
+                if (!send(clients[i], msg))
+                    drop(i);
+            }
+            catalog.append(record, 4, columns_size);
+        }
+
+        if (period.count() > 0 && Clock::now() >= next_request) {
+            if (numClients != 0)
+                request();
+            next_request = Clock::now() + period;
+        }
+    }
+
+    for (auto &client : clients)
+        ::close(client.fd);
+    clients.clear();
+}
+
+} // namespace statistics
+} // namespace gem5
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_PUBLISHER_HH__
+#define __BASE_STATS_PUBLISHER_HH__
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/socket.hh"
+#include "base/stats/columnar.hh"
+#include "base/stats/dump.hh"
+#include "base/stats/record_ring.hh"
+
+namespace gem5
+{
+
+namespace statistics
+{
+
+class Group;
+
+/**
+ * Publishes snapshots of selected stats to the clients connected to a
+ * local socket while the simulation runs, so that the progress of a
+ * long simulation can be watched without dumping stats to disk.
+ *
+ * Snapshots are taken by the simulation thread, in the records of the
+ * columnar output (see Columnar), holding the value of every selected
+ * stat. They are handed over through a lock-free ring to a background
+ * thread, which sends them to the clients. Taking a snapshot never
+ * waits for the clients: if the ring is full, the snapshot is dropped.
+ *
+ * A client first receives the magic and version of the columnar
+ * format, and then a sequence of messages, each made of a 32-bit
+ * little-endian length followed by columnar records. The first
+ * message describes the columns published so far, and every later
+ * message holds one snapshot, preceded by the description of the
+ * columns it publishes for the first time.
+ */
+class Publisher : public Columnar
+{
+  public:
+    /**
+     * @param path Path of the socket, relative to the output directory,
+     *     or starting with '@' for an abstract socket
+     * @param patterns Stats to publish, see StatFilter
+     * @param ring_size Size in bytes of the ring of snapshots
+     * @param period Host time between snapshots, 0 to disable
+     * @param request Called by the background thread when a snapshot
+     *     is due after the host period
+     */
+    Publisher(const std::string &path,
+              const std::vector<std::string> &patterns, size_t ring_size,
+              double period, std::function<void()> request);
+    ~Publisher();
+
+    /** Take a snapshot of the stats of a group and its sub-groups. */
+    void publish(Group &root);
+
+    /** Number of snapshots dropped because the ring was full. */
+    uint64_t dropped() const { return numDropped; }
+
+  public: // Output interface
+    bool valid() const override { return true; }
+
+  protected:
+    bool writeDump(const std::string &columns,
+                   const std::string &dump) override;
+
+  private:
+    /** A connected client, and the data that could not be sent yet. */
+    struct Client
+    {
+        int fd;
+        std::string pending;
+    };
+
+    /** Main loop of the background thread. */
+    void serve();
+
+    /** Send a message to a client, returns false if it went away. */
+    bool send(Client &client, const std::string &msg);
+
+    /** Send pending data to a client, returns false if it went away. */
+    bool flush(Client &client);
+
+    StatFilter filter;
+    ListenSocketPtr listener;
+
+    RecordRing ring;
+    /** Snapshot being pushed to the ring. */
+    std::string entry;
+    uint64_t numDropped = 0;
+
+    const std::chrono::duration<double> period;
+    std::function<void()> request;
+
+    /** Number of connected clients, snapshots are skipped if none. */
+    std::atomic<unsigned> numClients{0};
+
+    std::atomic<bool> stopping{false};
+    std::thread server;
+
+    /** State of the background thread. */
+    std::vector<Client> clients;
+    /** Column records of all the columns published so far. */
+    std::string catalog;
+};
+
+} // namespace statistics
+} // namespace gem5
+
+#endif // __BASE_STATS_PUBLISHER_HH__
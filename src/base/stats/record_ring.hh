@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_STATS_RECORD_RING_HH__
+#define __BASE_STATS_RECORD_RING_HH__
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "base/intmath.hh"
+
+namespace gem5
+{
+
+namespace statistics
+{
+
+/**
+ * Lock-free ring of variable sized records, with a single producer
+ * and a single consumer thread. Each record is stored as its 32-bit
+ * length followed by its bytes, wrapping around the end of the
+ * buffer. Neither side ever blocks: a record that does not fit in the
+ * free space is refused rather than waiting for the consumer, so that
+ * a slow consumer cannot hold up the producer.
+ */
+class RecordRing
+{
+  private:
+    /** Buffer, the size is always a power of two. */
+    std::vector<char> buf;
+    const size_t mask;
+
+    /**
+     * Total number of bytes ever written and read. Each one is only
+     * written by one side, and the other side only needs to see the
+     * records completely copied.
+     */
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+
+    void
+    copyIn(uint64_t pos, const void *data, size_t size)
+    {
+        const size_t off = pos & mask;
+        const size_t first = std::min(size, buf.size() - off);
+        std::memcpy(&buf[off], data, first);
+        std::memcpy(&buf[0], (const char *)data + first, size - first);
+    }
+
+    void
+    copyOut(uint64_t pos, void *data, size_t size) const
+    {
+        const size_t off = pos & mask;
+        const size_t first = std::min(size, buf.size() - off);
+        std::memcpy(data, &buf[off], first);
+        std::memcpy((char *)data + first, &buf[0], size - first);
+    }
+
+  public:
+    /**
+     * @param capacity Size of the buffer in bytes, rounded up to a
+     *     power of two
+     */
+    explicit RecordRing(size_t capacity)
+        : buf(1ULL << ceilLog2(capacity)), mask(buf.size() - 1)
+    {
+        assert(capacity > sizeof(uint32_t));
+    }
+
+    /** Size of the buffer in bytes. */
+    size_t capacity() const { return buf.size(); }
+
+    /**
+     * Append a record, called by the producer.
+     *
+     * @return false if the ring does not have room for it
+     */
+    bool
+    push(const void *data, size_t size)
+    {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        const uint64_t t = tail.load(std::memory_order_acquire);
+        const size_t needed = sizeof(uint32_t) + size;
+        if (size > UINT32_MAX || needed > buf.size() - (h - t))
+            return false;
+
+        const uint32_t len = size;
+        copyIn(h, &len, sizeof(len));
+        copyIn(h + sizeof(len), data, size);
+        head.store(h + needed, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove the oldest record, called by the consumer.
+     *
+     * @param record Replaced by the record
+     * @return false if the ring is empty
+     */
+    bool
+    pop(std::string &record)
+    {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        const uint64_t h = head.load(std::memory_order_acquire);
+        if (t == h)
+            return false;
+
+        uint32_t len;
+        copyOut(t, &len, sizeof(len));
+        record.resize(len);
+        copyOut(t + sizeof(len), &record[0], len);
+        tail.store(t + sizeof(len) + len, std::memory_order_release);
+        return true;
+    }
+
+    bool
+    empty() const
+    {
+        return head.load(std::memory_order_acquire) ==
+            tail.load(std::memory_order_acquire);
+    }
+};
+
+} // namespace statistics
+} // namespace gem5
+
+#endif // __BASE_STATS_RECORD_RING_HH__
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <thread>
+
+#include "base/stats/record_ring.hh"
+
+using namespace gem5;
+using namespace gem5::statistics;
+
+/** Records come out in the order they were pushed. */
+TEST(RecordRingTest, PushPop)
+{
+    RecordRing ring(64);
+    EXPECT_TRUE(ring.empty());
+
+    std::string record;
+    EXPECT_FALSE(ring.pop(record));
+
+    EXPECT_TRUE(ring.push("abc", 3));
+    EXPECT_TRUE(ring.push("", 0));
+    EXPECT_TRUE(ring.push("defgh", 5));
+    EXPECT_FALSE(ring.empty());
+
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ("abc", record);
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ("", record);
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ("defgh", record);
+    EXPECT_FALSE(ring.pop(record));
+    EXPECT_TRUE(ring.empty());
+}
+
+/** A record that does not fit is refused, and the ring is unchanged. */
+TEST(RecordRingTest, Full)
+{
+    RecordRing ring(32);
+    EXPECT_EQ(32, ring.capacity());
+
+    const std::string big(40, 'x');
+    EXPECT_FALSE(ring.push(big.data(), big.size()));
+
+    const std::string rec(12, 'a');
+    EXPECT_TRUE(ring.push(rec.data(), rec.size()));
+    EXPECT_TRUE(ring.push(rec.data(), rec.size()));
+    EXPECT_FALSE(ring.push("b", 1));
+
+    std::string record;
+    ASSERT_TRUE(ring.pop(record));
+    EXPECT_EQ(rec, record);
+    EXPECT_TRUE(ring.push("b", 1));
+}
+
+/** Records wrapping around the end of the buffer are kept whole. */
+TEST(RecordRingTest, Wrap)
+{
+    RecordRing ring(32);
+    std::string record;
+    for (int i = 0; i < 100; ++i) {
+        const std::string rec(1 + i % 20, 'a' + i % 26);
+        ASSERT_TRUE(ring.push(rec.data(), rec.size()));
+        ASSERT_TRUE(ring.pop(record));
+        EXPECT_EQ(rec, record);
+    }
+}
+
+/** A producer and a consumer thread can use the ring concurrently. */
+TEST(RecordRingTest, Concurrent)
+{
+    RecordRing ring(256);
+    const int num_records = 100000;
+
+    std::thread producer([&] {
+        std::mt19937 rng(0);
+        for (int i = 0; i < num_records;) {
+            std::string rec = std::to_string(i);
+            rec.append(rng() % 32, '.');
+            if (ring.push(rec.data(), rec.size()))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    std::string record;
+    for (int i = 0; i < num_records;) {
+        if (!ring.pop(record)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const std::string expected = std::to_string(i);
+        ASSERT_EQ(expected, record.substr(0, expected.size()));
+        ASSERT_EQ(std::string(record.size() - expected.size(), '.'),
+                  record.substr(expected.size()));
+        ++i;
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty());
+}
@@ -73,7 +73,8 @@ namespace statistics
 std::list<Info *> &statsList();
 
 Text::Text()
-    : mystream(false), stream(NULL), descriptions(false), spaces(false)
+    : mystream(false), stream(NULL), enableUnits(false),
+      descriptions(false), spaces(false)
 {
 }
 
@@ -139,6 +140,40 @@ Text::end()
     stream->flush();
 }
 
+namespace
+{
+
+/** Text output formatting part of a dump into a buffer. */
+class PartialText : public Text
+{
+  public:
+    std::ostringstream buffer;
+
+    PartialText(const Text &parent)
+    {
+        open(buffer);
+        descriptions = parent.descriptions;
+        enableUnits = parent.enableUnits;
+        spaces = parent.spaces;
+    }
+};
+
+} // anonymous namespace
+
+std::unique_ptr<Output>
+Text::makePartial()
+{
+    return std::make_unique<PartialText>(*this);
+}
+
+void
+Text::mergePartial(Output &partial)
+{
+    const std::string text =
+        static_cast<PartialText &>(partial).buffer.str();
+    stream->write(text.data(), text.size());
+}
+
 std::string
 Text::statName(const std::string &name) const
 {
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "base/stats/values.hh"
+
+#include "base/stats/info.hh"
+#include "base/stats/types.hh"
+
+namespace gem5
+{
+
+namespace statistics
+{
+
+namespace
+{
+
+void
+addVector(const VectorInfo &info, const std::string &name,
+          std::map<std::string, double> &values)
+{
+    const VResult &vec = info.result();
+    const size_type size = vec.size();
+
+    if (size == 1) {
+        values[name] = vec[0];
+        return;
+    }
+
+    // As in stats.txt, once a vector has subnames only the named
+    // elements are printed
+    bool have_sub = false;
+    for (const auto &subname : info.subnames)
+        have_sub = have_sub || !subname.empty();
+
+    for (off_type i = 0; i < size; ++i) {
+        if (have_sub && (i >= info.subnames.size() ||
+                         info.subnames[i].empty())) {
+            continue;
+        }
+        values[name + info.separatorString +
+               (have_sub ? info.subnames[i] : std::to_string(i))] = vec[i];
+    }
+
+    if (info.flags.isSet(total))
+        values[name + info.separatorString + "total"] = info.total();
+}
+
+} // anonymous namespace
+
+void
+addValues(const Info &info, const std::string &name,
+          std::map<std::string, double> &values)
+{
+    if (auto *scalar = dynamic_cast<const ScalarInfo *>(&info)) {
+        values[name] = scalar->result();
+    } else if (auto *vector = dynamic_cast<const VectorInfo *>(&info)) {
+        addVector(*vector, name, values);
+    } else if (auto *dist = dynamic_cast<const DistInfo *>(&info)) {
+        const DistData &data = dist->data;
+        values[name + "::samples"] = data.samples;
+        values[name + "::mean"] = data.samples ? data.sum / data.samples : 0.0;
+    }
+}
+
+} // namespace statistics
+} // namespace gem5
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+#include "base/gtest/cur_tick_fake.hh"
+#include "base/statistics.hh"
+#include "base/stats/values.hh"
+
+using namespace gem5;
+
+// The stats call curTick(), which is provided by the fake tick handler
+GTestTickHandler tickHandler;
+
+namespace
+{
+
+struct TestStats : public statistics::Group
+{
+    statistics::Scalar insts;
+    statistics::Scalar cycles;
+    statistics::Vector misses;
+    statistics::Vector hits;
+    statistics::Vector single;
+    statistics::Formula ipc;
+    statistics::Formula missesPerInst;
+    statistics::Distribution latency;
+
+    TestStats()
+      : statistics::Group(nullptr),
+        insts(this, "insts", statistics::units::Count::get(), "Insts"),
+        cycles(this, "cycles", statistics::units::Cycle::get(), "Cycles"),
+        misses(this, "misses", statistics::units::Count::get(), "Misses"),
+        hits(this, "hits", statistics::units::Count::get(), "Hits"),
+        single(this, "single", statistics::units::Count::get(), "Single"),
+        ipc(this, "ipc", statistics::units::Rate<
+            statistics::units::Count, statistics::units::Cycle>::get(),
+            "IPC"),
+        missesPerInst(this, "missesPerInst", statistics::units::Rate<
+            statistics::units::Count, statistics::units::Count>::get(),
+            "Misses per instruction"),
+        latency(this, "latency", statistics::units::Tick::get(),
+            "Latency")
+    {
+        misses.init(3).flags(statistics::total);
+        hits.init(3).subname(0, "read").subname(2, "write");
+        single.init(1).subname(0, "only");
+        latency.init(0, 100, 10);
+
+        insts = 100;
+        cycles = 50;
+        for (int i = 0; i < 3; ++i) {
+            misses[i] = i + 1;
+            hits[i] = 10 * (i + 1);
+            single[i % 1] = 7;
+        }
+        ipc = insts / cycles;
+        missesPerInst = misses / insts;
+        latency.sample(10);
+        latency.sample(30);
+    }
+};
+
+std::map<std::string, double>
+values(TestStats &stats)
+{
+    std::map<std::string, double> values;
+    for (auto &info : stats.getStats()) {
+        auto *i = const_cast<statistics::Info *>(info);
+        i->prepare();
+        statistics::addValues(*i, "system." + i->name, values);
+    }
+    return values;
+}
+
+} // anonymous namespace
+
+/** Scalars and formulas of scalars are named after the stat. */
+TEST(StatsValuesTest, Scalar)
+{
+    TestStats stats;
+    const auto v = values(stats);
+    EXPECT_DOUBLE_EQ(100, v.at("system.insts"));
+    EXPECT_DOUBLE_EQ(2, v.at("system.ipc"));
+    EXPECT_EQ(0, v.count("system.ipc::0"));
+    EXPECT_EQ(0, v.count("system.ipc::total"));
+}
+
+/** A single element vector is named after the stat, as in stats.txt. */
+TEST(StatsValuesTest, SingleElement)
+{
+    TestStats stats;
+    const auto v = values(stats);
+    EXPECT_DOUBLE_EQ(7, v.at("system.single"));
+    EXPECT_EQ(0, v.count("system.single::only"));
+}
+
+/** Vector elements are indexed, the total is only added if flagged. */
+TEST(StatsValuesTest, Vector)
+{
+    TestStats stats;
+    const auto v = values(stats);
+    EXPECT_DOUBLE_EQ(1, v.at("system.misses::0"));
+    EXPECT_DOUBLE_EQ(3, v.at("system.misses::2"));
+    EXPECT_DOUBLE_EQ(6, v.at("system.misses::total"));
+
+    // Formulas of vectors are vectors
+    EXPECT_DOUBLE_EQ(0.02, v.at("system.missesPerInst::1"));
+    EXPECT_EQ(0, v.count("system.missesPerInst::total"));
+}
+
+/** Once a vector has subnames, only its named elements are added. */
+TEST(StatsValuesTest, Subnames)
+{
+    TestStats stats;
+    const auto v = values(stats);
+    EXPECT_DOUBLE_EQ(10, v.at("system.hits::read"));
+    EXPECT_DOUBLE_EQ(30, v.at("system.hits::write"));
+    EXPECT_EQ(0, v.count("system.hits::1"));
+    EXPECT_EQ(0, v.count("system.hits::0"));
+}
+
+/** Distributions are summarized by their samples and mean. */
+TEST(StatsValuesTest, Distribution)
+{
+    TestStats stats;
+    const auto v = values(stats);
+    EXPECT_DOUBLE_EQ(2, v.at("system.latency::samples"));
+    EXPECT_DOUBLE_EQ(20, v.at("system.latency::mean"));
+}
@@ -169,5 +169,15 @@ OstreamLogger::logMessage(Tick when, const std::string &name,
     }
 }
 
+void
+BinaryLogger::logMessage(Tick when, const std::string &name,
+        const std::string &flag, const std::string &message)
+{
+    if (!isEnabled(name))
+        return;
+
+    trace.recordText(when, name, flag, message);
+}
+
 } // namespace trace
 } // namespace gem5
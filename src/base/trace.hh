@@ -36,6 +36,7 @@
 #include <string>
 #include <sstream>
 
+#include "base/binary_trace.hh"
 #include "base/compiler.hh"
 #include "base/cprintf.hh"
 #include "base/debug.hh"
@@ -63,6 +64,8 @@ class Logger
     ObjectMatch ignore;
     /** Name match for objects to activate log */
     ObjectMatch activate;
+    /** Binary trace recording the messages, if any */
+    BinaryTrace *binaryTrace = nullptr;
 
     bool isEnabled(const std::string &name) const
     {
@@ -101,6 +104,26 @@ class Logger
         logMessage(when, name, flag, line.str());
     }
 
+    /**
+     * Log a single message from a DPRINTF call site. If the logger
+     * records a binary trace, the message is recorded without being
+     * formatted whenever its arguments allow it.
+     */
+    template <typename ...Args>
+    void dprintf_site(CallSite &site, Tick when, const std::string &name,
+            const char *fmt, const Args &...args)
+    {
+        if (!isEnabled(name))
+            return;
+        if (binaryTrace &&
+                binaryTrace->record(site, when, name, fmt, args...)) {
+            return;
+        }
+        std::ostringstream line;
+        ccprintf(line, fmt, args...);
+        logMessage(when, name, site.flag, line.str());
+    }
+
     /** Dump a block of data of length len */
     void dump(Tick when, const std::string &name,
             const void *d, int len, const std::string &flag);
@@ -148,6 +171,28 @@ class OstreamLogger : public Logger
     std::ostream &getOstream() override { return stream; }
 };
 
+/** Logger recording the messages to a binary trace, which is later
+ *  turned into the output of an OstreamLogger by BinaryTrace::decode */
+class BinaryLogger : public Logger
+{
+  protected:
+    BinaryTrace trace;
+
+  public:
+    BinaryLogger(std::ostream &stream_) : trace(stream_)
+    {
+        binaryTrace = &trace;
+    }
+
+    void logMessage(Tick when, const std::string &name,
+            const std::string &flag, const std::string &message) override;
+
+    std::ostream &getOstream() override { return trace.output(); }
+
+    /** Write out the messages buffered so far */
+    void flush() { trace.flush(); }
+};
+
 /** Get the current global debug logger.  This takes ownership of the given
  *  logger which should be allocated using 'new' */
 Logger *getDebugLogger();
@@ -209,22 +254,25 @@ struct StringWrap
 
 #define DPRINTF(x, ...) do {                     \
     if (GEM5_UNLIKELY(TRACING_ON && ::gem5::debug::x)) {   \
-        ::gem5::trace::getDebugLogger()->dprintf_flag(   \
-            ::gem5::curTick(), name(), #x, __VA_ARGS__); \
+        static ::gem5::trace::CallSite _site(#x);        \
+        ::gem5::trace::getDebugLogger()->dprintf_site(   \
+            _site, ::gem5::curTick(), name(), __VA_ARGS__); \
     }                                            \
 } while (0)
 
 #define DPRINTFS(x, s, ...) do {                        \
     if (GEM5_UNLIKELY(TRACING_ON && ::gem5::debug::x)) {          \
-        ::gem5::trace::getDebugLogger()->dprintf_flag(          \
-                ::gem5::curTick(), (s)->name(), #x, __VA_ARGS__); \
+        static ::gem5::trace::CallSite _site(#x);               \
+        ::gem5::trace::getDebugLogger()->dprintf_site(          \
+                _site, ::gem5::curTick(), (s)->name(), __VA_ARGS__); \
     }                                                   \
 } while (0)
 
 #define DPRINTFR(x, ...) do {                          \
     if (GEM5_UNLIKELY(TRACING_ON && ::gem5::debug::x)) {         \
-        ::gem5::trace::getDebugLogger()->dprintf_flag(         \
-            (::gem5::Tick)-1, std::string(), #x, __VA_ARGS__); \
+        static ::gem5::trace::CallSite _site(#x);              \
+        ::gem5::trace::getDebugLogger()->dprintf_site(         \
+            _site, (::gem5::Tick)-1, std::string(), __VA_ARGS__); \
     }                                                  \
 } while (0)
 
@@ -237,15 +285,17 @@ struct StringWrap
 
 #define DPRINTFN(...) do {                                                \
     if (TRACING_ON) {                                                     \
-        ::gem5::trace::getDebugLogger()->dprintf( \
-            ::gem5::curTick(), name(), __VA_ARGS__); \
+        static ::gem5::trace::CallSite _site("");                         \
+        ::gem5::trace::getDebugLogger()->dprintf_site( \
+            _site, ::gem5::curTick(), name(), __VA_ARGS__); \
     }                                                                     \
 } while (0)
 
 #define DPRINTFNR(...) do {                                          \
     if (TRACING_ON) {                                                \
-        ::gem5::trace::getDebugLogger()->dprintf( \
-            (::gem5::Tick)-1, "", __VA_ARGS__); \
+        static ::gem5::trace::CallSite _site("");                    \
+        ::gem5::trace::getDebugLogger()->dprintf_site( \
+            _site, (::gem5::Tick)-1, "", __VA_ARGS__); \
     }                                                                \
 } while (0)
 
@@ -50,17 +50,29 @@ namespace gem5
 {
 
 TraceGen::InputStream::InputStream(const std::string& filename)
-    : trace(filename)
 {
+    if (packet_trace::isPacketTrace(filename))
+        binaryTrace.reset(new PacketTraceReader(filename));
+    else
+        trace.reset(new ProtoInputStream(filename));
     init();
 }
 
 void
 TraceGen::InputStream::init()
 {
+    if (binaryTrace) {
+        // The header of a binary trace is read when it is opened
+        const uint64_t tick_freq = binaryTrace->header().tickFreq;
+        panic_if(tick_freq != sim_clock::Frequency,
+                 "Trace was recorded with a different tick frequency %d\n",
+                 tick_freq);
+        return;
+    }
+
     // Create a protobuf message for the header and read it from the stream
     ProtoMessage::PacketHeader header_msg;
-    if (!trace.read(header_msg)) {
+    if (!trace->read(header_msg)) {
         panic("Failed to read packet header from trace\n");
     } else if (header_msg.tick_freq() != sim_clock::Frequency) {
         panic("Trace was recorded with a different tick frequency %d\n",
@@ -71,15 +83,31 @@ TraceGen::InputStream::init()
 void
 TraceGen::InputStream::reset()
 {
-    trace.reset();
+    if (binaryTrace)
+        binaryTrace->reset();
+    else
+        trace->reset();
     init();
 }
 
 bool
 TraceGen::InputStream::read(TraceElement& element)
 {
+    if (binaryTrace) {
+        PacketTraceRecord record;
+        if (!binaryTrace->read(record))
+            return false;
+        element.cmd = record.cmd;
+        element.addr = record.addr;
+        element.blocksize = record.size;
+        element.tick = record.tick;
+        element.flags = (record.valid & PacketTraceRecord::HasFlags) ?
+            record.flags : 0;
+        return true;
+    }
+
     ProtoMessage::Packet pkt_msg;
-    if (trace.read(pkt_msg)) {
+    if (trace->read(pkt_msg)) {
         element.cmd = pkt_msg.cmd();
         element.addr = pkt_msg.addr();
         element.blocksize = pkt_msg.size();
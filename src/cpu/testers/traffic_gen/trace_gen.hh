@@ -44,10 +44,13 @@
 #ifndef __CPU_TRAFFIC_GEN_TRACE_GEN_HH__
 #define __CPU_TRAFFIC_GEN_TRACE_GEN_HH__
 
+#include <memory>
+
 #include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base_gen.hh"
 #include "mem/packet.hh"
+#include "mem/packet_trace.hh"
 #include "proto/protoio.hh"
 
 namespace gem5
@@ -112,7 +115,10 @@ class TraceGen : public BaseGen
       private:
 
         /// Input file stream for the protobuf trace
-        ProtoInputStream trace;
+        std::unique_ptr<ProtoInputStream> trace;
+
+        /// Reader used instead if the trace is a binary packet trace
+        std::unique_ptr<PacketTraceReader> binaryTrace;
 
       public:
 
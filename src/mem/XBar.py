@@ -151,8 +151,11 @@ class SnoopFilter(SimObject):
 
     system = Param.System(Parent.any, "System that the crossbar belongs to.")
 
-    # Sanity check on max capacity to track, adjust if needed.
+    # Capacity of the snoop filter table, in terms of the amount of
+    # data tracked. Lines are evicted from the table, and
+    # back-invalidated in the caches above, when their set is full.
     max_capacity = Param.MemorySize("8MiB", "Maximum capacity of snoop filter")
+    assoc = Param.Unsigned(16, "Associativity of the snoop filter table")
 
 
 # We use a coherent crossbar to connect multiple requestors to the L2
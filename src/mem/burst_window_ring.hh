@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * BurstWindowRing declaration and implementation.
+ */
+
+#ifndef __MEM_BURST_WINDOW_RING_HH__
+#define __MEM_BURST_WINDOW_RING_HH__
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+/**
+ * Holds the number of commands issued in each burst window. The
+ * windows are stored in a circular buffer of counters indexed by
+ * window number, covering a contiguous range of windows starting at
+ * the oldest one that has not been pruned. As commands are only ever
+ * scheduled a bounded distance around the current tick, the range
+ * stays small, and looking up or adding a command is a constant-time
+ * array access rather than a hash lookup. The buffer grows as needed
+ * to cover the windows that are in use.
+ */
+class BurstWindowRing
+{
+  private:
+    /** Length of a burst window. */
+    const Tick window;
+
+    /** Command counters, the size is always a power of two. */
+    std::vector<unsigned> counts;
+
+    /** Window number of the counter at the head of the buffer. */
+    uint64_t base = 0;
+
+    /** Position of the oldest window in the buffer. */
+    size_t head = 0;
+
+    /** Number of consecutive windows covered, starting at base. */
+    size_t len = 0;
+
+    /** Total number of commands held. */
+    size_t total = 0;
+
+    size_t
+    slot(uint64_t win) const
+    {
+        return (head + (win - base)) & (counts.size() - 1);
+    }
+
+    /**
+     * Make room for at least the given number of windows, keeping the
+     * covered windows in order starting at the head of the buffer.
+     */
+    void
+    reserve(size_t needed)
+    {
+        if (needed <= counts.size())
+            return;
+
+        std::vector<unsigned> grown(1ULL << ceilLog2(needed), 0);
+        for (size_t i = 0; i < len; ++i)
+            grown[i] = counts[(head + i) & (counts.size() - 1)];
+        counts.swap(grown);
+        head = 0;
+    }
+
+  public:
+    /**
+     * @param _window Length of a burst window in ticks
+     * @param capacity Initial number of windows that can be held
+     */
+    explicit BurstWindowRing(Tick _window, size_t capacity = 64)
+        : window(_window), counts(1ULL << ceilLog2(capacity), 0)
+    {
+        assert(window > 0);
+    }
+
+    /** Number of commands issued in the window starting at tick. */
+    unsigned
+    count(Tick tick) const
+    {
+        const uint64_t win = tick / window;
+        if (len == 0 || win < base || win >= base + len)
+            return 0;
+        return counts[slot(win)];
+    }
+
+    /** Add a command to the window starting at tick. */
+    void
+    insert(Tick tick)
+    {
+        const uint64_t win = tick / window;
+        if (len == 0) {
+            base = win;
+            head = 0;
+            len = 1;
+            counts[0] = 0;
+        } else if (win < base) {
+            // commands may be placed in a window before the oldest
+            // one currently held, extend the range backwards
+            const size_t extra = base - win;
+            reserve(len + extra);
+            head = (head - extra) & (counts.size() - 1);
+            for (size_t i = 0; i < extra; ++i)
+                counts[(head + i) & (counts.size() - 1)] = 0;
+            base = win;
+            len += extra;
+        } else if (win >= base + len) {
+            const size_t new_len = win - base + 1;
+            reserve(new_len);
+            for (size_t i = len; i < new_len; ++i)
+                counts[(head + i) & (counts.size() - 1)] = 0;
+            len = new_len;
+        }
+        ++counts[slot(win)];
+        ++total;
+    }
+
+    /** Remove all the windows starting before the given tick. */
+    void
+    prune(Tick threshold)
+    {
+        const uint64_t limit = divCeil(threshold, window);
+        while (len != 0 && base < limit) {
+            total -= counts[head];
+            head = (head + 1) & (counts.size() - 1);
+            ++base;
+            --len;
+        }
+    }
+
+    /** Total number of commands held across all windows. */
+    size_t size() const { return total; }
+
+    bool empty() const { return total == 0; }
+};
+
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_BURST_WINDOW_RING_HH__
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+
+#include "mem/burst_window_ring.hh"
+
+using namespace gem5;
+using namespace gem5::memory;
+
+/** An empty ring holds no commands. */
+TEST(BurstWindowRingTest, Empty)
+{
+    BurstWindowRing ring(10);
+    EXPECT_TRUE(ring.empty());
+    EXPECT_EQ(0, ring.size());
+    EXPECT_EQ(0, ring.count(0));
+    EXPECT_EQ(0, ring.count(1000));
+}
+
+/** Commands are counted per window. */
+TEST(BurstWindowRingTest, InsertAndCount)
+{
+    BurstWindowRing ring(10);
+    ring.insert(100);
+    ring.insert(100);
+    ring.insert(120);
+    EXPECT_EQ(2, ring.count(100));
+    EXPECT_EQ(0, ring.count(110));
+    EXPECT_EQ(1, ring.count(120));
+    EXPECT_EQ(0, ring.count(90));
+    EXPECT_EQ(0, ring.count(130));
+    EXPECT_EQ(3, ring.size());
+}
+
+/** Windows before the oldest one held can still be added. */
+TEST(BurstWindowRingTest, InsertBeforeBase)
+{
+    BurstWindowRing ring(10, 4);
+    ring.insert(200);
+    ring.insert(150);
+    ring.insert(20);
+    EXPECT_EQ(1, ring.count(200));
+    EXPECT_EQ(1, ring.count(150));
+    EXPECT_EQ(1, ring.count(20));
+    EXPECT_EQ(0, ring.count(30));
+}
+
+/** Pruning drops the windows starting before the threshold. */
+TEST(BurstWindowRingTest, Prune)
+{
+    BurstWindowRing ring(10);
+    ring.insert(100);
+    ring.insert(110);
+    ring.insert(110);
+    ring.insert(120);
+
+    // a window starting exactly at the threshold is kept
+    ring.prune(110);
+    EXPECT_EQ(0, ring.count(100));
+    EXPECT_EQ(2, ring.count(110));
+    EXPECT_EQ(3, ring.size());
+
+    // a threshold inside a window removes that window as well
+    ring.prune(115);
+    EXPECT_EQ(0, ring.count(110));
+    EXPECT_EQ(1, ring.count(120));
+
+    ring.prune(1000);
+    EXPECT_TRUE(ring.empty());
+
+    // the ring can be reused once drained
+    ring.insert(5000);
+    EXPECT_EQ(1, ring.count(5000));
+    EXPECT_EQ(1, ring.size());
+}
+
+/** The ring behaves like a multiset of window-aligned ticks. */
+TEST(BurstWindowRingTest, MatchesMultiset)
+{
+    const Tick window = 8;
+    BurstWindowRing ring(window, 2);
+    std::map<Tick, unsigned> ref;
+    std::mt19937 rng(0);
+
+    Tick now = 0;
+    for (int i = 0; i < 10000; ++i) {
+        now += rng() % 16;
+        Tick win = (now + rng() % 512) / window * window;
+        if (rng() % 4 == 0)
+            win = (win > 256) ? win - 256 : 0;
+
+        ring.insert(win);
+        ref[win]++;
+
+        if (i % 7 == 0) {
+            ring.prune(now);
+            ref.erase(ref.begin(), ref.lower_bound(now));
+        }
+
+        size_t total = 0;
+        for (const auto &e : ref)
+            total += e.second;
+        ASSERT_EQ(total, ring.size());
+
+        for (Tick t = (now / window) * window; t < now + 512;
+             t += window) {
+            auto it = ref.find(t);
+            ASSERT_EQ(it == ref.end() ? 0 : it->second, ring.count(t));
+        }
+    }
+}
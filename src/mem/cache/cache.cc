@@ -990,6 +990,39 @@ Cache::cleanEvictBlk(CacheBlk *blk)
     return pkt;
 }
 
+PacketPtr
+Cache::writecleanWriteback(PacketPtr wb_pkt, Request::Flags dest,
+                           PacketId id)
+{
+    assert(wb_pkt->cmd == MemCmd::WritebackDirty);
+
+    RequestPtr req = std::make_shared<Request>(
+        wb_pkt->getBlockAddr(blkSize), blkSize, 0, Request::wbRequestorId);
+
+    if (wb_pkt->isSecure())
+        req->setFlags(Request::SECURE);
+
+    req->taskId(wb_pkt->req->taskId());
+
+    PacketPtr pkt = new Packet(req, MemCmd::WriteClean, blkSize, id);
+
+    if (dest) {
+        req->setFlags(dest);
+        pkt->setWriteThrough();
+    }
+
+    // the line is passed in the same state as by the writeback
+    if (wb_pkt->hasSharers()) {
+        pkt->setHasSharers();
+    }
+
+    pkt->allocate();
+    pkt->setData(wb_pkt->getConstPtr<uint8_t>());
+    DPRINTF(Cache, "Create %s for %s\n", pkt->print(), wb_pkt->print());
+
+    return pkt;
+}
+
 /////////////////////////////////////////////////////
 //
 // Snoop path: requests coming in from the memory side
@@ -1331,9 +1364,10 @@ Cache::recvTimingSnoopReq(PacketPtr pkt)
         // this cache, so the behaviour is modelled after handleSnoop,
         // the difference being that instead of querying the block
         // state to determine if it is dirty and writable, we use the
-        // command and fields of the writeback packet
+        // command and fields of the writeback packet, e.g. we do not
+        // respond to cache maintenance snoops
         bool respond = wb_pkt->cmd == MemCmd::WritebackDirty &&
-            pkt->needsResponse();
+            pkt->needsResponse() && !pkt->isClean();
         bool have_writable = !wb_pkt->hasSharers();
         bool invalidate = pkt->isInvalidate();
 
@@ -1354,7 +1388,22 @@ Cache::recvTimingSnoopReq(PacketPtr pkt)
                                    false, false);
         }
 
-        if (invalidate && wb_pkt->cmd != MemCmd::WriteClean) {
+        if (pkt->isClean() && wb_pkt->cmd == MemCmd::WritebackDirty) {
+            // write the dirty data to the destination of the cache
+            // maintenance operation, as handleSnoop does for a dirty
+            // block, the write clean replaces our writeback
+            PacketList writebacks;
+            writebacks.push_back(writecleanWriteback(wb_pkt,
+                                                     pkt->req->getDest(),
+                                                     pkt->id));
+            markInService(wb_entry);
+            delete wb_pkt;
+
+            Tick forward_time = clockEdge(forwardLatency) +
+                pkt->headerDelay;
+            doWritebacks(writebacks, forward_time);
+            pkt->setSatisfied();
+        } else if (invalidate && wb_pkt->cmd != MemCmd::WriteClean) {
             // Invalidation trumps our writeback... discard here
             // Note: markInService will remove entry from writeback buffer.
             markInService(wb_entry);
@@ -147,6 +147,19 @@ class Cache : public BaseCache
      */
     PacketPtr cleanEvictBlk(CacheBlk *blk);
 
+    /**
+     * Create a writeclean request with the data of a pending
+     * writeback, to replace the writeback when a cache maintenance
+     * snoop hits it.
+     *
+     * @param wb_pkt The WritebackDirty in the write buffer.
+     * @param dest The destination of the write clean operation.
+     * @param id Use the given packet id for the write clean operation.
+     * @return The generated write clean packet.
+     */
+    PacketPtr writecleanWriteback(PacketPtr wb_pkt, Request::Flags dest,
+                                  PacketId id);
+
     PacketPtr createMissPacket(PacketPtr cpu_pkt, CacheBlk *blk,
                                bool needs_writable,
                                bool is_whole_line_write) const override;
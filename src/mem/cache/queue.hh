@@ -48,7 +48,9 @@
 #include <cassert>
 #include <string>
 #include <type_traits>
+#include <vector>
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/named.hh"
 #include "base/trace.hh"
@@ -101,6 +103,76 @@ class Queue : public Drainable, public Named
     /** Holds non allocated entries. */
     typename Entry::List freeList;
 
+    /**
+     * Address index over the allocated entries. Each bucket heads an
+     * intrusive chain (through QueueEntry::indexPrev/indexNext) of the
+     * entries whose block address hashes to it, in allocation order,
+     * so that the first match in a chain is also the first match in
+     * the allocatedList.
+     */
+    std::vector<QueueEntry *> indexBuckets;
+
+    /** Number of bits used to select a bucket in the address index. */
+    const unsigned indexBits;
+
+    /**
+     * Get the address index bucket of a block address. A
+     * multiplicative hash is used since the low-order bits of block
+     * addresses are always zero.
+     */
+    QueueEntry *&
+    indexBucket(Addr blk_addr)
+    {
+        return indexBuckets[(blk_addr * 0x9e3779b97f4a7c15ULL) >>
+                            (64 - indexBits)];
+    }
+
+    const QueueEntry *
+    indexBucket(Addr blk_addr) const
+    {
+        return const_cast<Queue *>(this)->indexBucket(blk_addr);
+    }
+
+    /**
+     * Insert a newly allocated entry in the address index. Must be
+     * called once the entry's block address has been set.
+     */
+    void
+    addToIndex(Entry *entry)
+    {
+        QueueEntry *&head = indexBucket(entry->blkAddr);
+        entry->indexNext = nullptr;
+        if (!head) {
+            entry->indexPrev = nullptr;
+            head = entry;
+            return;
+        }
+        QueueEntry *tail = head;
+        while (tail->indexNext) {
+            tail = tail->indexNext;
+        }
+        tail->indexNext = entry;
+        entry->indexPrev = tail;
+    }
+
+    /** Remove an entry that is being deallocated from the address index. */
+    void
+    removeFromIndex(Entry *entry)
+    {
+        if (entry->indexPrev) {
+            entry->indexPrev->indexNext = entry->indexNext;
+        } else {
+            QueueEntry *&head = indexBucket(entry->blkAddr);
+            assert(head == entry);
+            head = entry->indexNext;
+        }
+        if (entry->indexNext) {
+            entry->indexNext->indexPrev = entry->indexPrev;
+        }
+        entry->indexPrev = nullptr;
+        entry->indexNext = nullptr;
+    }
+
     typename Entry::Iterator addToReadyList(Entry* entry)
     {
         if (readyList.empty() ||
@@ -116,6 +188,23 @@ class Queue : public Drainable, public Named
         panic("Failed to add to ready list.");
     }
 
+    /**
+     * Find the first entry on the readyList that conflicts with the
+     * given entry.
+     *
+     * @param entry The entry to be compared against.
+     * @return A pointer to the earliest matching entry.
+     */
+    Entry* findPendingInReadyList(const QueueEntry* entry) const
+    {
+        for (const auto& ready_entry : readyList) {
+            if (ready_entry->conflictAddr(entry)) {
+                return ready_entry;
+            }
+        }
+        return nullptr;
+    }
+
     /** The number of entries that are in service. */
     int _numInService;
 
@@ -135,11 +224,13 @@ class Queue : public Drainable, public Named
         Named(name),
         label(_label), numEntries(num_entries + reserve),
         numReserve(reserve), entries(numEntries, name + ".entry"),
+        indexBits(ceilLog2(2 * numEntries)),
         _numInService(0), allocated(0)
     {
         for (int i = 0; i < numEntries; ++i) {
             freeList.push_back(&entries[i]);
         }
+        indexBuckets.resize(1ULL << indexBits, nullptr);
     }
 
     bool isEmpty() const
@@ -168,7 +259,9 @@ class Queue : public Drainable, public Named
     Entry* findMatch(Addr blk_addr, bool is_secure,
                      bool ignore_uncacheable = true) const
     {
-        for (const auto& entry : allocatedList) {
+        for (const QueueEntry *e = indexBucket(blk_addr); e;
+             e = e->indexNext) {
+            Entry *entry = static_cast<Entry *>(const_cast<QueueEntry *>(e));
             // we ignore any entries allocated for uncacheable
             // accesses and simply ignore them when matching, in the
             // cache we never check for matches when adding new
@@ -206,12 +299,25 @@ class Queue : public Drainable, public Named
      */
     Entry* findPending(const QueueEntry* entry) const
     {
-        for (const auto& ready_entry : readyList) {
-            if (ready_entry->conflictAddr(entry)) {
-                return ready_entry;
+        // Only entries with the same block address can conflict, so
+        // use the address index to find the candidates among the
+        // entries that are still on the readyList
+        Entry *candidate = nullptr;
+        for (const QueueEntry *e = indexBucket(entry->blkAddr); e;
+             e = e->indexNext) {
+            Entry *ready_entry =
+                static_cast<Entry *>(const_cast<QueueEntry *>(e));
+            if (ready_entry->inService || !ready_entry->conflictAddr(entry)) {
+                continue;
             }
+            if (candidate) {
+                // More than one candidate, the position on the
+                // readyList decides which one is the earliest
+                return findPendingInReadyList(entry);
+            }
+            candidate = ready_entry;
         }
-        return nullptr;
+        return candidate;
     }
 
     /**
@@ -241,6 +347,7 @@ class Queue : public Drainable, public Named
     deallocate(Entry *entry)
     {
         allocatedList.erase(entry->allocIter);
+        removeFromIndex(entry);
         freeList.push_front(entry);
         allocated--;
         if (entry->inService) {
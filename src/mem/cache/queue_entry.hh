@@ -76,6 +76,14 @@ class QueueEntry : public Packet::SenderState, public Named
     /** True if the entry is uncacheable */
     bool _isUncacheable;
 
+    /**
+     * Links of the address index chain this entry belongs to while it
+     * is allocated. Entries in a chain are kept in allocation order.
+     * @sa Queue::indexBuckets
+     */
+    QueueEntry *indexPrev;
+    QueueEntry *indexNext;
+
   public:
     /**
      * A queue entry is holding packets that will be serviced as soon as
@@ -124,6 +132,7 @@ class QueueEntry : public Packet::SenderState, public Named
     QueueEntry(const std::string &name)
         : Named(name),
           readyTime(0), _isUncacheable(false),
+          indexPrev(nullptr), indexNext(nullptr),
           inService(false), order(0), blkAddr(0), blkSize(0), isSecure(false)
     {}
 
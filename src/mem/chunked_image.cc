@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/chunked_image.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace chunked_image
+{
+
+namespace
+{
+
+constexpr char magic[8] = {'g', 'e', 'm', '5', 'p', 'm', 'e', 'm'};
+constexpr uint32_t version = 1;
+
+/**
+ * Alignment of the chunks stored as is in the file, a multiple of the
+ * page size of any host.
+ */
+constexpr uint64_t rawAlignment = 1 << 16;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t chunkSize;
+    uint64_t numChunks;
+};
+
+enum ChunkKind : uint32_t
+{
+    ZeroChunk = 0,
+    RawChunk = 1,
+    DeflateChunk = 2,
+};
+
+struct IndexEntry
+{
+    uint64_t offset;
+    uint32_t storedSize;
+    uint32_t kind;
+};
+
+static_assert(sizeof(Header) == 40 && sizeof(IndexEntry) == 16,
+              "Unexpected padding in the chunked image structures");
+
+unsigned
+numThreads(unsigned threads, size_t jobs)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    return std::max<size_t>(1, std::min<size_t>(threads, jobs));
+}
+
+/** Run a job for every index in [0, n), on a number of threads. */
+template <class Job>
+void
+parallelFor(size_t n, unsigned threads, const Job &job)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&] {
+        for (size_t i = next++; i < n; i = next++)
+            job(i);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &w : workers)
+        w.join();
+}
+
+bool
+isZero(const uint8_t *data, size_t len)
+{
+    return len == 0 ||
+        (data[0] == 0 && std::memcmp(data, data + 1, len - 1) == 0);
+}
+
+void
+writeAt(int fd, const void *buf, size_t len, uint64_t offset,
+        const std::string &path)
+{
+    const uint8_t *ptr = static_cast<const uint8_t *>(buf);
+    while (len != 0) {
+        const ssize_t ret = ::pwrite(fd, ptr, len, offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        fatal_if(ret <= 0, "Write failed on memory image '%s': %s\n",
+                 path, strerror(errno));
+        ptr += ret;
+        len -= ret;
+        offset += ret;
+    }
+}
+
+void
+readAt(int fd, void *buf, size_t len, uint64_t offset,
+       const std::string &path)
+{
+    uint8_t *ptr = static_cast<uint8_t *>(buf);
+    while (len != 0) {
+        const ssize_t ret = ::pread(fd, ptr, len, offset);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        fatal_if(ret <= 0, "Read failed on memory image '%s'\n", path);
+        ptr += ret;
+        len -= ret;
+        offset += ret;
+    }
+}
+
+} // anonymous namespace
+
+void
+write(const std::string &path, const uint8_t *data, uint64_t size,
+      Storage storage, unsigned threads, uint64_t chunk_size)
+{
+    fatal_if(chunk_size == 0 || chunk_size > UINT32_MAX,
+             "Invalid memory image chunk size %d\n", chunk_size);
+
+    const uint64_t num_chunks = divCeil(size, chunk_size);
+    const std::string tmp_path = path + ".tmp";
+    const int fd = ::open(tmp_path.c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    fatal_if(fd < 0, "Can't open memory image '%s': %s\n", tmp_path,
+             strerror(errno));
+
+    std::vector<IndexEntry> index(num_chunks);
+    uint64_t offset = sizeof(Header) + num_chunks * sizeof(IndexEntry);
+
+    // The chunks are compressed in batches of a few per thread, and
+    // each batch is written in order once compressed
+    const unsigned num_threads = numThreads(threads, num_chunks);
+    const size_t batch = 4 * num_threads;
+    std::vector<std::vector<uint8_t>> compressed(batch);
+
+    for (uint64_t first = 0; first < num_chunks; first += batch) {
+        const uint64_t last = std::min<uint64_t>(first + batch, num_chunks);
+
+        parallelFor(last - first, num_threads, [&](size_t j) {
+            const uint64_t i = first + j;
+            const uint8_t *chunk = data + i * chunk_size;
+            const uint64_t len = std::min(chunk_size, size - i * chunk_size);
+            IndexEntry &entry = index[i];
+
+            if (isZero(chunk, len)) {
+                entry = {0, 0, ZeroChunk};
+                return;
+            }
+
+            if (storage == Storage::Compressed) {
+                auto &buf = compressed[j];
+                uLongf stored = compressBound(len);
+                buf.resize(stored);
+                // Chunks that do not compress are stored as is
+                if (compress2(buf.data(), &stored, chunk, len,
+                              Z_BEST_SPEED) == Z_OK && stored < len) {
+                    entry = {0, (uint32_t)stored, DeflateChunk};
+                    return;
+                }
+            }
+            entry = {0, (uint32_t)len, RawChunk};
+        });
+
+        for (uint64_t i = first; i < last; ++i) {
+            IndexEntry &entry = index[i];
+            if (entry.kind == ZeroChunk)
+                continue;
+
+            const void *stored;
+            if (entry.kind == RawChunk) {
+                offset = roundUp(offset, rawAlignment);
+                stored = data + i * chunk_size;
+            } else {
+                stored = compressed[i - first].data();
+            }
+            writeAt(fd, stored, entry.storedSize, offset, tmp_path);
+            entry.offset = offset;
+            offset += entry.storedSize;
+        }
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.size = size;
+    header.chunkSize = chunk_size;
+    header.numChunks = num_chunks;
+    writeAt(fd, &header, sizeof(header), 0, tmp_path);
+    writeAt(fd, index.data(), index.size() * sizeof(IndexEntry),
+            sizeof(header), tmp_path);
+
+    fatal_if(::close(fd) != 0, "Close failed on memory image '%s'\n",
+             tmp_path);
+    fatal_if(std::rename(tmp_path.c_str(), path.c_str()) != 0,
+             "Can't rename memory image '%s' to '%s': %s\n", tmp_path,
+             path, strerror(errno));
+}
+
+uint64_t
+read(const std::string &path, uint8_t *data, uint64_t size, bool map,
+     bool zeroed, unsigned threads)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    fatal_if(fd < 0, "Can't open memory image '%s': %s\n", path,
+             strerror(errno));
+
+    struct stat st;
+    fatal_if(::fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header),
+             "Memory image '%s' is truncated\n", path);
+    const uint64_t file_size = st.st_size;
+
+    Header header;
+    readAt(fd, &header, sizeof(header), 0, path);
+    fatal_if(std::memcmp(header.magic, magic, sizeof(magic)) != 0,
+             "'%s' is not a memory image\n", path);
+    fatal_if(header.version != version,
+             "Unsupported memory image version %d in '%s'\n",
+             header.version, path);
+    fatal_if(header.size != size,
+             "Memory range size has changed! Saw %lld, expected %lld\n",
+             header.size, size);
+
+    const uint64_t chunk_size = header.chunkSize;
+    const uint64_t num_chunks = header.numChunks;
+    fatal_if(chunk_size == 0 || num_chunks != divCeil(size, chunk_size) ||
+             sizeof(Header) + num_chunks * sizeof(IndexEntry) > file_size,
+             "Memory image '%s' is corrupted\n", path);
+
+    std::vector<IndexEntry> index(num_chunks);
+    readAt(fd, index.data(), num_chunks * sizeof(IndexEntry),
+           sizeof(Header), path);
+
+    for (const auto &entry : index) {
+        fatal_if(entry.kind > DeflateChunk ||
+                 entry.offset + entry.storedSize > file_size,
+                 "Memory image '%s' is corrupted\n", path);
+    }
+
+    // The chunks stored as is are mapped in place when possible, they
+    // are then read from the file as they are first accessed
+    const uint64_t page_size = sysconf(_SC_PAGE_SIZE);
+    std::vector<bool> mapped(num_chunks, false);
+    uint64_t mapped_size = 0;
+    if (map && (uintptr_t)data % page_size == 0) {
+        for (uint64_t i = 0; i < num_chunks; ++i) {
+            const IndexEntry &entry = index[i];
+            const uint64_t mem_offset = i * chunk_size;
+            const uint64_t len = std::min(chunk_size, size - mem_offset);
+            if (entry.kind != RawChunk || entry.storedSize != len ||
+                mem_offset % page_size != 0 ||
+                entry.offset % page_size != 0 ||
+                entry.storedSize % page_size != 0) {
+                continue;
+            }
+
+            void *ptr = ::mmap(data + mem_offset, entry.storedSize,
+                               PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_FIXED, fd, entry.offset);
+            fatal_if(ptr == MAP_FAILED,
+                     "Can't map memory image '%s': %s\n", path,
+                     strerror(errno));
+            mapped[i] = true;
+            mapped_size += entry.storedSize;
+        }
+    }
+
+    const uint8_t *file = (const uint8_t *)::mmap(
+        nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    fatal_if(file == MAP_FAILED, "Can't map memory image '%s': %s\n",
+             path, strerror(errno));
+
+    std::atomic<bool> corrupted(false);
+    parallelFor(num_chunks, numThreads(threads, num_chunks), [&](size_t i) {
+        const IndexEntry &entry = index[i];
+        const uint64_t len = std::min(chunk_size, size - i * chunk_size);
+        uint8_t *chunk = data + i * chunk_size;
+
+        if (entry.kind == ZeroChunk) {
+            if (!zeroed)
+                std::memset(chunk, 0, len);
+        } else if (entry.kind == RawChunk && !mapped[i]) {
+            if (entry.storedSize != len)
+                corrupted = true;
+            else
+                std::memcpy(chunk, file + entry.offset, len);
+        } else if (entry.kind == DeflateChunk) {
+            uLongf out_len = len;
+            if (uncompress(chunk, &out_len, file + entry.offset,
+                           entry.storedSize) != Z_OK || out_len != len) {
+                corrupted = true;
+            }
+        }
+    });
+
+    ::munmap(const_cast<uint8_t *>(file), file_size);
+    ::close(fd);
+
+    fatal_if(corrupted, "Memory image '%s' is corrupted\n", path);
+    return mapped_size;
+}
+
+} // namespace chunked_image
+} // namespace memory
+} // namespace gem5
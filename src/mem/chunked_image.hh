@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Chunked memory image used to checkpoint the backing stores.
+ */
+
+#ifndef __MEM_CHUNKED_IMAGE_HH__
+#define __MEM_CHUNKED_IMAGE_HH__
+
+#include <cstdint>
+#include <string>
+
+namespace gem5
+{
+
+namespace memory
+{
+
+/**
+ * A chunked memory image holds the contents of a backing store split
+ * in fixed size chunks, which are written and read independently by
+ * several host threads. Chunks that are all zero are not stored, and
+ * the other chunks are either stored as is or compressed with deflate.
+ *
+ * The file starts with a header and an index giving the position,
+ * stored size and kind of every chunk. The chunks stored as is are
+ * aligned in the file, so that they can be mapped in place when the
+ * image is read: the pages of the memory are then only read from the
+ * file when first accessed, and copied when first written. The image
+ * is in host byte order, like the memory it holds.
+ */
+namespace chunked_image
+{
+
+/** How the chunks of an image are stored. */
+enum class Storage
+{
+    /** Compress the chunks, for smaller images. */
+    Compressed,
+    /** Store the chunks as is, so that they can be mapped lazily. */
+    Uncompressed,
+};
+
+/** Default size of the chunks, a multiple of any host page size. */
+constexpr uint64_t defaultChunkSize = 1 << 20;
+
+/**
+ * Write an image of a memory. The image is written to a temporary file
+ * renamed once complete, so that a memory mapping an older image at
+ * the same path keeps seeing the older contents.
+ *
+ * @param path Path of the image
+ * @param data Memory to write
+ * @param size Size of the memory in bytes
+ * @param storage How to store the chunks
+ * @param threads Number of host threads to use, 0 for one per core
+ * @param chunk_size Size of the chunks in bytes
+ */
+void write(const std::string &path, const uint8_t *data, uint64_t size,
+           Storage storage, unsigned threads,
+           uint64_t chunk_size = defaultChunkSize);
+
+/**
+ * Read an image into a memory.
+ *
+ * @param path Path of the image
+ * @param data Memory to read into, aligned on a host page
+ * @param size Size of the memory in bytes
+ * @param map Map the uncompressed chunks in place rather than copy
+ *     them, which is only possible for private memory
+ * @param zeroed The memory is known to be all zero, e.g. it is a fresh
+ *     anonymous mapping, so the zero chunks do not have to be cleared
+ * @param threads Number of host threads to use, 0 for one per core
+ * @return Number of bytes mapped rather than copied
+ */
+uint64_t read(const std::string &path, uint8_t *data, uint64_t size,
+              bool map, bool zeroed, unsigned threads);
+
+} // namespace chunked_image
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_CHUNKED_IMAGE_HH__
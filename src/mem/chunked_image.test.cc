@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mem/chunked_image.hh"
+
+using namespace gem5;
+using namespace gem5::memory;
+
+namespace
+{
+
+/** Page aligned, zero filled memory, like a backing store. */
+class Memory
+{
+  public:
+    explicit Memory(size_t size)
+        : _size(size),
+          _data((uint8_t *)mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0))
+    {
+        EXPECT_NE(MAP_FAILED, _data);
+    }
+
+    ~Memory() { munmap(_data, _size); }
+
+    uint8_t *data() { return _data; }
+    size_t size() const { return _size; }
+
+  private:
+    size_t _size;
+    uint8_t *_data;
+};
+
+/** Fill a memory with zero, compressible and random chunks. */
+void
+fill(Memory &mem, size_t chunk_size)
+{
+    std::mt19937 rng(0);
+    for (size_t off = 0; off < mem.size(); off += chunk_size) {
+        const size_t len = std::min(chunk_size, mem.size() - off);
+        switch ((off / chunk_size) % 3) {
+          case 0:
+            break;
+          case 1:
+            for (size_t i = 0; i < len; i += 64)
+                mem.data()[off + i] = i / 64;
+            break;
+          case 2:
+            for (size_t i = 0; i < len; ++i)
+                mem.data()[off + i] = rng();
+            break;
+        }
+    }
+}
+
+std::string
+imagePath(const std::string &name)
+{
+    return testing::TempDir() + "/" + name + "." +
+        std::to_string(getpid()) + ".pmem";
+}
+
+} // anonymous namespace
+
+/** A compressed image reads back the same memory. */
+TEST(ChunkedImageTest, Compressed)
+{
+    const size_t chunk_size = 1 << 16;
+    Memory mem(20 * chunk_size + 4096);
+    fill(mem, chunk_size);
+
+    const std::string path = imagePath("compressed");
+    chunked_image::write(path, mem.data(), mem.size(),
+                         chunked_image::Storage::Compressed, 4, chunk_size);
+
+    // Only the random chunks, which do not compress, are mapped
+    Memory restored(mem.size());
+    EXPECT_EQ(6 * chunk_size + 4096,
+              chunked_image::read(path, restored.data(), restored.size(),
+                                  true, true, 3));
+    EXPECT_EQ(0, memcmp(mem.data(), restored.data(), mem.size()));
+    std::remove(path.c_str());
+}
+
+/** The chunks of an uncompressed image are mapped when restoring. */
+TEST(ChunkedImageTest, Mapped)
+{
+    const size_t chunk_size = 1 << 16;
+    Memory mem(9 * chunk_size);
+    fill(mem, chunk_size);
+
+    const std::string path = imagePath("mapped");
+    chunked_image::write(path, mem.data(), mem.size(),
+                         chunked_image::Storage::Uncompressed, 2,
+                         chunk_size);
+
+    Memory restored(mem.size());
+    EXPECT_EQ(6 * chunk_size,
+              chunked_image::read(path, restored.data(), restored.size(),
+                                  true, true, 2));
+    EXPECT_EQ(0, memcmp(mem.data(), restored.data(), mem.size()));
+
+    // Writing to the restored memory does not change the image
+    memset(restored.data(), 0xff, restored.size());
+    Memory again(mem.size());
+    chunked_image::read(path, again.data(), again.size(), false, true, 1);
+    EXPECT_EQ(0, memcmp(mem.data(), again.data(), mem.size()));
+    std::remove(path.c_str());
+}
+
+/** Rewriting an image does not change the memories mapping it. */
+TEST(ChunkedImageTest, Rewrite)
+{
+    const size_t chunk_size = 1 << 16;
+    Memory mem(4 * chunk_size);
+    fill(mem, chunk_size);
+
+    const std::string path = imagePath("rewrite");
+    chunked_image::write(path, mem.data(), mem.size(),
+                         chunked_image::Storage::Uncompressed, 1,
+                         chunk_size);
+    Memory restored(mem.size());
+    chunked_image::read(path, restored.data(), restored.size(), true, true,
+                        1);
+
+    std::vector<uint8_t> other(mem.size(), 0x5a);
+    chunked_image::write(path, other.data(), other.size(),
+                         chunked_image::Storage::Uncompressed, 1,
+                         chunk_size);
+    EXPECT_EQ(0, memcmp(mem.data(), restored.data(), mem.size()));
+    std::remove(path.c_str());
+}
+
+/** Memory holding stale data, e.g. an existing shared backing store. */
+TEST(ChunkedImageTest, NotZeroed)
+{
+    const size_t chunk_size = 1 << 16;
+    Memory mem(7 * chunk_size + 4096);
+    fill(mem, chunk_size);
+
+    const std::string path = imagePath("not_zeroed");
+    chunked_image::write(path, mem.data(), mem.size(),
+                         chunked_image::Storage::Compressed, 2, chunk_size);
+
+    // The zero chunks are cleared, whether the others are mapped or not
+    for (bool map : {false, true}) {
+        Memory restored(mem.size());
+        memset(restored.data(), 0xa5, restored.size());
+        chunked_image::read(path, restored.data(), restored.size(), map,
+                            false, 2);
+        EXPECT_EQ(0, memcmp(mem.data(), restored.data(), mem.size()));
+    }
+    std::remove(path.c_str());
+}
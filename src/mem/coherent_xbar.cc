@@ -572,6 +572,18 @@ CoherentXBar::recvTimingSnoopResp(PacketPtr pkt, PortID cpu_side_port_id)
     // determine the source port based on the id
     ResponsePort* src_port = cpuSidePorts[cpu_side_port_id];
 
+    // caches write dirty data back with a WriteClean rather than
+    // responding to cache maintenance snoops, but should a snooper
+    // respond to a back-invalidation from the snoop filter, there is
+    // no one waiting for the response, which carries no data, so
+    // simply sink it
+    if (snoopFilter && snoopFilter->isBackInvalidation(pkt)) {
+        DPRINTF(CoherentXBar, "%s: src %s packet %s SINK\n", __func__,
+                src_port->name(), pkt->print());
+        delete pkt;
+        return true;
+    }
+
     // get the destination
     const auto route_lookup = routeTo.find(pkt->req);
     assert(route_lookup != routeTo.end());
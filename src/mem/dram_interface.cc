@@ -59,116 +59,130 @@ namespace memory
 std::pair<MemPacketQueue::iterator, Tick>
 DRAMInterface::chooseNextFRFCFS(MemPacketQueue& queue, Tick min_col_at) const
 {
-    std::vector<uint32_t> earliest_banks(ranksPerChannel, 0);
-
-    // Has minBankPrep been called to populate earliest_banks?
-    bool filled_earliest_banks = false;
-    // can the PRE/ACT sequence be done without impacting utlization?
-    bool hidden_bank_prep = false;
-
-    // search for seamless row hits first, if no seamless row hit is
-    // found then determine if there are other packets that can be issued
-    // without incurring additional bus delay due to bank timing
-    // Will select closed rows first to enable more open row possibilies
-    // in future selections
-    bool found_hidden_bank = false;
-
-    // remember if we found a row hit, not seamless, but bank prepped
-    // and ready
-    bool found_prepped_pkt = false;
-
-    // if we have no row hit, prepped or not, and no seamless packet,
-    // just go for the earliest possible
-    bool found_earliest_pkt = false;
-
-    Tick selected_col_at = MaxTick;
-    auto selected_pkt_it = queue.end();
-
-    for (auto i = queue.begin(); i != queue.end() ; ++i) {
-        MemPacket* pkt = *i;
-
-        // select optimal DRAM packet in Q
-        if (pkt->isDram() && (pkt->pseudoChannel == pseudoChannel)) {
-            const Bank& bank = ranks[pkt->rank]->banks[pkt->bank];
-            const Tick col_allowed_at = pkt->isRead() ? bank.rdAllowedAt :
-                                                        bank.wrAllowedAt;
+    // The packets are picked in the same order of preference as a
+    // search through the queue in arrival order would: the first
+    // seamless row hit, if any, otherwise the first packet to one of
+    // the earliest available banks when the bank can be prepared
+    // without impacting utilization, otherwise the first row hit that
+    // is prepped but cannot issue seamlessly, and finally the first
+    // packet to one of the earliest available banks. As the queue
+    // indexes its packets by bank, only the first row hit and the first
+    // row miss of each bank with waiting packets have to be considered.
+
+    // first seamless row hit
+    MemPacket* seamless_pkt = nullptr;
+    // first row hit, not seamless, but bank prepped and ready
+    MemPacket* prepped_pkt = nullptr;
+    // first row miss of each bank, candidates for the earliest packet
+    std::vector<MemPacket*> row_misses;
+
+    auto earlier = [](const MemPacket* a, const MemPacket* b)
+    {
+        return !b || a->seqNum < b->seqNum;
+    };
+
+    for (uint8_t r = 0; r < ranksPerChannel; r++) {
+        uint64_t waiting = queue.dramBanksWaiting(pseudoChannel, r);
+        if (!waiting)
+            continue;
 
-            DPRINTF(DRAM, "%s checking DRAM packet in bank %d, row %d\n",
-                    __func__, pkt->bank, pkt->row);
+        // check if rank is not doing a refresh and thus is available,
+        // if not, skip all its banks
+        if (!ranks[r]->inRefIdleState()) {
+            DPRINTF(DRAM, "%s Rank %d not available\n", __func__, r);
+            continue;
+        }
 
-            // check if rank is not doing a refresh and thus is available,
-            // if not, jump to the next packet
-            if (burstReady(pkt)) {
+        for (; waiting; waiting &= waiting - 1) {
+            const uint8_t b = ctz64(waiting);
+            const Bank& bank = ranks[r]->banks[b];
 
-                DPRINTF(DRAM,
-                        "%s bank %d - Rank %d available\n", __func__,
-                        pkt->bank, pkt->rank);
+            MemPacket* row_hit = nullptr;
+            MemPacket* row_miss = nullptr;
+            for (MemPacket* pkt : queue.bankPackets(pseudoChannel, r, b)) {
+                if (!pkt->isDram())
+                    continue;
 
-                // check if it is a row hit
                 if (bank.openRow == pkt->row) {
+                    const Tick col_allowed_at = pkt->isRead() ?
+                        bank.rdAllowedAt : bank.wrAllowedAt;
                     // no additional rank-to-rank or same bank-group
-                    // delays, or we switched read/write and might as well
-                    // go for the row hit
+                    // delays, or we switched read/write and might as
+                    // well go for the row hit
                     if (col_allowed_at <= min_col_at) {
-                        // FCFS within the hits, giving priority to
-                        // commands that can issue seamlessly, without
-                        // additional delay, such as same rank accesses
-                        // and/or different bank-group accesses
-                        DPRINTF(DRAM, "%s Seamless buffer hit\n", __func__);
-                        selected_pkt_it = i;
-                        selected_col_at = col_allowed_at;
-                        // no need to look through the remaining queue entries
+                        if (earlier(pkt, seamless_pkt))
+                            seamless_pkt = pkt;
+                        // the row hits in the bank that follow cannot
+                        // be any better
                         break;
-                    } else if (!found_hidden_bank && !found_prepped_pkt) {
-                        // if we did not find a packet to a closed row that can
-                        // issue the bank commands without incurring delay, and
-                        // did not yet find a packet to a prepped row, remember
-                        // the current one
-                        selected_pkt_it = i;
-                        selected_col_at = col_allowed_at;
-                        found_prepped_pkt = true;
-                        DPRINTF(DRAM, "%s Prepped row buffer hit\n", __func__);
-                    }
-                } else if (!found_earliest_pkt) {
-                    // if we have not initialised the bank status, do it
-                    // now, and only once per scheduling decisions
-                    if (!filled_earliest_banks) {
-                        // determine entries with earliest bank delay
-                        std::tie(earliest_banks, hidden_bank_prep) =
-                            minBankPrep(queue, min_col_at);
-                        filled_earliest_banks = true;
                     }
+                    if (!row_hit)
+                        row_hit = pkt;
+                } else if (!row_miss) {
+                    row_miss = pkt;
+                }
 
-                    // bank is amongst first available banks
-                    // minBankPrep will give priority to packets that can
-                    // issue seamlessly
-                    if (bits(earliest_banks[pkt->rank],
-                             pkt->bank, pkt->bank)) {
-                        found_earliest_pkt = true;
-                        found_hidden_bank = hidden_bank_prep;
-
-                        // give priority to packets that can issue
-                        // bank commands 'behind the scenes'
-                        // any additional delay if any will be due to
-                        // col-to-col command requirements
-                        if (hidden_bank_prep || !found_prepped_pkt) {
-                            selected_pkt_it = i;
-                            selected_col_at = col_allowed_at;
-                        }
-                    }
+                if (row_hit && row_miss)
+                    break;
+            }
+
+            if (row_hit && earlier(row_hit, prepped_pkt))
+                prepped_pkt = row_hit;
+            if (row_miss)
+                row_misses.push_back(row_miss);
+        }
+    }
+
+    MemPacket* selected_pkt = nullptr;
+
+    if (seamless_pkt) {
+        // FCFS within the hits, giving priority to commands that can
+        // issue seamlessly, without additional delay, such as same
+        // rank accesses and/or different bank-group accesses
+        DPRINTF(DRAM, "%s Seamless buffer hit\n", __func__);
+        selected_pkt = seamless_pkt;
+    } else {
+        // if there are packets to closed rows, determine the first one
+        // to a bank with the earliest bank delay, minBankPrep will give
+        // priority to banks that can issue seamlessly
+        MemPacket* earliest_pkt = nullptr;
+        bool hidden_bank_prep = false;
+        if (!row_misses.empty()) {
+            std::vector<uint32_t> earliest_banks;
+            std::tie(earliest_banks, hidden_bank_prep) =
+                minBankPrep(queue, min_col_at);
+
+            for (MemPacket* pkt : row_misses) {
+                if (bits(earliest_banks[pkt->rank], pkt->bank, pkt->bank) &&
+                    earlier(pkt, earliest_pkt)) {
+                    earliest_pkt = pkt;
                 }
-            } else {
-                DPRINTF(DRAM, "%s bank %d - Rank %d not available\n", __func__,
-                        pkt->bank, pkt->rank);
             }
         }
+
+        // give priority to packets that can issue bank commands
+        // 'behind the scenes', any additional delay if any will be due
+        // to col-to-col command requirements, then to row hits
+        if (earliest_pkt && (hidden_bank_prep || !prepped_pkt)) {
+            selected_pkt = earliest_pkt;
+        } else if (prepped_pkt) {
+            DPRINTF(DRAM, "%s Prepped row buffer hit\n", __func__);
+            selected_pkt = prepped_pkt;
+        }
     }
 
-    if (selected_pkt_it == queue.end()) {
+    if (!selected_pkt) {
         DPRINTF(DRAM, "%s no available DRAM ranks found\n", __func__);
+        return std::make_pair(queue.end(), MaxTick);
     }
 
-    return std::make_pair(selected_pkt_it, selected_col_at);
+    DPRINTF(DRAM, "%s selected DRAM packet in bank %d, row %d\n",
+            __func__, selected_pkt->bank, selected_pkt->row);
+
+    const Bank& bank = ranks[selected_pkt->rank]->banks[selected_pkt->bank];
+    const Tick selected_col_at = selected_pkt->isRead() ? bank.rdAllowedAt :
+                                                          bank.wrAllowedAt;
+    return std::make_pair(queue.find(selected_pkt), selected_col_at);
 }
 
 void
@@ -508,7 +522,11 @@ DRAMInterface::doBurstAccess(MemPacket* mem_pkt, Tick next_burst_at,
         bool got_bank_conflict = false;
 
         for (uint8_t i = 0; i < ctrl->numPriorities(); ++i) {
-            auto p = queue[i].begin();
+            // only the packets of this interface to the same rank and
+            // bank matter, look at these only
+            const auto& bank_pkts = queue[i].bankPackets(pseudoChannel,
+                mem_pkt->rank, mem_pkt->bank);
+            auto p = bank_pkts.begin();
             // keep on looking until we find a hit or reach the end of the
             // queue
             // 1) if a hit is found, then both open and close adaptive
@@ -517,21 +535,11 @@ DRAMInterface::doBurstAccess(MemPacket* mem_pkt, Tick next_burst_at,
             //    bank conflict request is waiting in the queue
             // 3) make sure we are not considering the packet that we are
             //    currently dealing with
-            while (!got_more_hits && p != queue[i].end()) {
-
-                if ((*p)->pseudoChannel != pseudoChannel) {
-                    // only consider if this pkt belongs to this interface
-                    ++p;
-                    continue;
-                }
-
+            while (!got_more_hits && p != bank_pkts.end()) {
                 if (mem_pkt != (*p)) {
-                    bool same_rank_bank = (mem_pkt->rank == (*p)->rank) &&
-                                          (mem_pkt->bank == (*p)->bank);
-
                     bool same_row = mem_pkt->row == (*p)->row;
-                    got_more_hits |= same_rank_bank && same_row;
-                    got_bank_conflict |= same_rank_bank && !same_row;
+                    got_more_hits |= same_row;
+                    got_bank_conflict |= !same_row;
                 }
                 ++p;
             }
@@ -1038,25 +1046,18 @@ DRAMInterface::minBankPrep(const MemPacketQueue& queue,
     // delay on the data bus
     bool hidden_bank_prep = false;
 
-    // determine if we have queued transactions targetting the
-    // bank in question
-    std::vector<bool> got_waiting(ranksPerChannel * banksPerRank, false);
-    for (const auto& p : queue) {
-        if (p->pseudoChannel != pseudoChannel)
-            continue;
-        if (p->isDram() && ranks[p->rank]->inRefIdleState())
-            got_waiting[p->bankId] = true;
-    }
-
     // Find command with optimal bank timing
     // Will prioritize commands that can issue seamlessly.
     for (int i = 0; i < ranksPerChannel; i++) {
-        for (int j = 0; j < banksPerRank; j++) {
-            uint16_t bank_id = i * banksPerRank + j;
+        // determine if we have queued transactions targetting the
+        // banks of the rank, ignoring ranks that are refreshing
+        const uint64_t got_waiting = ranks[i]->inRefIdleState() ?
+            queue.dramBanksWaiting(pseudoChannel, i) : 0;
 
+        for (int j = 0; j < banksPerRank; j++) {
             // if we have waiting requests for the bank, and it is
             // amongst the first available, update the mask
-            if (got_waiting[bank_id]) {
+            if (bits(got_waiting, j)) {
                 // make sure this rank is not currently refreshing.
                 assert(ranks[i]->inRefIdleState());
                 // simplistic approximation of when the bank can issue
@@ -51,6 +51,7 @@ HBMCtrl::HBMCtrl(const HBMCtrlParams &p) :
                          name()),
     respondEventPC1([this] {processRespondEvent(pc1Int, respQueuePC1,
                          respondEventPC1, retryRdReqPC1); }, name()),
+    rowBurstTicks(p.command_window), colBurstTicks(p.command_window),
     pc1Int(p.dram_2)
 {
     DPRINTF(MemCtrl, "Setting up HBM controller\n");
@@ -328,27 +329,13 @@ HBMCtrl::recvTimingReq(PacketPtr pkt)
 void
 HBMCtrl::pruneRowBurstTick()
 {
-    auto it = rowBurstTicks.begin();
-    while (it != rowBurstTicks.end()) {
-        auto current_it = it++;
-        if (getBurstWindow(curTick()) > *current_it) {
-            DPRINTF(MemCtrl, "Removing burstTick for %d\n", *current_it);
-            rowBurstTicks.erase(current_it);
-        }
-    }
+    rowBurstTicks.prune(getBurstWindow(curTick()));
 }
 
 void
 HBMCtrl::pruneColBurstTick()
 {
-    auto it = colBurstTicks.begin();
-    while (it != colBurstTicks.end()) {
-        auto current_it = it++;
-        if (getBurstWindow(curTick()) > *current_it) {
-            DPRINTF(MemCtrl, "Removing burstTick for %d\n", *current_it);
-            colBurstTicks.erase(current_it);
-        }
-    }
+    colBurstTicks.prune(getBurstWindow(curTick()));
 }
 
 void
@@ -36,7 +36,6 @@
 
 #include <deque>
 #include <string>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -177,14 +176,14 @@ class HBMCtrl : public MemCtrl
      * defined Tick. This is used to ensure that the row command bandwidth
      * does not exceed the allowable media constraints.
      */
-    std::unordered_multiset<Tick> rowBurstTicks;
+    BurstWindowRing rowBurstTicks;
 
     /**
      * This is used to ensure that the column command bandwidth
      * does not exceed the allowable media constraints. HBM2 has separate
      * command bus for row and column commands
      */
-    std::unordered_multiset<Tick> colBurstTicks;
+    BurstWindowRing colBurstTicks;
 
     /**
      * Pointers to interfaces of the two pseudo channels
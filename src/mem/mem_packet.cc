@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2012-2020 ARM Limited
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Copyright (c) 2013 Amin Farmahini-Farahani
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/mem_packet.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+MemPacketQueue::BankQueue &
+MemPacketQueue::bankQueue(const MemPacket *pkt)
+{
+    if (pkt->pseudoChannel >= bankQueues.size()) {
+        bankQueues.resize(pkt->pseudoChannel + 1);
+        dramBankMask.resize(pkt->pseudoChannel + 1);
+    }
+    auto &ranks = bankQueues[pkt->pseudoChannel];
+    if (pkt->rank >= ranks.size()) {
+        ranks.resize(pkt->rank + 1);
+        dramBankMask[pkt->pseudoChannel].resize(pkt->rank + 1, 0);
+    }
+    auto &banks = ranks[pkt->rank];
+    if (pkt->bank >= banks.size())
+        banks.resize(pkt->bank + 1);
+    return banks[pkt->bank];
+}
+
+MemPacketQueue::iterator
+MemPacketQueue::findSeqNum(Container &c, const MemPacket *pkt)
+{
+    return std::lower_bound(c.begin(), c.end(), pkt->seqNum,
+        [](const MemPacket *p, uint64_t seq_num)
+        { return p->seqNum < seq_num; });
+}
+
+void
+MemPacketQueue::push_back(MemPacket *pkt)
+{
+    pkt->seqNum = nextSeqNum++;
+    packets.push_back(pkt);
+
+    BankQueue &bank_queue = bankQueue(pkt);
+    bank_queue.packets.push_back(pkt);
+    if (pkt->isDram() && bank_queue.dramPackets++ == 0) {
+        panic_if(pkt->bank >= 64, "Bank %d is out of range of the "
+                 "waiting bank bitmap\n", pkt->bank);
+        dramBankMask[pkt->pseudoChannel][pkt->rank] |= 1ULL << pkt->bank;
+    }
+}
+
+MemPacketQueue::iterator
+MemPacketQueue::erase(iterator it)
+{
+    MemPacket *pkt = *it;
+
+    BankQueue &bank_queue = bankQueue(pkt);
+    auto bank_it = findSeqNum(bank_queue.packets, pkt);
+    panic_if(bank_it == bank_queue.packets.end() || *bank_it != pkt,
+             "Packet %#x is not in the bank index of its queue, was it "
+             "added to another queue before being removed from this one?",
+             pkt->getAddr());
+    bank_queue.packets.erase(bank_it);
+    if (pkt->isDram() && --bank_queue.dramPackets == 0) {
+        dramBankMask[pkt->pseudoChannel][pkt->rank] &= ~(1ULL << pkt->bank);
+    }
+
+    return packets.erase(it);
+}
+
+MemPacketQueue::iterator
+MemPacketQueue::find(const MemPacket *pkt)
+{
+    auto it = findSeqNum(packets, pkt);
+    return (it != packets.end() && *it == pkt) ? it : packets.end();
+}
+
+const MemPacketQueue::Container &
+MemPacketQueue::bankPackets(uint8_t pseudo_channel, uint8_t rank,
+                            uint8_t bank) const
+{
+    static const Container empty_queue;
+    if (pseudo_channel >= bankQueues.size() ||
+        rank >= bankQueues[pseudo_channel].size() ||
+        bank >= bankQueues[pseudo_channel][rank].size()) {
+        return empty_queue;
+    }
+    return bankQueues[pseudo_channel][rank][bank].packets;
+}
+
+} // namespace memory
+} // namespace gem5
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/gtest/cur_tick_fake.hh"
+#include "mem/mem_packet.hh"
+#include "mem/qos/mem_ctrl.hh"
+#include "mem/request.hh"
+
+using namespace gem5;
+using namespace gem5::memory;
+
+// Instantiate the fake class to have a valid curTick of 0
+GTestTickHandler tickHandler;
+
+namespace
+{
+
+/** Memory packets and the packets they wrap, owned by a test. */
+class MemPackets
+{
+  private:
+    std::vector<std::unique_ptr<Packet>> packets;
+    std::vector<std::unique_ptr<MemPacket>> memPackets;
+
+  public:
+    MemPacket *
+    make(RequestorID id, uint8_t rank, uint8_t bank, bool dram = true)
+    {
+        const Addr addr = 0x1000 * memPackets.size();
+        auto req = std::make_shared<Request>(addr, 64, 0, id);
+        packets.emplace_back(new Packet(req, MemCmd::ReadReq));
+        memPackets.emplace_back(new MemPacket(packets.back().get(), true,
+            dram, 0, rank, bank, 0, bank, addr, 64));
+        return memPackets.back().get();
+    }
+};
+
+/** Check the index of a queue against its packets. */
+void
+checkQueue(MemPacketQueue &queue, uint8_t ranks, uint8_t banks)
+{
+    size_t indexed = 0;
+    for (uint8_t rank = 0; rank < ranks; ++rank) {
+        uint64_t waiting = 0;
+        for (uint8_t bank = 0; bank < banks; ++bank) {
+            // the bank packets are the queue packets of that bank, in
+            // the same order
+            std::vector<MemPacket *> expected;
+            for (auto *pkt : queue) {
+                if (pkt->rank == rank && pkt->bank == bank)
+                    expected.push_back(pkt);
+            }
+            const auto &bank_packets = queue.bankPackets(0, rank, bank);
+            ASSERT_EQ(expected, std::vector<MemPacket *>(
+                bank_packets.begin(), bank_packets.end()));
+            indexed += bank_packets.size();
+            if (!expected.empty())
+                waiting |= 1ULL << bank;
+        }
+        EXPECT_EQ(waiting, queue.dramBanksWaiting(0, rank));
+    }
+    EXPECT_EQ(queue.size(), indexed);
+
+    for (auto it = queue.begin(); it != queue.end(); ++it)
+        EXPECT_EQ(it, queue.find(*it));
+}
+
+} // anonymous namespace
+
+/** Packets are kept in arrival order and indexed by bank. */
+TEST(MemPacketQueueTest, PushFindErase)
+{
+    MemPackets pkts;
+    MemPacketQueue queue;
+
+    std::vector<MemPacket *> added;
+    for (int i = 0; i < 12; ++i) {
+        added.push_back(pkts.make(0, i % 2, i % 3));
+        queue.push_back(added.back());
+    }
+    EXPECT_EQ(12, queue.size());
+    EXPECT_EQ(added.front(), queue.front());
+    EXPECT_EQ(added.back(), queue.back());
+    checkQueue(queue, 2, 3);
+
+    // packets not in the queue are not found
+    MemPacket *other = pkts.make(0, 0, 0);
+    EXPECT_EQ(queue.end(), queue.find(other));
+
+    // remove every other packet
+    for (auto it = queue.begin(); it != queue.end(); ++it)
+        it = queue.erase(it);
+    EXPECT_EQ(6, queue.size());
+    checkQueue(queue, 2, 3);
+
+    while (!queue.empty())
+        queue.erase(queue.begin());
+    EXPECT_EQ(0, queue.dramBanksWaiting(0, 0));
+    EXPECT_EQ(0, queue.dramBanksWaiting(0, 1));
+}
+
+/** Only DRAM packets mark their bank as waiting. */
+TEST(MemPacketQueueTest, NvmPacketsNotWaiting)
+{
+    MemPackets pkts;
+    MemPacketQueue queue;
+
+    queue.push_back(pkts.make(0, 0, 1, false));
+    EXPECT_EQ(0, queue.dramBanksWaiting(0, 0));
+    EXPECT_EQ(1, queue.bankPackets(0, 0, 1).size());
+
+    queue.push_back(pkts.make(0, 0, 1, true));
+    EXPECT_EQ(0b10, queue.dramBanksWaiting(0, 0));
+}
+
+/**
+ * Escalating the packets of a requestor moves them from one priority
+ * queue to the end of another one, as qos::MemCtrl::escalateQueues
+ * does, and keeps the index of both queues consistent.
+ */
+TEST(MemPacketQueueTest, Escalate)
+{
+    MemPackets pkts;
+    std::vector<MemPacketQueue> queues(3);
+
+    // packets of requestors 0 and 1 interleaved in the same banks, the
+    // target queue already holds more packets than the source one
+    for (int i = 0; i < 16; ++i)
+        queues[0].push_back(pkts.make(i % 2, 0, (i / 2) % 4));
+    for (int i = 0; i < 20; ++i)
+        queues[2].push_back(pkts.make(2, 0, i % 4));
+
+    std::vector<MemPacket *> moved;
+    auto it = queues[0].begin();
+    while (it != queues[0].end()) {
+        MemPacket *pkt = *it;
+        if (pkt->requestorId() == 1) {
+            pkt->qosValue(2);
+            moved.push_back(pkt);
+            it = qos::moveQueuedPacket(queues[0], it, queues[2]);
+        } else {
+            ++it;
+        }
+    }
+
+    EXPECT_EQ(8, queues[0].size());
+    EXPECT_EQ(28, queues[2].size());
+    for (auto *pkt : queues[0])
+        EXPECT_EQ(0, pkt->requestorId());
+    // the moved packets follow the ones already queued, in order
+    EXPECT_EQ(moved, std::vector<MemPacket *>(queues[2].begin() + 20,
+                                              queues[2].end()));
+    checkQueue(queues[0], 1, 4);
+    checkQueue(queues[2], 1, 4);
+
+    // move everything to an empty queue, then drain the queues through
+    // the bank index
+    it = queues[2].begin();
+    while (it != queues[2].end())
+        it = qos::moveQueuedPacket(queues[2], it, queues[1]);
+    EXPECT_TRUE(queues[2].empty());
+    checkQueue(queues[1], 1, 4);
+
+    for (auto &queue : queues) {
+        for (uint8_t bank = 0; bank < 4; ++bank) {
+            while (!queue.bankPackets(0, 0, bank).empty()) {
+                queue.erase(queue.find(
+                    queue.bankPackets(0, 0, bank).front()));
+            }
+        }
+        EXPECT_TRUE(queue.empty());
+        EXPECT_EQ(0, queue.dramBanksWaiting(0, 0));
+    }
+}
@@ -804,6 +804,7 @@ class Packet : public Printable, public Extensible<Packet>
 
     void copyError(Packet *pkt) { assert(pkt->isError()); cmd = pkt->cmd; }
 
+    bool hasAddr() const { return flags.isSet(VALID_ADDR); }
     Addr getAddr() const { assert(flags.isSet(VALID_ADDR)); return addr; }
     /**
      * Update the address of this packet mid-transaction. This is used
@@ -814,6 +815,7 @@ class Packet : public Printable, public Extensible<Packet>
      */
     void setAddr(Addr _addr) { assert(flags.isSet(VALID_ADDR)); addr = _addr; }
 
+    bool hasSize() const { return flags.isSet(VALID_SIZE); }
     unsigned getSize() const  { assert(flags.isSet(VALID_SIZE)); return size; }
 
     /**
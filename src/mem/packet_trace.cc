@@ -0,0 +1,408 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/packet_trace.hh"
+
+#include <zlib.h>
+
+#include <cstring>
+
+#include "base/logging.hh"
+#include "sim/byteswap.hh"
+
+namespace gem5
+{
+
+namespace packet_trace
+{
+
+namespace
+{
+
+/** Size of the header of a block. */
+constexpr size_t blockHeaderSize = 12;
+
+/** Bound on the number of records of a block, to catch corruption. */
+constexpr uint32_t maxBlockRecords = 1 << 24;
+
+template <typename T>
+void
+put(char *&p, T value)
+{
+    value = htole(value);
+    std::memcpy(p, &value, sizeof(value));
+    p += sizeof(value);
+}
+
+template <typename T>
+T
+get(const char *&p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return letoh(value);
+}
+
+template <typename T>
+void
+writeValue(std::ostream &os, T value)
+{
+    value = htole(value);
+    os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void
+writeString(std::ostream &os, const std::string &s)
+{
+    writeValue(os, uint32_t(s.size()));
+    os.write(s.data(), s.size());
+}
+
+template <typename T>
+bool
+readValue(std::istream &is, T &value)
+{
+    if (!is.read(reinterpret_cast<char *>(&value), sizeof(value)))
+        return false;
+    value = letoh(value);
+    return true;
+}
+
+bool
+readString(std::istream &is, std::string &s)
+{
+    uint32_t len;
+    if (!readValue(is, len))
+        return false;
+    s.resize(len);
+    return bool(is.read(s.data(), len));
+}
+
+void
+encode(char *p, const PacketTraceRecord &record)
+{
+    put(p, record.tick);
+    put(p, record.addr);
+    put(p, record.pc);
+    put(p, record.pktId);
+    put(p, record.cmd);
+    put(p, record.size);
+    put(p, record.flags);
+    put(p, record.valid);
+}
+
+void
+decode(const char *p, PacketTraceRecord &record)
+{
+    record.tick = get<uint64_t>(p);
+    record.addr = get<uint64_t>(p);
+    record.pc = get<uint64_t>(p);
+    record.pktId = get<uint64_t>(p);
+    record.cmd = get<uint32_t>(p);
+    record.size = get<uint32_t>(p);
+    record.flags = get<uint32_t>(p);
+    record.valid = get<uint32_t>(p);
+}
+
+} // anonymous namespace
+
+bool
+isPacketTrace(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    char file_magic[sizeof(magic)];
+    return file.read(file_magic, sizeof(file_magic)) &&
+        std::memcmp(file_magic, magic, sizeof(magic)) == 0;
+}
+
+} // namespace packet_trace
+
+using namespace packet_trace;
+
+PacketTraceWriter::PacketTraceWriter(const std::string &_filename,
+                                     const PacketTraceHeader &header,
+                                     bool _compress)
+    : filename(_filename),
+      file(filename, std::ios::out | std::ios::binary | std::ios::trunc),
+      compress(_compress)
+{
+    fatal_if(!file, "Can't open packet trace '%s'.\n", filename);
+
+    file.write(magic, sizeof(magic));
+    writeValue(file, version);
+    writeValue(file, uint64_t(header.tickFreq));
+    writeString(file, header.objId);
+    writeValue(file, uint32_t(header.idStrings.size()));
+    for (const auto &[key, value] : header.idStrings) {
+        writeValue(file, key);
+        writeString(file, value);
+    }
+
+    current.reserve(blockRecords);
+    pending.reserve(blockRecords);
+    thread = std::thread([this]() { run(); });
+}
+
+PacketTraceWriter::~PacketTraceWriter()
+{
+    close();
+}
+
+void
+PacketTraceWriter::submit()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this]() { return !busy; });
+    current.swap(pending);
+    busy = true;
+    lock.unlock();
+    cond.notify_all();
+
+    current.clear();
+}
+
+void
+PacketTraceWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cond.wait(lock, [this]() { return busy || done; });
+        if (!busy)
+            return;
+
+        lock.unlock();
+        writeBlock(pending);
+        lock.lock();
+
+        busy = false;
+        cond.notify_all();
+    }
+}
+
+void
+PacketTraceWriter::writeBlock(const std::vector<PacketTraceRecord> &block)
+{
+    const size_t raw_size = block.size() * recordSize;
+    std::vector<char> raw(raw_size);
+    for (size_t i = 0; i < block.size(); ++i)
+        encode(raw.data() + i * recordSize, block[i]);
+
+    uint32_t encoding = RawBlock;
+    const std::vector<char> *data = &raw;
+    std::vector<char> deflated;
+    if (compress) {
+        uLongf deflated_size = compressBound(raw_size);
+        deflated.resize(deflated_size);
+        if (compress2(reinterpret_cast<Bytef *>(deflated.data()),
+                      &deflated_size,
+                      reinterpret_cast<const Bytef *>(raw.data()),
+                      raw_size, Z_BEST_SPEED) == Z_OK &&
+                deflated_size < raw_size) {
+            deflated.resize(deflated_size);
+            encoding = DeflateBlock;
+            data = &deflated;
+        }
+    }
+
+    writeValue(file, uint32_t(block.size()));
+    writeValue(file, encoding);
+    writeValue(file, uint32_t(data->size()));
+    file.write(data->data(), data->size());
+    fatal_if(!file, "Write failed on packet trace '%s'.\n", filename);
+}
+
+void
+PacketTraceWriter::close()
+{
+    if (!thread.joinable())
+        return;
+
+    if (!current.empty())
+        submit();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    cond.notify_all();
+    thread.join();
+
+    file.close();
+    fatal_if(!file, "Close failed on packet trace '%s'.\n", filename);
+}
+
+PacketTraceReader::PacketTraceReader(const std::string &_filename)
+    : filename(_filename), file(filename, std::ios::in | std::ios::binary)
+{
+    fatal_if(!file, "Can't open packet trace '%s'.\n", filename);
+
+    char file_magic[sizeof(magic)];
+    uint32_t file_version;
+    fatal_if(!file.read(file_magic, sizeof(file_magic)) ||
+             std::memcmp(file_magic, magic, sizeof(magic)) != 0,
+             "'%s' is not a binary packet trace.\n", filename);
+    fatal_if(!readValue(file, file_version) || file_version != version,
+             "Packet trace '%s' has an unsupported version.\n", filename);
+
+    uint32_t num_ids;
+    bool ok = readValue(file, _header.tickFreq) &&
+        readString(file, _header.objId) && readValue(file, num_ids);
+    for (uint32_t i = 0; ok && i < num_ids; ++i) {
+        uint32_t key;
+        std::string value;
+        ok = readValue(file, key) && readString(file, value);
+        _header.idStrings.emplace_back(key, std::move(value));
+    }
+    fatal_if(!ok, "Packet trace '%s' has a truncated header.\n", filename);
+
+    firstBlock = file.tellg();
+    start();
+}
+
+PacketTraceReader::~PacketTraceReader()
+{
+    join();
+}
+
+void
+PacketTraceReader::start()
+{
+    // The first block is read ahead right away
+    requested = true;
+    ready = false;
+    done = false;
+    stop = false;
+    thread = std::thread([this]() { run(); });
+}
+
+void
+PacketTraceReader::join()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cond.notify_all();
+    thread.join();
+}
+
+void
+PacketTraceReader::reset()
+{
+    join();
+    file.clear();
+    file.seekg(firstBlock);
+    current.clear();
+    pos = 0;
+    start();
+}
+
+void
+PacketTraceReader::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cond.wait(lock, [this]() { return requested || stop; });
+        if (stop)
+            return;
+        requested = false;
+
+        // The consumer does not touch the block read ahead until it is
+        // marked as ready
+        lock.unlock();
+        const bool more = readBlock(next);
+        lock.lock();
+
+        done = !more;
+        ready = true;
+        cond.notify_all();
+    }
+}
+
+bool
+PacketTraceReader::nextBlock()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this]() { return ready; });
+    if (done)
+        return false;
+
+    current.swap(next);
+    pos = 0;
+    ready = false;
+    requested = true;
+    lock.unlock();
+    cond.notify_all();
+    return true;
+}
+
+bool
+PacketTraceReader::readBlock(std::vector<PacketTraceRecord> &block)
+{
+    char block_header[blockHeaderSize];
+    file.read(block_header, sizeof(block_header));
+    if (file.gcount() == 0 && file.eof())
+        return false;
+    fatal_if(!file, "Packet trace '%s' has a truncated block.\n", filename);
+
+    const char *p = block_header;
+    const uint32_t num_records = get<uint32_t>(p);
+    const uint32_t encoding = get<uint32_t>(p);
+    const uint32_t stored_size = get<uint32_t>(p);
+    const size_t raw_size = size_t(num_records) * recordSize;
+    fatal_if(num_records == 0 || num_records > maxBlockRecords ||
+             encoding > DeflateBlock ||
+             (encoding == RawBlock && stored_size != raw_size),
+             "Packet trace '%s' has a corrupted block.\n", filename);
+
+    std::vector<char> stored(stored_size);
+    fatal_if(!file.read(stored.data(), stored_size),
+             "Packet trace '%s' has a truncated block.\n", filename);
+
+    std::vector<char> inflated;
+    const char *raw = stored.data();
+    if (encoding == DeflateBlock) {
+        inflated.resize(raw_size);
+        uLongf inflated_size = raw_size;
+        fatal_if(uncompress(reinterpret_cast<Bytef *>(inflated.data()),
+                            &inflated_size,
+                            reinterpret_cast<const Bytef *>(stored.data()),
+                            stored_size) != Z_OK ||
+                 inflated_size != raw_size,
+                 "Packet trace '%s' has a corrupted block.\n", filename);
+        raw = inflated.data();
+    }
+
+    block.resize(num_records);
+    for (uint32_t i = 0; i < num_records; ++i)
+        decode(raw + i * recordSize, block[i]);
+    return true;
+}
+
+} // namespace gem5
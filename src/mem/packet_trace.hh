@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Binary packet trace, with fixed width records and block compression.
+ */
+
+#ifndef __MEM_PACKET_TRACE_HH__
+#define __MEM_PACKET_TRACE_HH__
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace gem5
+{
+
+/**
+ * Header of a packet trace, with the same contents as the header of
+ * the protobuf packet traces.
+ */
+struct PacketTraceHeader
+{
+    /** Name of the object that captured the trace. */
+    std::string objId;
+
+    /** Frequency of the ticks of the packets. */
+    uint64_t tickFreq = 0;
+
+    /** Names of the requestor ids. */
+    std::vector<std::pair<uint32_t, std::string>> idStrings;
+};
+
+/** A packet of a packet trace. */
+struct PacketTraceRecord
+{
+    /** Bits of the optional fields that are valid. */
+    enum : uint32_t
+    {
+        HasFlags = 1 << 0,
+        HasPktId = 1 << 1,
+        HasPC = 1 << 2,
+    };
+
+    uint64_t tick = 0;
+    uint64_t addr = 0;
+    uint64_t pc = 0;
+    uint64_t pktId = 0;
+    uint32_t cmd = 0;
+    uint32_t size = 0;
+    uint32_t flags = 0;
+    uint32_t valid = 0;
+};
+
+/**
+ * A binary packet trace holds the packets as fixed width records,
+ * grouped in blocks that are compressed independently. The file
+ * starts with a header followed by the blocks, each made of a block
+ * header giving the number of records, how they are stored and their
+ * stored size, followed by the records. The values are little endian.
+ *
+ * Unlike the protobuf traces, neither side of a binary trace parses or
+ * allocates anything per packet. The blocks are compressed and written
+ * by a background thread while the next block is being filled, and
+ * read and decompressed by a background thread while the previous one
+ * is being consumed.
+ */
+namespace packet_trace
+{
+
+/** Magic string at the start of a binary packet trace. */
+constexpr char magic[8] = {'g', 'e', 'm', '5', 'p', 't', 'r', 'c'};
+
+/** Version of the file format. */
+constexpr uint32_t version = 1;
+
+/** Size of a record in the file. */
+constexpr size_t recordSize = 48;
+
+/** Number of records in a full block. */
+constexpr size_t blockRecords = 1 << 16;
+
+/** How the records of a block are stored. */
+enum BlockEncoding : uint32_t
+{
+    RawBlock = 0,
+    DeflateBlock = 1,
+};
+
+/** Whether a file is a binary packet trace. */
+bool isPacketTrace(const std::string &filename);
+
+} // namespace packet_trace
+
+/** Writer of a binary packet trace. */
+class PacketTraceWriter
+{
+  private:
+    const std::string filename;
+    std::ofstream file;
+    const bool compress;
+
+    /** Block being filled. */
+    std::vector<PacketTraceRecord> current;
+
+    /** Block being written by the background thread. */
+    std::vector<PacketTraceRecord> pending;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool busy = false;
+    bool done = false;
+    std::thread thread;
+
+    /** Hand the current block over to the background thread. */
+    void submit();
+
+    /** Background thread writing out the blocks. */
+    void run();
+
+    void writeBlock(const std::vector<PacketTraceRecord> &block);
+
+  public:
+    /**
+     * @param filename Path of the trace
+     * @param header Header of the trace
+     * @param compress Whether to compress the blocks
+     */
+    PacketTraceWriter(const std::string &filename,
+                      const PacketTraceHeader &header, bool compress);
+    ~PacketTraceWriter();
+
+    void
+    write(const PacketTraceRecord &record)
+    {
+        current.push_back(record);
+        if (current.size() == packet_trace::blockRecords)
+            submit();
+    }
+
+    /** Write out the packets recorded so far and close the trace. */
+    void close();
+};
+
+/** Reader of a binary packet trace. */
+class PacketTraceReader
+{
+  private:
+    const std::string filename;
+    std::ifstream file;
+    PacketTraceHeader _header;
+
+    /** Position of the first block in the file. */
+    std::streampos firstBlock;
+
+    /** Block being consumed and position in it. */
+    std::vector<PacketTraceRecord> current;
+    size_t pos = 0;
+
+    /** Block read ahead by the background thread. */
+    std::vector<PacketTraceRecord> next;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool requested = false;
+    bool ready = false;
+    bool done = false;
+    bool stop = false;
+    std::thread thread;
+
+    /** Background thread reading the blocks ahead. */
+    void run();
+
+    /** Read a block, false at the end of the trace. */
+    bool readBlock(std::vector<PacketTraceRecord> &block);
+
+    /** Move to the next block, false at the end of the trace. */
+    bool nextBlock();
+
+    void start();
+    void join();
+
+  public:
+    PacketTraceReader(const std::string &filename);
+    ~PacketTraceReader();
+
+    const PacketTraceHeader &header() const { return _header; }
+
+    /** Read the next packet, false at the end of the trace. */
+    bool
+    read(PacketTraceRecord &record)
+    {
+        if (pos == current.size() && !nextBlock())
+            return false;
+        record = current[pos++];
+        return true;
+    }
+
+    /** Go back to the first packet of the trace. */
+    void reset();
+};
+
+} // namespace gem5
+
+#endif // __MEM_PACKET_TRACE_HH__
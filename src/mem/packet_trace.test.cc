@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mem/packet_trace.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+std::string
+tracePath(const std::string &name)
+{
+    return testing::TempDir() + "/" + name + "." +
+        std::to_string(getpid()) + ".trc";
+}
+
+/** Packets with a regular pattern, so that the blocks compress. */
+std::vector<PacketTraceRecord>
+makeRecords(size_t num)
+{
+    std::mt19937_64 rng(0);
+    std::vector<PacketTraceRecord> records(num);
+    for (size_t i = 0; i < num; ++i) {
+        auto &r = records[i];
+        r.tick = i * 1000;
+        r.addr = 0x80000000 + (rng() % 4096) * 64;
+        r.cmd = (i % 3) ? 1 : 4;
+        r.size = 64;
+        if (i % 2) {
+            r.flags = i & 0xff;
+            r.valid |= PacketTraceRecord::HasFlags;
+        }
+        if (i % 5 == 0) {
+            r.pc = 0x400000 + i * 4;
+            r.valid |= PacketTraceRecord::HasPC;
+        }
+        r.pktId = i;
+        r.valid |= PacketTraceRecord::HasPktId;
+    }
+    return records;
+}
+
+void
+expectEqual(const PacketTraceRecord &a, const PacketTraceRecord &b)
+{
+    EXPECT_EQ(a.tick, b.tick);
+    EXPECT_EQ(a.addr, b.addr);
+    EXPECT_EQ(a.pc, b.pc);
+    EXPECT_EQ(a.pktId, b.pktId);
+    EXPECT_EQ(a.cmd, b.cmd);
+    EXPECT_EQ(a.size, b.size);
+    EXPECT_EQ(a.flags, b.flags);
+    EXPECT_EQ(a.valid, b.valid);
+}
+
+void
+roundTrip(bool compress)
+{
+    // More than two blocks, the last one partially filled
+    const auto records = makeRecords(packet_trace::blockRecords * 2 + 123);
+
+    PacketTraceHeader header;
+    header.objId = "system.monitor";
+    header.tickFreq = 1000000000000ULL;
+    header.idStrings = {{0, "system.cpu"}, {1, "system.dma"}};
+
+    const std::string path =
+        tracePath(compress ? "compressed" : "uncompressed");
+    {
+        PacketTraceWriter writer(path, header, compress);
+        for (const auto &r : records)
+            writer.write(r);
+    }
+    EXPECT_TRUE(packet_trace::isPacketTrace(path));
+
+    PacketTraceReader reader(path);
+    EXPECT_EQ(header.objId, reader.header().objId);
+    EXPECT_EQ(header.tickFreq, reader.header().tickFreq);
+    EXPECT_EQ(header.idStrings, reader.header().idStrings);
+
+    // Read the trace twice, to check that it can be rewound
+    for (int pass = 0; pass < 2; ++pass) {
+        PacketTraceRecord record;
+        for (const auto &expected : records) {
+            ASSERT_TRUE(reader.read(record));
+            expectEqual(expected, record);
+        }
+        EXPECT_FALSE(reader.read(record));
+        EXPECT_FALSE(reader.read(record));
+        reader.reset();
+    }
+
+    std::remove(path.c_str());
+}
+
+} // anonymous namespace
+
+/** A compressed trace reads back the same packets. */
+TEST(PacketTraceTest, Compressed)
+{
+    roundTrip(true);
+}
+
+/** An uncompressed trace reads back the same packets. */
+TEST(PacketTraceTest, Uncompressed)
+{
+    roundTrip(false);
+}
+
+/** A trace without any packet only holds the header. */
+TEST(PacketTraceTest, Empty)
+{
+    const std::string path = tracePath("empty");
+    {
+        PacketTraceHeader header;
+        header.tickFreq = 1000;
+        PacketTraceWriter writer(path, header, true);
+        writer.close();
+    }
+
+    PacketTraceReader reader(path);
+    EXPECT_EQ(1000, reader.header().tickFreq);
+    PacketTraceRecord record;
+    EXPECT_FALSE(reader.read(record));
+    std::remove(path.c_str());
+}
+
+/** Other files are not taken for binary packet traces. */
+TEST(PacketTraceTest, NotATrace)
+{
+    const std::string path = tracePath("other");
+    {
+        std::ofstream file(path);
+        file << "gem5 protobuf";
+    }
+    EXPECT_FALSE(packet_trace::isPacketTrace(path));
+    EXPECT_FALSE(packet_trace::isPacketTrace(path + ".missing"));
+    std::remove(path.c_str());
+}
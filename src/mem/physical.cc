@@ -55,6 +55,7 @@
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
 #include "mem/abstract_mem.hh"
+#include "mem/chunked_image.hh"
 #include "sim/serialize.hh"
 #include "sim/sim_exit.hh"
 
@@ -80,9 +81,13 @@ PhysicalMemory::PhysicalMemory(const std::string& _name,
                                const std::vector<AbstractMemory*>& _memories,
                                bool mmap_using_noreserve,
                                const std::string& shared_backstore,
-                               bool auto_unlink_shared_backstore) :
+                               bool auto_unlink_shared_backstore,
+                               MemoryCheckpointFormat checkpoint_format,
+                               unsigned checkpoint_threads) :
     _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
     sharedBackstore(shared_backstore), sharedBackstoreSize(0),
+    checkpointFormat(checkpoint_format),
+    checkpointThreads(checkpoint_threads),
     pageSize(sysconf(_SC_PAGE_SIZE))
 {
     // Register cleanup callback if requested.
@@ -363,10 +368,12 @@ void
 PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
                                AddrRange range, uint8_t* pmem) const
 {
+    const bool chunked = checkpointFormat != MemoryCheckpointFormat::gzip;
+
     // we cannot use the address range for the name as the
     // memories that are not part of the address map can overlap
-    std::string filename =
-        name() + ".store" + std::to_string(store_id) + ".pmem";
+    std::string filename = name() + ".store" + std::to_string(store_id) +
+        (chunked ? ".pmemc" : ".pmem");
     long range_size = range.size();
 
     DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
@@ -378,6 +385,19 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
 
     // write memory file
     std::string filepath = CheckpointIn::dir() + "/" + filename.c_str();
+
+    if (chunked) {
+        // Checkpoints without a format hold a gzip memory file
+        std::string format = "chunked";
+        SERIALIZE_SCALAR(format);
+        chunked_image::write(filepath, pmem, range.size(),
+            checkpointFormat == MemoryCheckpointFormat::mapped ?
+                chunked_image::Storage::Uncompressed :
+                chunked_image::Storage::Compressed,
+            checkpointThreads);
+        return;
+    }
+
     gzFile compressed_mem = gzopen(filepath.c_str(), "wb");
     if (compressed_mem == NULL)
         fatal("Can't open physical memory checkpoint file '%s'\n",
@@ -443,6 +463,34 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(filename);
     std::string filepath = cp.getCptDir() + "/" + filename;
 
+    std::string format = "gzip";
+    UNSERIALIZE_OPT_SCALAR(format);
+
+    if (format == "chunked") {
+        long range_size;
+        UNSERIALIZE_SCALAR(range_size);
+
+        DPRINTF(Checkpoint, "Unserializing physical memory %s with size "
+                "%d\n", filename, range_size);
+
+        const BackingStoreEntry &store = backingStore[store_id];
+        fatal_if(range_size != store.range.size(),
+                 "Memory range size has changed! Saw %lld, expected %lld\n",
+                 range_size, store.range.size());
+
+        // A shared backing store is also seen by other processes, and
+        // cannot be replaced by a private mapping of the image. It may
+        // also be an existing one, holding data from a previous run.
+        const bool private_store = sharedBackstore.empty();
+        const uint64_t mapped = chunked_image::read(filepath, store.pmem,
+            store.range.size(), private_store, private_store,
+            checkpointThreads);
+        DPRINTF(Checkpoint, "Mapped %d bytes of %s\n", mapped, filename);
+        return;
+    }
+    fatal_if(format != "gzip", "Unknown physical memory checkpoint format "
+             "'%s'\n", format);
+
     // mmap memoryfile
     gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
     if (compressed_mem == NULL)
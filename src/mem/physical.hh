@@ -44,6 +44,7 @@
 
 #include "base/addr_range.hh"
 #include "base/addr_range_map.hh"
+#include "enums/MemoryCheckpointFormat.hh"
 #include "mem/packet.hh"
 #include "sim/serialize.hh"
 
@@ -156,6 +157,11 @@ class PhysicalMemory : public Serializable
     const std::string sharedBackstore;
     uint64_t sharedBackstoreSize;
 
+    // How the backing stores are written to checkpoints, and the
+    // number of host threads writing and reading them
+    const MemoryCheckpointFormat checkpointFormat;
+    const unsigned checkpointThreads;
+
     long pageSize;
 
     // The physical memory used to provide the memory in the simulated
@@ -191,7 +197,9 @@ class PhysicalMemory : public Serializable
                    const std::vector<AbstractMemory*>& _memories,
                    bool mmap_using_noreserve,
                    const std::string& shared_backstore,
-                   bool auto_unlink_shared_backstore);
+                   bool auto_unlink_shared_backstore,
+                   MemoryCheckpointFormat checkpoint_format,
+                   unsigned checkpoint_threads);
 
     /**
      * Unmap all the backing store we have used.
@@ -56,6 +56,7 @@
 #include "mem/protocol/atomic.hh"
 #include "mem/protocol/functional.hh"
 #include "mem/protocol/timing.hh"
+#include "mem/trace_window.hh"
 #include "sim/port.hh"
 
 namespace gem5
@@ -410,6 +411,7 @@ class ResponsePort : public Port, public AtomicResponseProtocol,
     sendAtomicSnoop(PacketPtr pkt)
     {
         try {
+            TraceWindow::Scope window(*_requestPort, pkt);
             return AtomicResponseProtocol::sendSnoop(_requestPort, pkt);
         } catch (UnboundPortException) {
             reportUnbound();
@@ -455,6 +457,7 @@ class ResponsePort : public Port, public AtomicResponseProtocol,
     {
         try {
             _requestPort->removeTrace(pkt);
+            TraceWindow::Scope window(*_requestPort, pkt);
             bool succ = TimingResponseProtocol::sendResp(_requestPort, pkt);
             if (!succ)
                 _requestPort->addTrace(pkt);
@@ -475,6 +478,7 @@ class ResponsePort : public Port, public AtomicResponseProtocol,
     sendTimingSnoopReq(PacketPtr pkt)
     {
         try {
+            TraceWindow::Scope window(*_requestPort, pkt);
             TimingResponseProtocol::sendSnoopReq(_requestPort, pkt);
         } catch (UnboundPortException) {
             reportUnbound();
@@ -553,6 +557,7 @@ RequestPort::sendAtomic(PacketPtr pkt)
 {
     try {
         addTrace(pkt);
+        TraceWindow::Scope window(*_responsePort, pkt);
         Tick tick = AtomicRequestProtocol::send(_responsePort, pkt);
         removeTrace(pkt);
         return tick;
@@ -566,6 +571,7 @@ RequestPort::sendAtomicBackdoor(PacketPtr pkt, MemBackdoorPtr &backdoor)
 {
     try {
         addTrace(pkt);
+        TraceWindow::Scope window(*_responsePort, pkt);
         Tick tick = AtomicRequestProtocol::sendBackdoor(_responsePort,
                                                         pkt, backdoor);
         removeTrace(pkt);
@@ -580,6 +586,7 @@ RequestPort::sendFunctional(PacketPtr pkt) const
 {
     try {
         addTrace(pkt);
+        TraceWindow::Scope window(*_responsePort, pkt);
         FunctionalRequestProtocol::send(_responsePort, pkt);
         removeTrace(pkt);
     } catch (UnboundPortException) {
@@ -604,6 +611,7 @@ RequestPort::sendTimingReq(PacketPtr pkt)
 {
     try {
         addTrace(pkt);
+        TraceWindow::Scope window(*_responsePort, pkt);
         bool succ = TimingRequestProtocol::sendReq(_responsePort, pkt);
         if (!succ)
             removeTrace(pkt);
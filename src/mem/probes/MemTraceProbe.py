@@ -38,6 +38,10 @@ from m5.params import *
 from m5.proxy import *
 
 
+class PacketTraceFormat(ScopedEnum):
+    vals = ["protobuf", "binary"]
+
+
 class MemTraceProbe(BaseMemProbe):
     type = "MemTraceProbe"
     cxx_header = "mem/probes/mem_trace.hh"
@@ -49,6 +53,12 @@ class MemTraceProbe(BaseMemProbe):
     # For requests with a valid PC, include the PC in the trace
     with_pc = Param.Bool(False, "Include PC info in the trace")
 
+    # The binary format has fixed width records compressed in blocks by a
+    # background thread, for traces too large for protobuf to keep up
+    trace_format = Param.PacketTraceFormat(
+        "protobuf", "Format of the packet trace"
+    )
+
     # packet trace output file, disabled by default
     trace_file = Param.String("", "Packet trace output file")
 
@@ -52,9 +52,13 @@ MemTraceProbe::MemTraceProbe(const MemTraceProbeParams &p)
     : BaseMemProbe(p),
       traceStream(nullptr),
       system(p.system),
-      withPC(p.with_pc)
+      withPC(p.with_pc),
+      format(p.trace_format),
+      compress(p.trace_compress)
 {
-    std::string filename;
+    // Binary traces compress their blocks, they are not gzipped
+    const bool gzip = compress && format == PacketTraceFormat::protobuf;
+
     if (p.trace_file != "") {
         // If the trace file is not specified as an absolute path,
         // append the current simulation output directory
@@ -63,18 +67,18 @@ MemTraceProbe::MemTraceProbe(const MemTraceProbeParams &p)
         const std::string suffix = ".gz";
         // If trace_compress has been set, check the suffix. Append
         // accordingly.
-        if (p.trace_compress &&
+        if (gzip &&
             filename.compare(filename.size() - suffix.size(), suffix.size(),
                              suffix) != 0)
             filename = filename + suffix;
     } else {
         // Generate a filename from the name of the SimObject. Append .trc
         // and .gz if we want compression enabled.
-        filename = simout.resolve(name() + ".trc" +
-                                  (p.trace_compress ? ".gz" : ""));
+        filename = simout.resolve(name() + ".trc" + (gzip ? ".gz" : ""));
     }
 
-    traceStream = new ProtoOutputStream(filename);
+    if (format == PacketTraceFormat::protobuf)
+        traceStream = new ProtoOutputStream(filename);
 
     // Register a callback to compensate for the destructor not
     // being called. The callback forces the stream to flush and
@@ -85,6 +89,17 @@ MemTraceProbe::MemTraceProbe(const MemTraceProbeParams &p)
 void
 MemTraceProbe::startup()
 {
+    if (format == PacketTraceFormat::binary) {
+        PacketTraceHeader header;
+        header.objId = name();
+        header.tickFreq = sim_clock::Frequency;
+        for (int i = 0; i < system->maxRequestors(); i++)
+            header.idStrings.emplace_back(i, system->getRequestorName(i));
+
+        binaryStream.reset(new PacketTraceWriter(filename, header, compress));
+        return;
+    }
+
     // Create a protobuf message for the header and write it to
     // the stream
     ProtoMessage::PacketHeader header_msg;
@@ -105,11 +120,32 @@ MemTraceProbe::closeStreams()
 {
     if (traceStream != NULL)
         delete traceStream;
+    traceStream = nullptr;
+
+    binaryStream.reset();
 }
 
 void
 MemTraceProbe::handleRequest(const probing::PacketInfo &pkt_info)
 {
+    if (binaryStream) {
+        PacketTraceRecord record;
+        record.tick = curTick();
+        record.cmd = pkt_info.cmd.toInt();
+        record.flags = pkt_info.flags;
+        record.addr = pkt_info.addr;
+        record.size = pkt_info.size;
+        record.pktId = pkt_info.id;
+        record.valid = PacketTraceRecord::HasFlags |
+            PacketTraceRecord::HasPktId;
+        if (withPC && pkt_info.pc != 0) {
+            record.pc = pkt_info.pc;
+            record.valid |= PacketTraceRecord::HasPC;
+        }
+        binaryStream->write(record);
+        return;
+    }
+
     ProtoMessage::Packet pkt_msg;
 
     pkt_msg.set_tick(curTick());
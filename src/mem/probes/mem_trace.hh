@@ -38,7 +38,12 @@
 #ifndef __MEM_PROBES_MEM_TRACE_HH__
 #define __MEM_PROBES_MEM_TRACE_HH__
 
+#include <memory>
+#include <string>
+
+#include "enums/PacketTraceFormat.hh"
 #include "mem/packet.hh"
+#include "mem/packet_trace.hh"
 #include "mem/probes/base.hh"
 #include "proto/protoio.hh"
 
@@ -69,12 +74,24 @@ class MemTraceProbe : public BaseMemProbe
     /** Trace output stream */
     ProtoOutputStream *traceStream;
 
+    /** Binary trace writer, created at startup once the header is known */
+    std::unique_ptr<PacketTraceWriter> binaryStream;
+
     System *system;
 
   private:
 
     /** Include the Program Counter in the memory trace */
     const bool withPC;
+
+    /** Format of the trace */
+    const PacketTraceFormat format;
+
+    /** Whether to compress the trace */
+    const bool compress;
+
+    /** Path of the trace */
+    std::string filename;
 };
 
 } // namespace gem5
@@ -133,3 +133,41 @@ class QoSPropFairPolicy(QoSPolicy):
                     )
 
     weight = Param.Float(0.5, "Pf score weight")
+
+
+class QoSBlissPolicy(QoSPolicy):
+    type = "QoSBlissPolicy"
+    cxx_header = "mem/qos/policy_bliss.hh"
+    cxx_class = "gem5::memory::qos::BlissPolicy"
+
+    blacklisting_threshold = Param.Unsigned(
+        4,
+        "Number of consecutive entries served for the same requestor "
+        "after which the requestor is blacklisted",
+    )
+    clearing_interval = Param.Latency(
+        "10us", "Time between two clearings of the blacklist"
+    )
+
+
+class QoSAtlasPolicy(QoSPolicy):
+    type = "QoSAtlasPolicy"
+    cxx_header = "mem/qos/policy_atlas.hh"
+    cxx_class = "gem5::memory::qos::AtlasPolicy"
+
+    quantum = Param.Latency(
+        "10us", "Length of the quantum requestors are ranked for"
+    )
+    history_weight = Param.Float(
+        0.875, "Weight of the past attained service in the total"
+    )
+
+
+class QoSParBsPolicy(QoSPolicy):
+    type = "QoSParBsPolicy"
+    cxx_header = "mem/qos/policy_parbs.hh"
+    cxx_class = "gem5::memory::qos::ParBsPolicy"
+
+    marking_cap = Param.Unsigned(
+        5, "Maximum number of entries marked per requestor in a batch"
+    )
@@ -116,6 +116,10 @@ MemCtrl::logRequest(BusState dir, RequestorID id, uint8_t _qos,
         requestTimes[id][addr].push_back(curTick());
     }
 
+    if (policy) {
+        policy->requested(id, entries);
+    }
+
     // Record statistics
     stats.avgPriority[id].sample(_qos);
 
@@ -203,9 +207,22 @@ MemCtrl::logResponse(BusState dir, RequestorID id, uint8_t _qos,
                     || stats.priorityMinLatency[_qos].value() == 0) {
                 stats.priorityMinLatency[_qos] = latency;
             }
+
+            // Record per-requestor latency stats
+            stats.requestorTotLatency[id] += latency;
+            stats.requestorResponses[id]++;
+
+            if (stats.requestorMinLatency[id].value() > latency
+                    || stats.requestorMinLatency[id].value() == 0) {
+                stats.requestorMinLatency[id] = latency;
+            }
         }
     }
 
+    if (policy) {
+        policy->served(id, entries);
+    }
+
     DPRINTF(QOS,
             "qos::MemCtrl::logResponse REQUESTOR %s [id %d] prio %d "
             "this requestor q packets %d - new queue size %d\n",
@@ -305,8 +322,48 @@ MemCtrl::MemCtrlStats::MemCtrlStats(MemCtrl &mc)
     ADD_STAT(numStayReadState, statistics::units::Count::get(),
              "Number of times bus staying in READ state"),
     ADD_STAT(numStayWriteState, statistics::units::Count::get(),
-             "Number of times bus staying in WRITE state")
+             "Number of times bus staying in WRITE state"),
+
+    ADD_STAT(requestorTotLatency, statistics::units::Second::get(),
+             "Per-requestor total request to response latency"),
+    ADD_STAT(requestorResponses, statistics::units::Count::get(),
+             "Per-requestor number of responses"),
+    ADD_STAT(requestorMinLatency, statistics::units::Second::get(),
+             "Per-requestor minimum request to response latency"),
+    ADD_STAT(requestorAvgLatency, statistics::units::Rate<
+                statistics::units::Second, statistics::units::Count>::get(),
+             "Per-requestor average request to response latency"),
+    ADD_STAT(requestorSlowdown, statistics::units::Ratio::get(),
+             "Per-requestor slowdown, as the ratio of the average to the "
+             "minimum request to response latency"),
+    ADD_STAT(maxSlowdown, statistics::units::Ratio::get(),
+             "Largest slowdown across all requestors"),
+    ADD_STAT(unfairness, statistics::units::Ratio::get(),
+             "Ratio of the largest to the smallest requestor slowdown")
+{
+}
+
+std::pair<double, double>
+MemCtrl::MemCtrlStats::slowdownRange()
 {
+    double min_slowdown = 0;
+    double max_slowdown = 0;
+
+    for (size_t i = 0; i < requestorResponses.size(); ++i) {
+        const double responses = requestorResponses[i].value();
+        const double min_latency = requestorMinLatency[i].value();
+        if (responses == 0 || min_latency == 0)
+            continue;
+
+        const double slowdown =
+            requestorTotLatency[i].value() / responses / min_latency;
+        if (max_slowdown == 0 || slowdown < min_slowdown)
+            min_slowdown = slowdown;
+        if (slowdown > max_slowdown)
+            max_slowdown = slowdown;
+    }
+
+    return std::make_pair(min_slowdown, max_slowdown);
 }
 
 void
@@ -342,10 +399,51 @@ MemCtrl::MemCtrlStats::regStats()
         .precision(12)
         ;
 
+    requestorTotLatency
+        .init(max_requestors)
+        .flags(nozero)
+        .precision(12)
+        ;
+
+    requestorResponses
+        .init(max_requestors)
+        .flags(nozero)
+        ;
+
+    requestorMinLatency
+        .init(max_requestors)
+        .flags(nozero)
+        .precision(12)
+        ;
+
+    requestorAvgLatency.flags(nozero | nonan).precision(12);
+    requestorAvgLatency = requestorTotLatency / requestorResponses;
+
+    requestorSlowdown.flags(nozero | nonan).precision(4);
+    requestorSlowdown = requestorAvgLatency / requestorMinLatency;
+
+    maxSlowdown
+        .functor([this] { return slowdownRange().second; })
+        .precision(4)
+        ;
+
+    unfairness
+        .functor([this] {
+            auto [min_slowdown, max_slowdown] = slowdownRange();
+            return min_slowdown > 0 ? max_slowdown / min_slowdown : 0.0;
+        })
+        .precision(4)
+        ;
+
     for (int i = 0; i < max_requestors; i++) {
         const std::string name = system->getRequestorName(i);
         avgPriority.subname(i, name);
         avgPriorityDistance.subname(i, name);
+        requestorTotLatency.subname(i, name);
+        requestorResponses.subname(i, name);
+        requestorMinLatency.subname(i, name);
+        requestorAvgLatency.subname(i, name);
+        requestorSlowdown.subname(i, name);
     }
 
     for (int j = 0; j < num_priorities; ++j) {
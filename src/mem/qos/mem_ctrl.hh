@@ -71,6 +71,27 @@ class Policy;
 class QueuePolicy;
 class TurnaroundPolicy;
 
+/**
+ * Move a packet from a queue to the end of another one. The packet is
+ * removed from the source queue before it is added to the target one,
+ * as queues such as MemPacketQueue keep their own position in the
+ * packets they hold.
+ *
+ * @param src Queue holding the packet
+ * @param it Position of the packet in the source queue
+ * @param dst Queue to add the packet to
+ * @return Position of the packet that followed the moved one
+ */
+template<typename Queue>
+typename Queue::iterator
+moveQueuedPacket(Queue &src, typename Queue::iterator it, Queue &dst)
+{
+    auto pkt = *it;
+    it = src.erase(it);
+    dst.push_back(pkt);
+    return it;
+}
+
 /**
  * The qos::MemCtrl is a base class for Memory objects
  * which support QoS - it provides access to a set of QoS
@@ -169,6 +190,28 @@ class MemCtrl : public ClockedObject
         statistics::Scalar numStayReadState;
         /** Count the number of times bus staying in WRITE state */
         statistics::Scalar numStayWriteState;
+
+        /** per-requestor total latency */
+        statistics::Vector requestorTotLatency;
+        /** per-requestor number of responses */
+        statistics::Vector requestorResponses;
+        /** per-requestor minimum latency */
+        statistics::Vector requestorMinLatency;
+        /** per-requestor average latency */
+        statistics::Formula requestorAvgLatency;
+        /**
+         * per-requestor slowdown, estimated as the ratio of the
+         * average latency to the minimum latency, which approximates
+         * the latency the requestor would see without interference
+         */
+        statistics::Formula requestorSlowdown;
+        /** largest per-requestor slowdown */
+        statistics::Value maxSlowdown;
+        /** ratio of the largest to the smallest per-requestor slowdown */
+        statistics::Value unfairness;
+
+        /** Smallest and largest slowdown across the requestors */
+        std::pair<double, double> slowdownRange();
     } stats;
 
     /** Pointer to the System object */
@@ -423,11 +466,7 @@ MemCtrl::escalateQueues(Queues& queues, uint64_t queue_entry_size,
 
             // Change QoS priority and move packet
             pkt->qosValue(tgt_prio);
-            queues[tgt_prio].push_back(pkt);
-
-            // Erase element from source packet queue, this will
-            // increment the iterator
-            it = queues[curr_prio].erase(it);
+            it = moveQueuedPacket(queues[curr_prio], it, queues[tgt_prio]);
             panic_if(packetPriorities[id][curr_prio] < moved_entries,
                      "qos::MemCtrl::escalateQueues requestor %s negative "
                      "packets for priority %d",
@@ -118,6 +118,28 @@ class Policy : public SimObject
      */
     uint8_t schedule(const PacketPtr pkt);
 
+    /**
+     * Notifies the policy that entries of a requestor have been
+     * queued in the memory controller. Policies that need to know
+     * the requests waiting for each requestor can override it.
+     *
+     * @param requestor_id requestor id of the queued entries
+     * @param entries number of entries queued
+     */
+    virtual void requested(const RequestorID requestor_id,
+                           const uint64_t entries) {}
+
+    /**
+     * Notifies the policy that entries of a requestor have been
+     * served by the memory controller. Application-aware policies
+     * can override it to track the service attained by requestors.
+     *
+     * @param requestor_id requestor id of the served entries
+     * @param entries number of entries served
+     */
+    virtual void served(const RequestorID requestor_id,
+                        const uint64_t entries) {}
+
   protected:
     /** Pointer to parent memory controller implementing the policy */
     MemCtrl* memCtrl;
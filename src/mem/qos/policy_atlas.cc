@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/qos/policy_atlas.hh"
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/QOS.hh"
+#include "params/QoSAtlasPolicy.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace qos
+{
+
+AtlasPolicy::AtlasPolicy(const Params &p)
+  : Policy(p), quantum(p.quantum), quantumEnd(0),
+    service(p.history_weight), stats(*this)
+{
+    fatal_if(quantum == 0, "Quantum must be non-zero\n");
+    fatal_if(p.history_weight < 0 || p.history_weight >= 1,
+             "History weight must be a value between 0 and 1\n");
+}
+
+AtlasPolicy::~AtlasPolicy()
+{}
+
+void
+AtlasPolicy::init()
+{
+    fatal_if(memCtrl->numPriorities() < 2,
+             "%s requires at least two QoS priorities\n", name());
+    quantumEnd = quantum;
+}
+
+void
+AtlasPolicy::checkQuantum()
+{
+    if (curTick() < quantumEnd)
+        return;
+
+    // Update the total attained service and rank the requestors, the
+    // least attained service first
+    const uint8_t max_priority = memCtrl->numPriorities() - 1;
+    for (const RequestorID id : service.rank(max_priority)) {
+        DPRINTF(QOS, "AtlasPolicy::checkQuantum requestor %s [id %d] "
+                "attained service %f priority %d\n",
+                memCtrl->system()->getRequestorName(id), id,
+                service.attained(id), service.priority(id, max_priority));
+    }
+
+    stats.quanta++;
+
+    // skip the quanta that elapsed without any activity
+    quantumEnd += ((curTick() - quantumEnd) / quantum + 1) * quantum;
+}
+
+uint8_t
+AtlasPolicy::schedule(const RequestorID id, const uint64_t data)
+{
+    checkQuantum();
+
+    return service.priority(id, memCtrl->numPriorities() - 1);
+}
+
+void
+AtlasPolicy::served(const RequestorID id, const uint64_t entries)
+{
+    checkQuantum();
+
+    service.served(id, entries);
+}
+
+AtlasPolicy::AtlasStats::AtlasStats(AtlasPolicy &policy)
+    : statistics::Group(&policy),
+    ADD_STAT(quanta, statistics::units::Count::get(),
+             "Number of quanta the requestors have been ranked for")
+{
+}
+
+} // namespace qos
+} // namespace memory
+} // namespace gem5
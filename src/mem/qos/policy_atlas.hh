@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_QOS_POLICY_ATLAS_HH__
+#define __MEM_QOS_POLICY_ATLAS_HH__
+
+#include <cstdint>
+
+#include "base/statistics.hh"
+#include "mem/qos/policy.hh"
+#include "mem/qos/ranking.hh"
+
+namespace gem5
+{
+
+struct QoSAtlasPolicyParams;
+
+namespace memory
+{
+
+namespace qos
+{
+
+/**
+ * Least Attained Service (ATLAS) QoS Policy
+ *
+ * Based on "ATLAS: A scalable and high-performance scheduling
+ * algorithm for multiple memory controllers", Kim et al., HPCA 2010.
+ *
+ * Time is divided in quanta. During a quantum the policy accumulates
+ * the service, in entries served, attained by every requestor. At the
+ * end of a quantum the total attained service of each requestor is
+ * updated as an exponentially weighted average of its past and current
+ * service, and the requestors are ranked: the least attained service
+ * gets the highest QoS priority. The ranking is kept for the whole
+ * quantum.
+ */
+class AtlasPolicy : public Policy
+{
+    using Params = QoSAtlasPolicyParams;
+
+  public:
+    AtlasPolicy(const Params &);
+    virtual ~AtlasPolicy();
+
+    void init() override;
+
+    /**
+     * Schedules a packet based on the requestor rank in the
+     * current quantum
+     *
+     * @param id requestor id to schedule
+     * @param data data to schedule
+     * @return QoS priority value
+     */
+    virtual uint8_t schedule(const RequestorID id,
+                             const uint64_t data) override;
+
+    void served(const RequestorID id, const uint64_t entries) override;
+
+  protected:
+    /** Rank the requestors if the current quantum has elapsed */
+    void checkQuantum();
+
+    /** Length of a quantum */
+    const Tick quantum;
+
+    /** When does the current quantum end? */
+    Tick quantumEnd;
+
+    /** Service attained by the requestors */
+    ServiceRanking service;
+
+    struct AtlasStats : public statistics::Group
+    {
+        AtlasStats(AtlasPolicy &policy);
+
+        /** Number of quanta the requestors have been ranked for */
+        statistics::Scalar quanta;
+    } stats;
+};
+
+} // namespace qos
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_QOS_POLICY_ATLAS_HH__
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/qos/policy_bliss.hh"
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/QOS.hh"
+#include "params/QoSBlissPolicy.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace qos
+{
+
+BlissPolicy::BlissPolicy(const Params &p)
+  : Policy(p), clearingInterval(p.clearing_interval), nextClearing(0),
+    blacklist(p.blacklisting_threshold), stats(*this)
+{
+    fatal_if(p.blacklisting_threshold == 0,
+             "Blacklisting threshold must be non-zero\n");
+    fatal_if(clearingInterval == 0, "Clearing interval must be non-zero\n");
+}
+
+BlissPolicy::~BlissPolicy()
+{}
+
+void
+BlissPolicy::init()
+{
+    fatal_if(memCtrl->numPriorities() < 2,
+             "%s requires at least two QoS priorities\n", name());
+    nextClearing = clearingInterval;
+}
+
+void
+BlissPolicy::checkClearing()
+{
+    if (curTick() < nextClearing)
+        return;
+
+    if (const size_t cleared = blacklist.clear()) {
+        DPRINTF(QOS, "BlissPolicy::checkClearing clearing %d "
+                "blacklisted requestors\n", cleared);
+        stats.clearings++;
+    }
+
+    // skip the intervals that elapsed without any activity
+    nextClearing += ((curTick() - nextClearing) / clearingInterval + 1) *
+        clearingInterval;
+}
+
+uint8_t
+BlissPolicy::schedule(const RequestorID id, const uint64_t data)
+{
+    checkClearing();
+
+    if (blacklist.blacklisted(id)) {
+        return 0;
+    }
+    return memCtrl->numPriorities() - 1;
+}
+
+void
+BlissPolicy::served(const RequestorID id, const uint64_t entries)
+{
+    checkClearing();
+
+    if (blacklist.served(id, entries)) {
+        DPRINTF(QOS, "BlissPolicy::served blacklisting requestor "
+                "%s [id %d]\n", memCtrl->system()->getRequestorName(id), id);
+        stats.blacklistings++;
+    }
+}
+
+BlissPolicy::BlissStats::BlissStats(BlissPolicy &policy)
+    : statistics::Group(&policy),
+    ADD_STAT(blacklistings, statistics::units::Count::get(),
+             "Number of times a requestor has been blacklisted"),
+    ADD_STAT(clearings, statistics::units::Count::get(),
+             "Number of times the blacklist has been cleared")
+{
+}
+
+} // namespace qos
+} // namespace memory
+} // namespace gem5
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_QOS_POLICY_BLISS_HH__
+#define __MEM_QOS_POLICY_BLISS_HH__
+
+#include <cstdint>
+
+#include "base/statistics.hh"
+#include "mem/qos/policy.hh"
+#include "mem/qos/ranking.hh"
+
+namespace gem5
+{
+
+struct QoSBlissPolicyParams;
+
+namespace memory
+{
+
+namespace qos
+{
+
+/**
+ * Blacklisting (BLISS) QoS Policy
+ *
+ * Based on "The Blacklisting Memory Scheduler: Achieving high
+ * performance and fairness at low cost", Subramanian et al., ICCD 2014.
+ *
+ * The policy counts the number of consecutive entries served for the
+ * same requestor. A requestor reaching the blacklisting threshold is
+ * considered to be interfering with the others and is blacklisted:
+ * its packets are assigned the lowest QoS priority while the packets
+ * of all the other requestors are assigned the highest one. The
+ * blacklist is cleared periodically so that requestors are not
+ * deprioritized forever.
+ */
+class BlissPolicy : public Policy
+{
+    using Params = QoSBlissPolicyParams;
+
+  public:
+    BlissPolicy(const Params &);
+    virtual ~BlissPolicy();
+
+    void init() override;
+
+    /**
+     * Schedules a packet based on the requestor being blacklisted
+     *
+     * @param id requestor id to schedule
+     * @param data data to schedule
+     * @return QoS priority value
+     */
+    virtual uint8_t schedule(const RequestorID id,
+                             const uint64_t data) override;
+
+    void served(const RequestorID id, const uint64_t entries) override;
+
+  protected:
+    /** Clear the blacklist if the clearing interval has elapsed */
+    void checkClearing();
+
+    /** Time between two clearings of the blacklist */
+    const Tick clearingInterval;
+
+    /** When is the blacklist cleared next? */
+    Tick nextClearing;
+
+    /** Requestors currently blacklisted */
+    Blacklist blacklist;
+
+    struct BlissStats : public statistics::Group
+    {
+        BlissStats(BlissPolicy &policy);
+
+        /** Number of times a requestor has been blacklisted */
+        statistics::Scalar blacklistings;
+        /** Number of times the blacklist has been cleared */
+        statistics::Scalar clearings;
+    } stats;
+};
+
+} // namespace qos
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_QOS_POLICY_BLISS_HH__
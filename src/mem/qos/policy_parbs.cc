@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/qos/policy_parbs.hh"
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/QOS.hh"
+#include "params/QoSParBsPolicy.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace qos
+{
+
+ParBsPolicy::ParBsPolicy(const Params &p)
+  : Policy(p), batch(p.marking_cap), stats(*this)
+{
+    fatal_if(p.marking_cap == 0, "Marking cap must be non-zero\n");
+}
+
+ParBsPolicy::~ParBsPolicy()
+{}
+
+void
+ParBsPolicy::init()
+{
+    fatal_if(memCtrl->numPriorities() < 2,
+             "%s requires at least two QoS priorities\n", name());
+}
+
+void
+ParBsPolicy::formBatch()
+{
+    const uint8_t max_priority = memCtrl->numPriorities() - 1;
+    for (const RequestorID id : batch.form(max_priority)) {
+        DPRINTF(QOS, "ParBsPolicy::formBatch requestor %s [id %d] "
+                "marked %d priority %d\n",
+                memCtrl->system()->getRequestorName(id), id,
+                batch.marked(id), batch.priority(id));
+    }
+
+    if (batch.batchSize()) {
+        stats.batches++;
+        stats.markedEntries += batch.batchSize();
+    }
+}
+
+uint8_t
+ParBsPolicy::schedule(const RequestorID id, const uint64_t data)
+{
+    // The packet is only logged as requested once it is accepted,
+    // after being scheduled. Without a batch in progress, the batch
+    // formed then includes the packet, which is prioritised as ranked
+    // in that batch. During a batch, the entries beyond those marked
+    // for the requestor get the lowest priority
+    if (batch.batchSize() == 0) {
+        return batch.pending(id, memCtrl->numPriorities() - 1);
+    }
+    return batch.schedule(id);
+}
+
+void
+ParBsPolicy::requested(const RequestorID id, const uint64_t entries)
+{
+    batch.requested(id, entries);
+
+    if (batch.batchSize() == 0) {
+        formBatch();
+    }
+}
+
+void
+ParBsPolicy::served(const RequestorID id, const uint64_t entries)
+{
+    if (batch.served(id, entries)) {
+        formBatch();
+    }
+}
+
+ParBsPolicy::ParBsStats::ParBsStats(ParBsPolicy &policy)
+    : statistics::Group(&policy),
+    ADD_STAT(batches, statistics::units::Count::get(),
+             "Number of batches formed"),
+    ADD_STAT(markedEntries, statistics::units::Count::get(),
+             "Number of entries marked across all batches"),
+    ADD_STAT(avgBatchSize, statistics::units::Rate<
+                statistics::units::Count, statistics::units::Count>::get(),
+             "Average number of entries marked per batch",
+             markedEntries / batches)
+{
+}
+
+} // namespace qos
+} // namespace memory
+} // namespace gem5
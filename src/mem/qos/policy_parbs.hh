@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_QOS_POLICY_PARBS_HH__
+#define __MEM_QOS_POLICY_PARBS_HH__
+
+#include <cstdint>
+
+#include "base/statistics.hh"
+#include "mem/qos/policy.hh"
+#include "mem/qos/ranking.hh"
+
+namespace gem5
+{
+
+struct QoSParBsPolicyParams;
+
+namespace memory
+{
+
+namespace qos
+{
+
+/**
+ * Parallelism-Aware Batch Scheduling (PAR-BS) QoS Policy
+ *
+ * Based on "Parallelism-Aware Batch Scheduling: Enhancing both
+ * performance and fairness of shared DRAM systems", Mutlu and
+ * Moscibroda, ISCA 2008.
+ *
+ * Requests are grouped in batches: when a batch is formed, up to
+ * marking cap of the entries queued by every requestor are marked as
+ * part of the batch, and a new batch is only formed once all the
+ * marked entries have been served, which bounds the time any
+ * requestor can be starved. Within a batch, requestors are ranked
+ * shortest job first, the requestor with the fewest marked entries
+ * getting the highest QoS priority. Requestors without marked
+ * entries get the lowest priority.
+ */
+class ParBsPolicy : public Policy
+{
+    using Params = QoSParBsPolicyParams;
+
+  public:
+    ParBsPolicy(const Params &);
+    virtual ~ParBsPolicy();
+
+    void init() override;
+
+    /**
+     * Schedules a packet based on the requestor rank in the
+     * current batch
+     *
+     * @param id requestor id to schedule
+     * @param data data to schedule
+     * @return QoS priority value
+     */
+    virtual uint8_t schedule(const RequestorID id,
+                             const uint64_t data) override;
+
+    void requested(const RequestorID id, const uint64_t entries) override;
+
+    void served(const RequestorID id, const uint64_t entries) override;
+
+  protected:
+    /** Mark the queued entries of a new batch and rank the requestors */
+    void formBatch();
+
+    /** Batch state of the requestors */
+    BatchRanking batch;
+
+    struct ParBsStats : public statistics::Group
+    {
+        ParBsStats(ParBsPolicy &policy);
+
+        /** Number of batches formed */
+        statistics::Scalar batches;
+        /** Number of entries marked across all batches */
+        statistics::Scalar markedEntries;
+        /** Average number of entries marked per batch */
+        statistics::Formula avgBatchSize;
+    } stats;
+};
+
+} // namespace qos
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_QOS_POLICY_PARBS_HH__
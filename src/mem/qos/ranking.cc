@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/qos/ranking.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace qos
+{
+
+Blacklist::Blacklist(unsigned threshold)
+  : threshold(threshold), lastServed(Request::invldRequestorId), streak(0)
+{
+}
+
+bool
+Blacklist::served(const RequestorID id, const uint64_t entries)
+{
+    if (id == lastServed) {
+        streak += entries;
+    } else {
+        lastServed = id;
+        streak = entries;
+    }
+
+    if (streak < threshold)
+        return false;
+
+    streak = 0;
+    return blacklist.insert(id).second;
+}
+
+size_t
+Blacklist::clear()
+{
+    const size_t cleared = blacklist.size();
+    blacklist.clear();
+    return cleared;
+}
+
+ServiceRanking::ServiceRanking(double history_weight)
+  : historyWeight(history_weight)
+{
+}
+
+void
+ServiceRanking::served(const RequestorID id, const uint64_t entries)
+{
+    service[id].current += entries;
+}
+
+std::vector<RequestorID>
+ServiceRanking::rank(const uint8_t max_priority)
+{
+    std::vector<std::pair<double, RequestorID>> ranking;
+    ranking.reserve(service.size());
+    for (auto &entry : service) {
+        Service &s = entry.second;
+        s.total = historyWeight * s.total +
+            (1.0 - historyWeight) * s.current;
+        s.current = 0;
+        ranking.emplace_back(s.total, entry.first);
+    }
+    std::sort(ranking.begin(), ranking.end());
+
+    std::vector<RequestorID> ranked;
+    ranked.reserve(ranking.size());
+    for (size_t rank = 0; rank < ranking.size(); ++rank) {
+        const RequestorID id = ranking[rank].second;
+        Service &s = service[id];
+        s.priority = rank < max_priority ? max_priority - rank : 0;
+        s.ranked = true;
+        ranked.push_back(id);
+    }
+    return ranked;
+}
+
+uint8_t
+ServiceRanking::priority(const RequestorID id,
+                         const uint8_t max_priority) const
+{
+    auto it = service.find(id);
+    if (it == service.end() || !it->second.ranked)
+        return max_priority;
+    return it->second.priority;
+}
+
+double
+ServiceRanking::attained(const RequestorID id) const
+{
+    auto it = service.find(id);
+    return it == service.end() ? 0 : it->second.total;
+}
+
+BatchRanking::BatchRanking(unsigned marking_cap)
+  : markingCap(marking_cap), batchMarked(0)
+{
+}
+
+void
+BatchRanking::requested(const RequestorID id, const uint64_t entries)
+{
+    requestors[id].queued += entries;
+}
+
+bool
+BatchRanking::served(const RequestorID id, const uint64_t entries)
+{
+    auto it = requestors.find(id);
+    if (it == requestors.end())
+        return false;
+
+    Batch &b = it->second;
+    b.queued -= std::min(b.queued, entries);
+
+    const uint64_t served_marked = std::min(b.marked, entries);
+    b.marked -= served_marked;
+    batchMarked -= served_marked;
+
+    return served_marked && batchMarked == 0;
+}
+
+std::vector<std::pair<uint64_t, RequestorID>>
+BatchRanking::ranking(const RequestorID extra) const
+{
+    std::vector<std::pair<uint64_t, RequestorID>> ranking;
+    bool extra_found = false;
+    for (auto &entry : requestors) {
+        uint64_t queued = entry.second.queued;
+        if (entry.first == extra) {
+            queued++;
+            extra_found = true;
+        }
+        const uint64_t marked = std::min<uint64_t>(queued, markingCap);
+        if (marked)
+            ranking.emplace_back(marked, entry.first);
+    }
+    if (extra != Request::invldRequestorId && !extra_found)
+        ranking.emplace_back(1, extra);
+
+    // Shortest job first, the fewer marked entries the higher the
+    // priority
+    std::sort(ranking.begin(), ranking.end());
+    return ranking;
+}
+
+std::vector<RequestorID>
+BatchRanking::form(const uint8_t max_priority)
+{
+    assert(batchMarked == 0);
+
+    for (auto &entry : requestors) {
+        entry.second.marked = 0;
+        entry.second.batched = 0;
+        entry.second.scheduled = 0;
+        entry.second.priority = 0;
+    }
+
+    std::vector<RequestorID> ranked;
+    const auto batch = ranking(Request::invldRequestorId);
+    ranked.reserve(batch.size());
+    for (size_t rank = 0; rank < batch.size(); ++rank) {
+        Batch &b = requestors[batch[rank].second];
+        b.marked = batch[rank].first;
+        b.batched = b.marked;
+        b.priority = rankPriority(rank, max_priority);
+        batchMarked += b.marked;
+        ranked.push_back(batch[rank].second);
+    }
+    return ranked;
+}
+
+uint8_t
+BatchRanking::priority(const RequestorID id) const
+{
+    // A requestor keeps its priority as long as it has marked entries
+    auto it = requestors.find(id);
+    if (it == requestors.end() || it->second.marked == 0)
+        return 0;
+    return it->second.priority;
+}
+
+uint8_t
+BatchRanking::schedule(const RequestorID id)
+{
+    // Entries queued during a batch are not part of it, only as many
+    // entries as the requestor has marked get its priority
+    auto it = requestors.find(id);
+    if (it == requestors.end() || it->second.marked == 0 ||
+        it->second.scheduled >= it->second.batched) {
+        return 0;
+    }
+    it->second.scheduled++;
+    return it->second.priority;
+}
+
+uint8_t
+BatchRanking::pending(const RequestorID id, const uint8_t max_priority) const
+{
+    const auto batch = ranking(id);
+    for (size_t rank = 0; rank < batch.size(); ++rank) {
+        if (batch[rank].second == id)
+            return rankPriority(rank, max_priority);
+    }
+    panic("Requestor %d missing from its own batch\n", id);
+}
+
+uint64_t
+BatchRanking::marked(const RequestorID id) const
+{
+    auto it = requestors.find(id);
+    return it == requestors.end() ? 0 : it->second.marked;
+}
+
+} // namespace qos
+} // namespace memory
+} // namespace gem5
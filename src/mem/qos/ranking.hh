@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_QOS_RANKING_HH__
+#define __MEM_QOS_RANKING_HH__
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "mem/request.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace qos
+{
+
+/**
+ * Requestor state of the BLISS policy, tracking the entries served in
+ * a row for the same requestor and blacklisting the requestors
+ * reaching the threshold.
+ */
+class Blacklist
+{
+  public:
+    Blacklist(unsigned threshold);
+
+    /**
+     * Accounts for entries served for a requestor
+     *
+     * @return true if the requestor has just been blacklisted
+     */
+    bool served(const RequestorID id, const uint64_t entries);
+
+    /** Is the requestor blacklisted? */
+    bool
+    blacklisted(const RequestorID id) const
+    {
+        return blacklist.count(id);
+    }
+
+    /**
+     * Clears the blacklist
+     *
+     * @return number of requestors that were blacklisted
+     */
+    size_t clear();
+
+  protected:
+    /** Consecutive entries served before blacklisting a requestor */
+    const unsigned threshold;
+
+    /** Last requestor served */
+    RequestorID lastServed;
+
+    /** Entries served in a row for the last requestor */
+    uint64_t streak;
+
+    /** Requestors currently blacklisted */
+    std::unordered_set<RequestorID> blacklist;
+};
+
+/**
+ * Requestor state of the ATLAS policy, ranking the requestors by
+ * their total attained service, least attained first.
+ */
+class ServiceRanking
+{
+  public:
+    ServiceRanking(double history_weight);
+
+    /** Accounts for entries served for a requestor */
+    void served(const RequestorID id, const uint64_t entries);
+
+    /**
+     * Ends a quantum: updates the total attained service of every
+     * requestor and ranks them. The requestors that do not get a
+     * priority of their own share priority 0.
+     *
+     * @param max_priority priority of the first ranked requestor
+     * @return the requestors, from the highest priority down
+     */
+    std::vector<RequestorID> rank(const uint8_t max_priority);
+
+    /**
+     * Priority of a requestor in the current quantum, requestors not
+     * seen so far have not attained any service and get the highest
+     * priority until the next ranking
+     */
+    uint8_t priority(const RequestorID id,
+                     const uint8_t max_priority) const;
+
+    /** Total attained service of a requestor, as of the last ranking */
+    double attained(const RequestorID id) const;
+
+  protected:
+    /** Weight of the past attained service in the total */
+    const double historyWeight;
+
+    struct Service
+    {
+        /** Service attained in the current quantum */
+        uint64_t current = 0;
+        /** Total attained service, as of the last quantum */
+        double total = 0;
+        /** QoS priority for the current quantum */
+        uint8_t priority = 0;
+        /** Has the requestor been ranked yet? */
+        bool ranked = false;
+    };
+
+    /** Service attained by every requestor seen so far */
+    std::unordered_map<RequestorID, Service> service;
+};
+
+/**
+ * Requestor state of the PAR-BS policy. A batch marks up to the
+ * marking cap of the entries queued by every requestor, and ranks the
+ * requestors shortest job first. Priority 0 is left for the
+ * requestors without marked entries.
+ */
+class BatchRanking
+{
+  public:
+    BatchRanking(unsigned marking_cap);
+
+    /** Accounts for entries queued by a requestor */
+    void requested(const RequestorID id, const uint64_t entries);
+
+    /**
+     * Accounts for entries served for a requestor, the marked entries
+     * being assumed to be served first
+     *
+     * @return true if the last marked entry of the batch was served
+     */
+    bool served(const RequestorID id, const uint64_t entries);
+
+    /**
+     * Forms a new batch from the queued entries, the current batch
+     * must have been completely served
+     *
+     * @param max_priority priority of the first ranked requestor
+     * @return the requestors in the batch, from the highest priority
+     * down
+     */
+    std::vector<RequestorID> form(const uint8_t max_priority);
+
+    /** Priority of a requestor in the current batch */
+    uint8_t priority(const RequestorID id) const;
+
+    /**
+     * Priority of an entry a requestor queues during the current
+     * batch. A requestor only gets its batch priority for as many
+     * entries as it has marked, later entries get the lowest priority
+     * so that a streaming requestor cannot starve the others.
+     */
+    uint8_t schedule(const RequestorID id);
+
+    /**
+     * Priority a requestor would get in a batch formed once an entry
+     * it is about to queue is accounted for
+     */
+    uint8_t pending(const RequestorID id, const uint8_t max_priority) const;
+
+    /** Entries marked for a requestor and still to be served */
+    uint64_t marked(const RequestorID id) const;
+
+    /** Entries of the current batch still to be served */
+    uint64_t batchSize() const { return batchMarked; }
+
+  protected:
+    /**
+     * Ranks the requestors with marked entries
+     *
+     * @return the marked entries and the requestor, by decreasing
+     * priority
+     */
+    std::vector<std::pair<uint64_t, RequestorID>> ranking(
+        const RequestorID extra) const;
+
+    /** Priority of the requestor with the given rank */
+    static uint8_t
+    rankPriority(const size_t rank, const uint8_t max_priority)
+    {
+        return rank < max_priority ? max_priority - rank : 1;
+    }
+
+    /** Maximum number of entries marked per requestor in a batch */
+    const unsigned markingCap;
+
+    struct Batch
+    {
+        /** Entries queued in the controller */
+        uint64_t queued = 0;
+        /** Entries marked in the current batch, still to be served */
+        uint64_t marked = 0;
+        /** Entries marked when the current batch was formed */
+        uint64_t batched = 0;
+        /** Entries scheduled with the batch priority in the batch */
+        uint64_t scheduled = 0;
+        /** QoS priority in the current batch */
+        uint8_t priority = 0;
+    };
+
+    /** Batch state of every requestor seen so far */
+    std::unordered_map<RequestorID, Batch> requestors;
+
+    /** Entries of the current batch that are still to be served */
+    uint64_t batchMarked;
+};
+
+} // namespace qos
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_QOS_RANKING_HH__
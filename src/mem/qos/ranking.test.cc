@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "mem/qos/ranking.hh"
+
+using namespace gem5;
+using namespace gem5::memory::qos;
+
+/** A requestor is blacklisted once served threshold entries in a row. */
+TEST(QoSBlacklistTest, Streak)
+{
+    Blacklist blacklist(4);
+    EXPECT_FALSE(blacklist.served(0, 3));
+    EXPECT_FALSE(blacklist.blacklisted(0));
+    EXPECT_TRUE(blacklist.served(0, 1));
+    EXPECT_TRUE(blacklist.blacklisted(0));
+    EXPECT_FALSE(blacklist.blacklisted(1));
+
+    // Already blacklisted, the requestor is not blacklisted again
+    EXPECT_FALSE(blacklist.served(0, 4));
+    EXPECT_TRUE(blacklist.blacklisted(0));
+}
+
+/** Serving another requestor breaks the streak. */
+TEST(QoSBlacklistTest, Interleaved)
+{
+    Blacklist blacklist(3);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_FALSE(blacklist.served(0, 2));
+        EXPECT_FALSE(blacklist.served(1, 2));
+    }
+    EXPECT_FALSE(blacklist.blacklisted(0));
+    EXPECT_FALSE(blacklist.blacklisted(1));
+
+    EXPECT_TRUE(blacklist.served(1, 1));
+    EXPECT_TRUE(blacklist.blacklisted(1));
+    EXPECT_FALSE(blacklist.blacklisted(0));
+}
+
+/** Clearing the blacklist reports and forgets the requestors. */
+TEST(QoSBlacklistTest, Clear)
+{
+    Blacklist blacklist(1);
+    EXPECT_TRUE(blacklist.served(0, 1));
+    EXPECT_TRUE(blacklist.served(1, 1));
+    EXPECT_EQ(2, blacklist.clear());
+    EXPECT_FALSE(blacklist.blacklisted(0));
+    EXPECT_FALSE(blacklist.blacklisted(1));
+    EXPECT_EQ(0, blacklist.clear());
+}
+
+/** Requestors not ranked yet get the highest priority. */
+TEST(QoSServiceRankingTest, Unranked)
+{
+    ServiceRanking service(0);
+    EXPECT_EQ(3, service.priority(0, 3));
+    service.served(0, 10);
+    EXPECT_EQ(3, service.priority(0, 3));
+}
+
+/** The least attained service gets the highest priority. */
+TEST(QoSServiceRankingTest, LeastAttainedFirst)
+{
+    ServiceRanking service(0);
+    service.served(0, 30);
+    service.served(1, 10);
+    service.served(2, 20);
+
+    const std::vector<RequestorID> ranked = service.rank(3);
+    EXPECT_EQ(std::vector<RequestorID>({1, 2, 0}), ranked);
+    EXPECT_EQ(3, service.priority(1, 3));
+    EXPECT_EQ(2, service.priority(2, 3));
+    EXPECT_EQ(1, service.priority(0, 3));
+    EXPECT_DOUBLE_EQ(30, service.attained(0));
+}
+
+/** Requestors beyond the available priorities share priority 0. */
+TEST(QoSServiceRankingTest, SharedLowestPriority)
+{
+    ServiceRanking service(0);
+    for (RequestorID id = 0; id < 4; ++id)
+        service.served(id, id + 1);
+
+    service.rank(1);
+    EXPECT_EQ(1, service.priority(0, 1));
+    EXPECT_EQ(0, service.priority(1, 1));
+    EXPECT_EQ(0, service.priority(2, 1));
+    EXPECT_EQ(0, service.priority(3, 1));
+}
+
+/** The total attained service is a weighted average over the quanta. */
+TEST(QoSServiceRankingTest, History)
+{
+    ServiceRanking service(0.5);
+    service.served(0, 100);
+    service.served(1, 10);
+    service.rank(1);
+    EXPECT_DOUBLE_EQ(50, service.attained(0));
+    EXPECT_DOUBLE_EQ(5, service.attained(1));
+    EXPECT_EQ(1, service.priority(1, 1));
+
+    // Requestor 0 is idle during the quantum, its total decays while
+    // it still ranks behind requestor 1
+    service.served(1, 60);
+    service.rank(1);
+    EXPECT_DOUBLE_EQ(25, service.attained(0));
+    EXPECT_DOUBLE_EQ(32.5, service.attained(1));
+    EXPECT_EQ(1, service.priority(0, 1));
+    EXPECT_EQ(0, service.priority(1, 1));
+}
+
+/** A batch ranks the requestors shortest job first. */
+TEST(QoSBatchRankingTest, ShortestJobFirst)
+{
+    BatchRanking batch(5);
+    batch.requested(0, 4);
+    batch.requested(1, 1);
+    batch.requested(2, 8);
+
+    const std::vector<RequestorID> ranked = batch.form(3);
+    EXPECT_EQ(std::vector<RequestorID>({1, 0, 2}), ranked);
+    EXPECT_EQ(3, batch.priority(1));
+    EXPECT_EQ(2, batch.priority(0));
+    EXPECT_EQ(1, batch.priority(2));
+
+    // The marking cap bounds the entries of a requestor in the batch
+    EXPECT_EQ(5, batch.marked(2));
+    EXPECT_EQ(10, batch.batchSize());
+
+    // Requestors outside of the batch get the lowest priority
+    EXPECT_EQ(0, batch.priority(3));
+}
+
+/** Requestors keep their priority until their marked entries are served. */
+TEST(QoSBatchRankingTest, Served)
+{
+    BatchRanking batch(2);
+    batch.requested(0, 2);
+    batch.requested(1, 3);
+    batch.form(1);
+
+    // Entries queued during the batch are not part of it
+    batch.requested(0, 1);
+    EXPECT_EQ(2, batch.marked(0));
+
+    EXPECT_FALSE(batch.served(0, 2));
+    EXPECT_EQ(0, batch.priority(0));
+    EXPECT_EQ(1, batch.priority(1));
+
+    EXPECT_FALSE(batch.served(1, 1));
+    EXPECT_TRUE(batch.served(1, 1));
+    EXPECT_EQ(0, batch.batchSize());
+
+    // The next batch marks the entries left
+    batch.form(1);
+    EXPECT_EQ(1, batch.marked(0));
+    EXPECT_EQ(1, batch.marked(1));
+    EXPECT_EQ(2, batch.batchSize());
+}
+
+/**
+ * A requestor that keeps queueing during a batch only gets its batch
+ * priority for as many entries as it has marked.
+ */
+TEST(QoSBatchRankingTest, ScheduledDuringBatch)
+{
+    BatchRanking batch(2);
+    batch.requested(0, 2);
+    batch.requested(1, 4);
+    batch.form(3);
+    EXPECT_EQ(3, batch.priority(0));
+    EXPECT_EQ(2, batch.priority(1));
+
+    // The streaming requestor uses up its budget of marked entries,
+    // its later entries get the lowest priority while it still has
+    // marked entries to be served
+    EXPECT_EQ(2, batch.schedule(1));
+    EXPECT_EQ(2, batch.schedule(1));
+    EXPECT_EQ(0, batch.schedule(1));
+    EXPECT_EQ(0, batch.schedule(1));
+    EXPECT_EQ(2, batch.marked(1));
+    EXPECT_EQ(2, batch.priority(1));
+
+    // Serving entries does not give it more budget
+    EXPECT_FALSE(batch.served(1, 1));
+    EXPECT_EQ(0, batch.schedule(1));
+
+    // The other requestor keeps its priority
+    EXPECT_EQ(3, batch.schedule(0));
+
+    // A new batch gives a new budget
+    EXPECT_FALSE(batch.served(0, 2));
+    EXPECT_TRUE(batch.served(1, 1));
+    batch.form(3);
+    EXPECT_EQ(3, batch.schedule(1));
+}
+
+/**
+ * Without a batch in progress, an entry about to be queued is ranked
+ * as part of the next batch.
+ */
+TEST(QoSBatchRankingTest, Pending)
+{
+    BatchRanking batch(4);
+
+    // A lone requestor gets the highest priority, as it does once the
+    // batch is formed
+    EXPECT_EQ(3, batch.pending(0, 3));
+    batch.requested(0, 1);
+    batch.form(3);
+    EXPECT_EQ(3, batch.priority(0));
+    EXPECT_TRUE(batch.served(0, 1));
+
+    // With entries queued by others, the entry is ranked among them
+    batch.requested(1, 1);
+    batch.requested(2, 3);
+    EXPECT_EQ(3, batch.pending(0, 3));
+    EXPECT_EQ(3, batch.pending(1, 3));
+    EXPECT_EQ(2, batch.pending(2, 3));
+    EXPECT_EQ(0, batch.batchSize());
+
+    batch.requested(0, 1);
+    batch.form(3);
+    EXPECT_EQ(3, batch.priority(0));
+    EXPECT_EQ(2, batch.priority(1));
+    EXPECT_EQ(1, batch.priority(2));
+}
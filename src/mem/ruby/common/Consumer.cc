@@ -40,6 +40,8 @@
 
 #include "mem/ruby/common/Consumer.hh"
 
+#include "base/logging.hh"
+
 namespace gem5
 {
 
@@ -62,6 +64,11 @@ Consumer::scheduleEvent(Cycles timeDelta)
 void
 Consumer::scheduleEventAbsolute(Tick evt_time)
 {
+    // The wakeup state belongs to the thread simulating the consumer,
+    // objects on other event queues must go through a MessageBuffer
+    panic_if(inParallelMode && em->eventQueue() != curEventQueue(),
+             "%s: Consumer woken up from another event queue\n", em->name());
+
     m_wakeup_ticks.insert(
         divCeil(evt_time, em->clockPeriod()) * em->clockPeriod());
     scheduleNextWakeup();
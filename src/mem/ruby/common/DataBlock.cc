@@ -53,9 +53,8 @@ DataBlock::DataBlock(const DataBlock &cp)
 {
     uint8_t *block_update;
     size_t block_bytes = RubySystem::getBlockSizeBytes();
-    m_data = new uint8_t[block_bytes];
+    alloc();
     memcpy(m_data, cp.m_data, block_bytes);
-    m_alloc = true;
     // If this data block is involved in an atomic operation, the effect
     // of applying the atomic operations on the data block are recorded in
     // m_atomicLog. If so, we must copy over every entry in the change log
@@ -69,9 +68,16 @@ DataBlock::DataBlock(const DataBlock &cp)
 void
 DataBlock::alloc()
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    m_alloc = true;
-    clear();
+    // Only allocate the storage separately for large blocks, which
+    // keeps the data of messages and cache entries within the objects
+    // themselves for the common block sizes
+    if (RubySystem::getBlockSizeBytes() <= inlineBlockBytes) {
+        m_data = m_inline;
+        m_alloc = false;
+    } else {
+        m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
+        m_alloc = true;
+    }
 }
 
 void
@@ -64,6 +64,7 @@ class DataBlock
     DataBlock()
     {
         alloc();
+        clear();
     }
 
     DataBlock(const DataBlock &cp);
@@ -102,9 +103,13 @@ class DataBlock
     void print(std::ostream& out) const;
 
   private:
+    //! Blocks up to this size are stored within the DataBlock itself
+    static constexpr int inlineBlockBytes = 64;
+
     void alloc();
     uint8_t *m_data;
     bool m_alloc;
+    uint8_t m_inline[inlineBlockBytes];
 
     // Tracks block changes when atomic ops are applied
     std::deque<uint8_t*> m_atomicLog;
@@ -40,7 +40,10 @@
 
 #include "mem/ruby/network/MessageBuffer.hh"
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <string>
 
 #include "base/cprintf.hh"
 #include "base/logging.hh"
@@ -55,6 +58,33 @@ namespace gem5
 namespace ruby
 {
 
+namespace
+{
+
+/** Bit of the line summary of a buffer a line address maps to. */
+uint64_t
+lineSummaryBit(Addr line_addr)
+{
+    return 1ULL << ((line_addr >> RubySystem::getBlockSizeBits()) & 63);
+}
+
+/** Bits of the line summary of a buffer covering a range of addresses. */
+uint64_t
+lineSummaryMask(Addr addr, unsigned size)
+{
+    const Addr first = addr >> RubySystem::getBlockSizeBits();
+    const Addr last = (addr + std::max(size, 1U) - 1) >>
+        RubySystem::getBlockSizeBits();
+    if (last - first >= 63)
+        return ~0ULL;
+    uint64_t mask = 0;
+    for (Addr line = first; line <= last; ++line)
+        mask |= 1ULL << (line & 63);
+    return mask;
+}
+
+} // anonymous namespace
+
 using stl_helpers::operator<<;
 
 MessageBuffer::MessageBuffer(const Params &p)
@@ -86,6 +116,10 @@ MessageBuffer::MessageBuffer(const Params &p)
              "Average occupancy of buffer capacity")
 {
     m_msg_counter = 0;
+    m_shared_size = 0;
+    m_remote_not_avail_count = 0;
+    m_random.init(std::hash<std::string>()(name()));
+    m_line_summary = 0;
     m_consumer = NULL;
     m_size_last_time_size_checked = 0;
     m_size_at_cycle_start = 0;
@@ -133,12 +167,26 @@ MessageBuffer::MessageBuffer(const Params &p)
     m_avg_stall_time = m_stall_time / m_msg_count;
 }
 
+void
+MessageBuffer::resetStats()
+{
+    SimObject::resetStats();
+    m_remote_not_avail_count = 0;
+}
+
+void
+MessageBuffer::preDumpStats()
+{
+    SimObject::preDumpStats();
+    m_not_avail_count += m_remote_not_avail_count.exchange(0);
+}
+
 unsigned int
 MessageBuffer::getSize(Tick curTime)
 {
     if (m_time_last_time_size_checked != curTime) {
         m_time_last_time_size_checked = curTime;
-        m_size_last_time_size_checked = m_prio_heap.size();
+        m_size_last_time_size_checked = m_msg_queue.size();
     }
 
     return m_size_last_time_size_checked;
@@ -153,6 +201,16 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
         return true;
     }
 
+    // the consumer's view of the buffer belongs to another thread when
+    // sending across event queues, only the total count can be used
+    if (isRemoteAccess()) {
+        if (m_shared_size + n <= m_max_size) {
+            return true;
+        }
+        m_remote_not_avail_count.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
     // determine the correct size for the current cycle
     // pop operations shouldn't effect the network's visible size
     // until schd cycle, but enqueue operations effect the visible
@@ -162,7 +220,7 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
 
     if (m_time_last_time_pop < current_time) {
         // no pops this cycle - heap and stall queue size is correct
-        current_size = m_prio_heap.size();
+        current_size = m_msg_queue.size();
         current_stall_size = m_stall_map_size;
     } else {
         if (m_time_last_time_enqueue < current_time) {
@@ -185,7 +243,7 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
         DPRINTF(RubyQueue, "n: %d, current_size: %d, heap size: %d, "
                 "m_max_size: %d\n",
                 n, current_size + current_stall_size,
-                m_prio_heap.size(), m_max_size);
+                m_msg_queue.size(), m_max_size);
         m_not_avail_count++;
         return false;
     }
@@ -195,7 +253,7 @@ const Message*
 MessageBuffer::peek() const
 {
     DPRINTF(RubyQueue, "Peeking at head of queue.\n");
-    const Message* msg_ptr = m_prio_heap.front().get();
+    const Message* msg_ptr = m_msg_queue.front().get();
     assert(msg_ptr);
 
     DPRINTF(RubyQueue, "Message: %s\n", (*msg_ptr));
@@ -204,19 +262,96 @@ MessageBuffer::peek() const
 
 // FIXME - move me somewhere else
 Tick
-random_time()
+random_time(Random &rng)
 {
     Tick time = 1;
-    time += random_mt.random(0, 3);  // [0...3]
-    if (random_mt.random(0, 7) == 0) {  // 1 in 8 chance
-        time += 100 + random_mt.random(1, 15); // 100 + [1...15]
+    time += rng.random(0, 3);  // [0...3]
+    if (rng.random(0, 7) == 0) {  // 1 in 8 chance
+        time += 100 + rng.random(1, 15); // 100 + [1...15]
     }
     return time;
 }
 
+Tick
+random_time()
+{
+    return random_time(random_mt);
+}
+
 void
 MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta,
                        bool bypassStrictFIFO)
+{
+    panic_if((delta == 0) && !m_allow_zero_latency,
+           "Delta equals zero and allow_zero_latency is false during enqueue");
+
+    // Note the line of the message in the summary, messages that do
+    // not refer to a line may match any functional access
+    Message* msg_ptr = message.get();
+    assert(msg_ptr != NULL);
+    Addr line_addr;
+    const uint64_t line_bits = msg_ptr->getAccessedLine(line_addr) ?
+        lineSummaryBit(line_addr) : ~0ULL;
+    if ((m_line_summary.load(std::memory_order_relaxed) & line_bits) !=
+        line_bits) {
+        m_line_summary.fetch_or(line_bits, std::memory_order_relaxed);
+    }
+
+    m_shared_size++;
+
+    if (isRemoteAccess()) {
+        enqueueRemote(std::move(message), current_time, delta,
+                      bypassStrictFIFO);
+    } else {
+        insertMessage(std::move(message), current_time, delta,
+                      bypassStrictFIFO);
+    }
+}
+
+void
+MessageBuffer::enqueueRemote(MsgPtr message, Tick current_time, Tick delta,
+                             bool bypassStrictFIFO)
+{
+    // Events scheduled in another event queue only get there at the
+    // end of the current quantum, the link latency is the lookahead
+    // and must cover the quantum for the message to arrive in time
+    const Tick delivery_time = current_time + delta;
+    fatal_if(delivery_time < curTick() + simQuantum,
+             "%s: Message sent across event queues with a latency of %d "
+             "ticks, lower than the simulation quantum of %d ticks\n",
+             name(), delivery_time - curTick(), simQuantum);
+
+    DPRINTF(RubyQueue, "Remote enqueue delivery_time: %lld, Message: %s\n",
+            delivery_time, *(message.get()));
+
+    std::list<MsgPtr>::iterator it;
+    {
+        std::lock_guard<std::mutex> lock(m_in_flight_mutex);
+        it = m_in_flight.insert(m_in_flight.end(), std::move(message));
+    }
+
+    // Deliver the message ahead of any consumer wakeup at that tick.
+    // The rest of the buffer belongs to the consumer's thread, so the
+    // message is only accounted for and given its arrival time there.
+    auto *delivery = new EventFunctionWrapper(
+        [this, it, current_time, delta, bypassStrictFIFO]
+        {
+            MsgPtr msg;
+            {
+                std::lock_guard<std::mutex> lock(m_in_flight_mutex);
+                msg = std::move(*it);
+                m_in_flight.erase(it);
+            }
+            insertMessage(std::move(msg), current_time, delta,
+                          bypassStrictFIFO);
+        }, name() + ".delivery", true, Event::Minimum_Pri);
+    m_consumer->getObject()->eventQueue()->schedule(delivery,
+                                                    delivery_time);
+}
+
+void
+MessageBuffer::insertMessage(MsgPtr message, Tick current_time, Tick delta,
+                             bool bypassStrictFIFO)
 {
     // record current time incase we have a pop that also adjusts my size
     if (m_time_last_time_enqueue < current_time) {
@@ -229,8 +364,6 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta,
 
     // Calculate the arrival time of the message, that is, the first
     // cycle the message can be dequeued.
-    panic_if((delta == 0) && !m_allow_zero_latency,
-           "Delta equals zero and allow_zero_latency is false during enqueue");
     Tick arrival_time = 0;
 
     // random delays are inserted if the RubySystem level randomization flag
@@ -241,15 +374,21 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta,
         // No randomization
         arrival_time = current_time + delta;
     } else {
-        // Randomization - ignore delta
+        // Randomization - ignore delta. Buffers on different event
+        // queues are randomized concurrently in parallel mode, so each
+        // buffer draws from a generator of its own then.
+        Random &rng = inParallelMode ? m_random : random_mt;
         if (m_strict_fifo) {
             if (m_last_arrival_time < current_time) {
                 m_last_arrival_time = current_time;
             }
-            arrival_time = m_last_arrival_time + random_time();
+            arrival_time = m_last_arrival_time + random_time(rng);
         } else {
-            arrival_time = current_time + random_time();
+            arrival_time = current_time + random_time(rng);
         }
+        // messages from other event queues are only inserted once
+        // they get to the consumer's queue
+        arrival_time = std::max(arrival_time, curTick());
     }
 
     // Check the arrival time
@@ -282,17 +421,16 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta,
     msg_ptr->setLastEnqueueTime(arrival_time);
     msg_ptr->setMsgCounter(m_msg_counter);
 
+    DPRINTF(RubyQueue, "Enqueue arrival_time: %lld, Message: %s\n",
+            arrival_time, *(message.get()));
+
     // Insert the message into the priority heap
-    m_prio_heap.push_back(message);
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
+    m_msg_queue.push(std::move(message));
     // Increment the number of messages statistic
     m_buf_msgs++;
 
     assert((m_max_size == 0) ||
-           ((m_prio_heap.size() + m_stall_map_size) <= m_max_size));
-
-    DPRINTF(RubyQueue, "Enqueue arrival_time: %lld, Message: %s\n",
-            arrival_time, *(message.get()));
+           ((m_msg_queue.size() + m_stall_map_size) <= m_max_size));
 
     // Schedule the wakeup
     assert(m_consumer != NULL);
@@ -307,7 +445,7 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     assert(isReady(current_time));
 
     // get MsgPtr of the message about to be dequeued
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = m_msg_queue.pop();
 
     // get the delay cycles
     message->updateDelayedTicks(current_time);
@@ -316,15 +454,13 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     // record previous size and time so the current buffer size isn't
     // adjusted until schd cycle
     if (m_time_last_time_pop < current_time) {
-        m_size_at_cycle_start = m_prio_heap.size();
+        m_size_at_cycle_start = m_msg_queue.size() + 1;
         m_stalled_at_cycle_start = m_stall_map_size;
         m_time_last_time_pop = current_time;
         m_dequeues_this_cy = 0;
     }
     ++m_dequeues_this_cy;
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
-    m_prio_heap.pop_back();
     if (decrement_messages) {
         // Record how much time is passed since the message was enqueued
         m_stall_time += curTick() - message->getLastEnqueueTime();
@@ -333,6 +469,7 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
         // If the message will be removed from the queue, decrement the
         // number of message in the queue.
         m_buf_msgs--;
+        m_shared_size--;
     }
 
     // if a dequeue callback was requested, call it now
@@ -358,7 +495,8 @@ MessageBuffer::unregisterDequeueCallback()
 void
 MessageBuffer::clear()
 {
-    m_prio_heap.clear();
+    m_shared_size -= m_msg_queue.size();
+    m_msg_queue.clear();
 
     m_msg_counter = 0;
     m_time_last_time_enqueue = 0;
@@ -373,14 +511,12 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
 {
     DPRINTF(RubyQueue, "Recycling.\n");
     assert(isReady(current_time));
-    MsgPtr node = m_prio_heap.front();
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
+    MsgPtr node = m_msg_queue.pop();
 
     Tick future_time = current_time + recycle_latency;
     node->setLastEnqueueTime(future_time);
 
-    m_prio_heap.back() = node;
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
+    m_msg_queue.push(std::move(node));
     m_consumer->scheduleEventAbsolute(future_time);
 }
 
@@ -388,19 +524,16 @@ void
 MessageBuffer::reanalyzeList(std::list<MsgPtr> &lt, Tick schdTick)
 {
     while (!lt.empty()) {
-        MsgPtr m = lt.front();
+        MsgPtr m = std::move(lt.front());
+        lt.pop_front();
         assert(m->getLastEnqueueTime() <= schdTick);
 
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  std::greater<MsgPtr>());
-
-        m_consumer->scheduleEventAbsolute(schdTick);
-
         DPRINTF(RubyQueue, "Requeue arrival_time: %lld, Message: %s\n",
             schdTick, *(m.get()));
 
-        lt.pop_front();
+        m_msg_queue.push(std::move(m));
+
+        m_consumer->scheduleEventAbsolute(schdTick);
     }
 }
 
@@ -408,18 +541,19 @@ void
 MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
 {
     DPRINTF(RubyQueue, "ReanalyzeMessages %#x\n", addr);
-    assert(m_stall_msg_map.count(addr) > 0);
+    auto it = m_stall_msg_map.find(addr);
+    assert(it != m_stall_msg_map.end());
 
     //
     // Put all stalled messages associated with this address back on the
-    // prio heap.  The reanalyzeList call will make sure the consumer is
+    // message queue.  The reanalyzeList call will make sure the consumer is
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle
     //
-    m_stall_map_size -= m_stall_msg_map[addr].size();
+    m_stall_map_size -= it->second.size();
     assert(m_stall_map_size >= 0);
-    reanalyzeList(m_stall_msg_map[addr], current_time);
-    m_stall_msg_map.erase(addr);
+    reanalyzeList(it->second, current_time);
+    m_stall_msg_map.erase(it);
 }
 
 void
@@ -429,7 +563,7 @@ MessageBuffer::reanalyzeAllMessages(Tick current_time)
 
     //
     // Put all stalled messages associated with this address back on the
-    // prio heap.  The reanalyzeList call will make sure the consumer is
+    // message queue.  The reanalyzeList call will make sure the consumer is
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle.
     //
@@ -448,7 +582,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     DPRINTF(RubyQueue, "Stalling due to %#x\n", addr);
     assert(isReady(current_time));
     assert(getOffset(addr) == 0);
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = m_msg_queue.front();
 
     // Since the message will just be moved to stall map, indicate that the
     // buffer should not decrement the m_buf_msgs statistic
@@ -459,7 +593,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     // Instead the controller is responsible to call reanalyzeMessages when
     // these addresses change state.
     //
-    (m_stall_msg_map[addr]).push_back(message);
+    (m_stall_msg_map[addr]).push_back(std::move(message));
     m_stall_map_size++;
     m_stall_count++;
 }
@@ -475,7 +609,7 @@ MessageBuffer::deferEnqueueingMessage(Addr addr, MsgPtr message)
 {
     DPRINTF(RubyQueue, "Deferring enqueueing message: %s, Address %#x\n",
             *(message.get()), addr);
-    (m_deferred_msg_map[addr]).push_back(message);
+    (m_deferred_msg_map[addr]).push_back(std::move(message));
 }
 
 void
@@ -486,8 +620,8 @@ MessageBuffer::enqueueDeferredMessages(Addr addr, Tick curTime, Tick delay)
     assert(msg_vec.size() > 0);
 
     // enqueue all deferred messages associated with this address
-    for (MsgPtr m : msg_vec) {
-        enqueue(m, curTime, delay);
+    for (MsgPtr &m : msg_vec) {
+        enqueue(std::move(m), curTime, delay);
     }
 
     msg_vec.clear();
@@ -508,8 +642,12 @@ MessageBuffer::print(std::ostream& out) const
         ccprintf(out, " consumer-yes ");
     }
 
-    std::vector<MsgPtr> copy(m_prio_heap);
-    std::sort_heap(copy.begin(), copy.end(), std::greater<MsgPtr>());
+    std::vector<MsgPtr> copy;
+    copy.reserve(m_msg_queue.size());
+    m_msg_queue.anyOf([&copy](const MsgPtr &msg) {
+        copy.push_back(msg);
+        return false;
+    });
     ccprintf(out, "%s] %s", copy, name());
 }
 
@@ -520,8 +658,8 @@ MessageBuffer::isReady(Tick current_time) const
     bool can_dequeue = (m_max_dequeue_rate == 0) ||
                        (m_time_last_time_pop < current_time) ||
                        (m_dequeues_this_cy < m_max_dequeue_rate);
-    bool is_ready = (m_prio_heap.size() > 0) &&
-                   (m_prio_heap.front()->getLastEnqueueTime() <= current_time);
+    bool is_ready = !m_msg_queue.empty() &&
+                   (m_msg_queue.front()->getLastEnqueueTime() <= current_time);
     if (!can_dequeue && is_ready) {
         // Make sure the Consumer executes next cycle to dequeue the ready msg
         m_consumer->scheduleEvent(Cycles(1));
@@ -532,10 +670,10 @@ MessageBuffer::isReady(Tick current_time) const
 Tick
 MessageBuffer::readyTime() const
 {
-    if (m_prio_heap.empty())
+    if (m_msg_queue.empty())
         return MaxTick;
     else
-        return m_prio_heap.front()->getLastEnqueueTime();
+        return m_msg_queue.front()->getLastEnqueueTime();
 }
 
 uint32_t
@@ -544,19 +682,33 @@ MessageBuffer::functionalAccess(Packet *pkt, bool is_read, WriteMask *mask)
     DPRINTF(RubyQueue, "functional %s for %#x\n",
             is_read ? "read" : "write", pkt->getAddr());
 
+    // Skip the buffer if none of the messages it holds may refer to
+    // the lines accessed. Nothing can be enqueued while the functional
+    // access is in progress, so the summary can safely be cleared if
+    // the buffer is empty.
+    if (m_shared_size == 0) {
+        m_line_summary = 0;
+        return 0;
+    }
+    if (!(m_line_summary & lineSummaryMask(pkt->getAddr(), pkt->getSize())))
+        return 0;
+
     uint32_t num_functional_accesses = 0;
 
-    // Check the priority heap and write any messages that may
+    // Check the message queue and write any messages that may
     // correspond to the address in the packet.
-    for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
-        Message *msg = m_prio_heap[i].get();
+    bool read_done = m_msg_queue.anyOf([&](const MsgPtr &msg_ptr) {
+        Message *msg = msg_ptr.get();
         if (is_read && !mask && msg->functionalRead(pkt))
-            return 1;
+            return true;
         else if (is_read && mask && msg->functionalRead(pkt, *mask))
             num_functional_accesses++;
         else if (!is_read && msg->functionalWrite(pkt))
             num_functional_accesses++;
-    }
+        return false;
+    });
+    if (read_done)
+        return 1;
 
     // Check the stall queue and write any messages that may
     // correspond to the address in the packet.
@@ -577,6 +729,19 @@ MessageBuffer::functionalAccess(Packet *pkt, bool is_read, WriteMask *mask)
         }
     }
 
+    // Check the messages sent from other event queues that have not
+    // been delivered yet
+    std::lock_guard<std::mutex> lock(m_in_flight_mutex);
+    for (const auto &in_flight : m_in_flight) {
+        Message *msg = in_flight.get();
+        if (is_read && !mask && msg->functionalRead(pkt))
+            return 1;
+        else if (is_read && mask && msg->functionalRead(pkt, *mask))
+            num_functional_accesses++;
+        else if (!is_read && msg->functionalWrite(pkt))
+            num_functional_accesses++;
+    }
+
     return num_functional_accesses;
 }
 
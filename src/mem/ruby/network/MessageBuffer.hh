@@ -47,13 +47,18 @@
 #define __MEM_RUBY_NETWORK_MESSAGEBUFFER_HH__
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "base/random.hh"
 #include "base/trace.hh"
 #include "debug/RubyQueue.hh"
 #include "mem/packet.hh"
@@ -71,6 +76,122 @@ namespace gem5
 namespace ruby
 {
 
+/**
+ * The messages held by a MessageBuffer, ordered by arrival time and
+ * then by enqueue order. There is one bucket of messages per arrival
+ * tick. Messages arriving at a given tick are almost always enqueued
+ * in order, so inserting and removing a message is usually a constant
+ * time operation on its bucket rather than a heap update. Emptied
+ * buckets are kept aside and reused for later ticks.
+ */
+class MessageQueue
+{
+  private:
+    struct Bucket
+    {
+        std::vector<MsgPtr> msgs;
+        //! Position of the oldest message still in the bucket
+        size_t head = 0;
+    };
+    typedef std::map<Tick, Bucket> BucketMap;
+
+    BucketMap buckets;
+    std::vector<BucketMap::node_type> spareBuckets;
+    size_t numMessages = 0;
+
+    //! Bound on the number of emptied buckets kept for reuse
+    static constexpr size_t maxSpareBuckets = 16;
+
+    Bucket &
+    bucketAt(Tick when)
+    {
+        auto it = buckets.lower_bound(when);
+        if (it != buckets.end() && it->first == when)
+            return it->second;
+        if (spareBuckets.empty())
+            return buckets.emplace_hint(it, when, Bucket())->second;
+        BucketMap::node_type node = std::move(spareBuckets.back());
+        spareBuckets.pop_back();
+        node.key() = when;
+        return buckets.insert(it, std::move(node))->second;
+    }
+
+  public:
+    bool empty() const { return numMessages == 0; }
+    size_t size() const { return numMessages; }
+
+    const MsgPtr &
+    front() const
+    {
+        assert(!empty());
+        const Bucket &bucket = buckets.begin()->second;
+        return bucket.msgs[bucket.head];
+    }
+
+    void
+    push(MsgPtr msg)
+    {
+        Bucket &bucket = bucketAt(msg->getLastEnqueueTime());
+        auto &msgs = bucket.msgs;
+        // Only messages put back in the queue, which keep their
+        // original counter, may have to go before others
+        auto pos = msgs.end();
+        auto first = msgs.begin() + bucket.head;
+        while (pos != first &&
+               (*(pos - 1))->getMsgCounter() > msg->getMsgCounter()) {
+            --pos;
+        }
+        msgs.insert(pos, std::move(msg));
+        ++numMessages;
+    }
+
+    MsgPtr
+    pop()
+    {
+        assert(!empty());
+        auto it = buckets.begin();
+        Bucket &bucket = it->second;
+        MsgPtr msg = std::move(bucket.msgs[bucket.head++]);
+        if (bucket.head == bucket.msgs.size()) {
+            bucket.msgs.clear();
+            bucket.head = 0;
+            if (spareBuckets.size() < maxSpareBuckets) {
+                spareBuckets.push_back(buckets.extract(it));
+            } else {
+                buckets.erase(it);
+            }
+        }
+        --numMessages;
+        return msg;
+    }
+
+    void
+    clear()
+    {
+        buckets.clear();
+        numMessages = 0;
+    }
+
+    /**
+     * Apply a predicate to the messages in order, stopping at the first
+     * one it holds for.
+     * @return Whether the predicate held for any message.
+     */
+    template <class Pred>
+    bool
+    anyOf(Pred pred) const
+    {
+        for (const auto &entry : buckets) {
+            const Bucket &bucket = entry.second;
+            for (size_t i = bucket.head; i < bucket.msgs.size(); ++i) {
+                if (pred(bucket.msgs[i]))
+                    return true;
+            }
+        }
+        return false;
+    }
+};
+
 class MessageBuffer : public SimObject
 {
   public:
@@ -92,11 +213,10 @@ class MessageBuffer : public SimObject
     void
     delayHead(Tick current_time, Tick delta)
     {
-        MsgPtr m = m_prio_heap.front();
-        std::pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      std::greater<MsgPtr>());
-        m_prio_heap.pop_back();
-        enqueue(m, current_time, delta);
+        MsgPtr m = m_msg_queue.pop();
+        // the message is counted again when it is enqueued
+        m_shared_size--;
+        enqueue(std::move(m), current_time, delta);
     }
 
     bool areNSlotsAvailable(unsigned int n, Tick curTime);
@@ -121,7 +241,7 @@ class MessageBuffer : public SimObject
     //! message queue.  The function assumes that the queue is nonempty.
     const Message* peek() const;
 
-    const MsgPtr &peekMsgPtr() const { return m_prio_heap.front(); }
+    const MsgPtr &peekMsgPtr() const { return m_msg_queue.front(); }
 
     void enqueue(MsgPtr message, Tick curTime, Tick delta,
                 bool bypassStrictFIFO = false);
@@ -146,7 +266,7 @@ class MessageBuffer : public SimObject
     void unregisterDequeueCallback();
 
     void recycle(Tick current_time, Tick recycle_latency);
-    bool isEmpty() const { return m_prio_heap.size() == 0; }
+    bool isEmpty() const { return m_msg_queue.empty(); }
     bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
     unsigned int getStallMapSize() { return m_stall_msg_map.size(); }
 
@@ -156,6 +276,9 @@ class MessageBuffer : public SimObject
     void print(std::ostream& out) const;
     void clearStats() { m_not_avail_count = 0; m_msg_counter = 0; }
 
+    void resetStats() override;
+    void preDumpStats() override;
+
     void setIncomingLink(int link_id) { m_input_link_id = link_id; }
     void setVnet(int net) { m_vnet_id = net; }
 
@@ -198,29 +321,53 @@ class MessageBuffer : public SimObject
 
     uint32_t functionalAccess(Packet *pkt, bool is_read, WriteMask *mask);
 
+    /**
+     * Is the buffer accessed by a thread simulating a different event
+     * queue than the one of the consumer? This is the case when Ruby
+     * objects are spread over multiple event queues and a message is
+     * sent from one queue to another.
+     */
+    bool
+    isRemoteAccess() const
+    {
+        return inParallelMode && m_consumer &&
+            m_consumer->getObject()->eventQueue() != curEventQueue();
+    }
+
+    //! Give a message its arrival time, insert it in the priority heap
+    //! and wake up the consumer. Called in the consumer's event queue.
+    void insertMessage(MsgPtr message, Tick current_time, Tick delta,
+                       bool bypassStrictFIFO);
+
+    //! Hand a message over to the consumer's event queue, where it is
+    //! inserted at current_time + delta.
+    void enqueueRemote(MsgPtr message, Tick current_time, Tick delta,
+                       bool bypassStrictFIFO);
+
   private:
     // Data Members (m_ prefix)
     //! Consumer to signal a wakeup(), can be NULL
     Consumer* m_consumer;
-    std::vector<MsgPtr> m_prio_heap;
+    MessageQueue m_msg_queue;
 
     std::function<void()> m_dequeue_callback;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map<Addr, std::list<MsgPtr> > StallMsgMapType;
+    // Stalled messages go back to their original place in the message
+    // queue when reanalyzed, so the order in which the addresses are
+    // visited does not matter and a hash map can be used
+    typedef std::unordered_map<Addr, std::list<MsgPtr> > StallMsgMapType;
 
     /**
      * A map from line addresses to lists of stalled messages for that line.
      * If this buffer allows the receiver to stall messages, on a stall
-     * request, the stalled message is removed from the m_prio_heap and placed
+     * request, the stalled message is removed from the m_msg_queue and placed
      * in the m_stall_msg_map. Messages are held there until the receiver
      * requests they be reanalyzed, at which point they are moved back to
-     * m_prio_heap.
+     * m_msg_queue.
      *
      * NOTE: The stall map holds messages in the order in which they were
      * initially received, and when a line is unblocked, the messages are
-     * moved back to the m_prio_heap in the same order. This prevents starving
+     * moved back to the m_msg_queue in the same order. This prevents starving
      * older requests with younger ones.
      */
     StallMsgMapType m_stall_msg_map;
@@ -237,7 +384,7 @@ class MessageBuffer : public SimObject
      * Current size of the stall map.
      * Track the number of messages held in stall map lists. This is used to
      * ensure that if the buffer is finite-sized, it blocks further requests
-     * when the m_prio_heap and m_stall_msg_map contain m_max_size messages.
+     * when the m_msg_queue and m_stall_msg_map contain m_max_size messages.
      */
     int m_stall_map_size;
 
@@ -284,6 +431,43 @@ class MessageBuffer : public SimObject
     int m_input_link_id;
     int m_vnet_id;
 
+    /**
+     * Messages sent from another event queue that have not been
+     * delivered to the consumer's queue yet. They are kept here so
+     * that functional accesses can find them.
+     */
+    std::list<MsgPtr> m_in_flight;
+    std::mutex m_in_flight_mutex;
+
+    /**
+     * Number of messages held by the buffer, including the stalled
+     * and in-flight ones. Senders in other event queues cannot look
+     * at the consumer's view of the buffer, and check for available
+     * slots against this count instead.
+     */
+    std::atomic<unsigned int> m_shared_size;
+
+    /**
+     * Number of times senders in other event queues did not find the
+     * slots they needed. It is added to m_not_avail_count before the
+     * stats are dumped, as the stats belong to the consumer's thread.
+     */
+    std::atomic<uint64_t> m_remote_not_avail_count;
+
+    //! Generator of the random delays in parallel mode, where the
+    //! buffers on different event queues are randomized concurrently
+    Random m_random;
+
+    /**
+     * Summary of the lines the held messages refer to, one bit per line
+     * modulo 64, so that functional accesses can skip the buffers that
+     * hold nothing for the lines accessed. Bits are only set when a
+     * message is enqueued, and the summary is only cleared by a
+     * functional access, with all the event queues locked, once the
+     * buffer is empty.
+     */
+    std::atomic<uint64_t> m_line_summary;
+
     // Count the # of times I didn't have N slots available
     statistics::Scalar m_not_avail_count;
     statistics::Scalar m_msg_count;
@@ -295,6 +479,7 @@ class MessageBuffer : public SimObject
 };
 
 Tick random_time();
+Tick random_time(Random &rng);
 
 inline std::ostream&
 operator<<(std::ostream& out, const MessageBuffer& obj)
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/analytical/AnalyticalNetwork.hh"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/logging.hh"
+#include "debug/RubyNetwork.hh"
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/network/BasicLink.hh"
+#include "mem/ruby/network/BasicRouter.hh"
+#include "mem/ruby/network/MessageBuffer.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+AnalyticalNetwork::AnalyticalNetwork(const Params &p)
+    : Network(p), Consumer(this), m_window(p.utilization_window),
+      m_max_utilization(p.max_utilization), networkStats(this)
+{
+    fatal_if(m_window == 0, "%s: utilization_window must be positive",
+             name());
+    fatal_if(m_max_utilization <= 0 || m_max_utilization >= 1,
+             "%s: max_utilization must be in (0, 1)", name());
+
+    m_router_latency.resize(p.routers.size(), Cycles(0));
+    for (auto *router : p.routers) {
+        auto id = static_cast<size_t>(router->params().router_id);
+        fatal_if(id >= m_router_latency.size(),
+                 "%s: router id %d is out of range", name(), id);
+        m_router_latency[id] = Cycles(router->params().latency);
+    }
+
+    m_in_links.resize(m_nodes, -1);
+    m_routes.resize(p.routers.size() * m_nodes * m_virtual_networks, -1);
+    m_inject_free.resize(m_nodes, 0);
+    m_last_arrival.resize(m_nodes * m_virtual_networks, 0);
+    m_pending.resize(m_nodes * m_virtual_networks, 0);
+    m_queue_active.resize(m_nodes * m_virtual_networks, false);
+}
+
+void
+AnalyticalNetwork::init()
+{
+    Network::init();
+
+    // The topology pointer should have already been initialized in
+    // the parent class network constructor.
+    assert(m_topology_ptr != NULL);
+    m_topology_ptr->createLinks(this);
+
+    for (NodeID node = 0; node < m_nodes; ++node) {
+        fatal_if(m_in_links[node] == -1,
+                 "%s: node %d is not connected to the network", name(),
+                 node);
+    }
+}
+
+int
+AnalyticalNetwork::addLink(BasicLink *link, int dest)
+{
+    fatal_if(link->m_bandwidth_factor <= 0,
+             "%s: link %s needs a positive bandwidth factor", name(),
+             link->name());
+
+    Link l = {};
+    l.latency = link->m_latency;
+    // Same link width as the SimpleNetwork with its default endpoint
+    // bandwidth
+    l.bandwidth = link->m_bandwidth_factor;
+    l.weight = link->m_weight;
+    l.dest = dest;
+    m_links.push_back(l);
+    return m_links.size() - 1;
+}
+
+void
+AnalyticalNetwork::addRoutes(SwitchID src, int link_id,
+                             std::vector<NetDest>& routing_table_entry)
+{
+    // The routing table of a link holds the nodes for which it is on a
+    // shortest path. As in the weight-based routing of the simple
+    // network, the link with the lowest weight is used, and the first
+    // one added among links of equal weight.
+    for (int vnet = 0; vnet < routing_table_entry.size(); ++vnet) {
+        for (NodeID global_node : routing_table_entry[vnet].getAllDest()) {
+            int &next = route(src, getLocalNodeID(global_node), vnet);
+            if (next == -1 ||
+                m_links[link_id].weight < m_links[next].weight) {
+                next = link_id;
+            }
+        }
+    }
+}
+
+// From a switch to an endpoint node
+void
+AnalyticalNetwork::makeExtOutLink(SwitchID src, NodeID global_dest,
+                                  BasicLink* link,
+                                  std::vector<NetDest>& routing_table_entry)
+{
+    int link_id = addLink(link, -1);
+    addRoutes(src, link_id, routing_table_entry);
+}
+
+// From an endpoint node to a switch
+void
+AnalyticalNetwork::makeExtInLink(NodeID global_src, SwitchID dest,
+                                 BasicLink* link,
+                                 std::vector<NetDest>& routing_table_entry)
+{
+    NodeID local_src = getLocalNodeID(global_src);
+    assert(local_src < m_nodes);
+    m_in_links[local_src] = addLink(link, dest);
+
+    for (int vnet = 0; vnet < m_toNetQueues[local_src].size(); ++vnet) {
+        MessageBuffer *buffer = m_toNetQueues[local_src][vnet];
+        if (!buffer)
+            continue;
+        buffer->setConsumer(this);
+        // The queue index is passed back to storeEventInfo when a
+        // message is enqueued
+        buffer->setVnet(local_src * m_virtual_networks + vnet);
+    }
+}
+
+// From a switch to a switch
+void
+AnalyticalNetwork::makeInternalLink(SwitchID src, SwitchID dest,
+                                    BasicLink* link,
+                                    std::vector<NetDest>& routing_table_entry,
+                                    PortDirection src_outport,
+                                    PortDirection dst_inport)
+{
+    int link_id = addLink(link, dest);
+    addRoutes(src, link_id, routing_table_entry);
+}
+
+void
+AnalyticalNetwork::storeEventInfo(int info)
+{
+    m_pending[info]++;
+    if (!m_queue_active[info]) {
+        m_queue_active[info] = true;
+        m_active_queues.push_back(info);
+    }
+}
+
+Cycles
+AnalyticalNetwork::pathLatency(NodeID src, NodeID dest, int vnet, int bytes,
+                               Cycles now)
+{
+    double latency = 0;
+    double queueing = 0;
+    double serialization = 0;
+
+    int link_id = m_in_links[src];
+    while (true) {
+        Link &link = m_links[link_id];
+
+        // Refresh the utilization estimates of the link once its
+        // window has elapsed
+        if (now >= link.windowStart + m_window) {
+            double elapsed = now - link.windowStart;
+            link.utilization = std::min(
+                link.windowBytes / (link.bandwidth * elapsed),
+                m_max_utilization);
+            link.serviceTime = (link.windowMsgs == 0) ? 0 :
+                link.windowBytes / (link.bandwidth * link.windowMsgs);
+            link.windowStart = now;
+            link.windowBytes = 0;
+            link.windowMsgs = 0;
+        }
+        link.windowBytes += bytes;
+        link.windowMsgs++;
+
+        // Mean waiting time of an M/D/1 queue
+        double rho = link.utilization;
+        queueing += rho * link.serviceTime / (2 * (1 - rho));
+
+        latency += link.latency;
+        // The message is pipelined across the links, it is only
+        // serialized once, on the narrowest one
+        serialization = std::max(serialization, bytes / link.bandwidth);
+
+        if (link.dest == -1)
+            break;
+
+        SwitchID sw = link.dest;
+        latency += m_router_latency[sw];
+        link_id = route(sw, dest, vnet);
+        panic_if(link_id == -1, "%s: no route from router %d to node %d "
+                 "on vnet %d", name(), sw, dest, vnet);
+    }
+
+    networkStats.totalQueueingLatency += queueing;
+
+    return Cycles(std::max(1.0, std::ceil(latency + serialization +
+                                          queueing)));
+}
+
+bool
+AnalyticalNetwork::operateQueue(int queue, Tick current_time, Cycles now)
+{
+    NodeID src = queue / m_virtual_networks;
+    int vnet = queue % m_virtual_networks;
+    MessageBuffer *buffer = m_toNetQueues[src][vnet];
+
+    static thread_local std::vector<std::pair<MachineID, NodeID>> dests;
+
+    while (buffer->isReady(current_time)) {
+        // The link to the network is still busy with the previous
+        // message of this node
+        if (m_inject_free[src] > now)
+            return false;
+
+        MsgPtr msg_ptr = buffer->peekMsgPtr();
+        const NetDest &destination = msg_ptr->getDestination();
+
+        dests.clear();
+        if (destination.count() == 1) {
+            MachineID machine = destination.smallestElement();
+            dests.emplace_back(machine, getLocalNodeID(
+                MachineType_base_number(machine.getType()) +
+                machine.getNum()));
+        } else {
+            for (int t = 0; t < MachineType_NUM; ++t) {
+                MachineType type = static_cast<MachineType>(t);
+                for (NodeID i = 0; i < MachineType_base_count(type); ++i) {
+                    MachineID machine = {type, i};
+                    if (destination.isElement(machine)) {
+                        dests.emplace_back(machine, getLocalNodeID(
+                            MachineType_base_number(type) + i));
+                    }
+                }
+            }
+        }
+
+        // Check for resources at all the destinations
+        for (const auto &dest : dests) {
+            if (!m_fromNetQueues[dest.second][vnet]->areNSlotsAvailable(
+                    1, current_time)) {
+                DPRINTF(RubyNetwork, "Can't deliver message since node %d "
+                        "is blocked\n", dest.second);
+                return false;
+            }
+        }
+
+        buffer->dequeue(current_time);
+        m_pending[queue]--;
+
+        int bytes = MessageSizeType_to_int(msg_ptr->getMessageSize());
+        m_inject_free[src] = std::max(m_inject_free[src], double(now)) +
+            bytes / m_links[m_in_links[src]].bandwidth;
+
+        // Each destination gets its own copy of a multicast message
+        MsgPtr unmodified_msg_ptr;
+        if (dests.size() > 1)
+            unmodified_msg_ptr = msg_ptr->clone();
+
+        for (int i = 0; i < dests.size(); ++i) {
+            NodeID dest = dests[i].second;
+            if (i > 0)
+                msg_ptr = unmodified_msg_ptr->clone();
+            if (dests.size() > 1) {
+                NetDest single;
+                single.add(dests[i].first);
+                msg_ptr->getDestination() = single;
+            }
+
+            Cycles latency = pathLatency(src, dest, vnet, bytes, now);
+            Tick arrival = clockEdge(latency);
+            Tick &last_arrival = m_last_arrival[dest * m_virtual_networks +
+                                                vnet];
+            if (isVNetOrdered(vnet))
+                arrival = std::max(arrival, last_arrival);
+            last_arrival = arrival;
+
+            DPRINTF(RubyNetwork, "Node %d to node %d on vnet %d in %d "
+                    "cycles: %s\n", src, dest, vnet,
+                    ticksToCycles(arrival - current_time), *msg_ptr);
+
+            networkStats.msgCount[vnet]++;
+            networkStats.msgBytes += bytes;
+            networkStats.totalLatency += ticksToCycles(arrival -
+                                                       current_time);
+
+            m_fromNetQueues[dest][vnet]->enqueue(msg_ptr, current_time,
+                                                 arrival - current_time);
+        }
+    }
+    return true;
+}
+
+void
+AnalyticalNetwork::wakeup()
+{
+    Tick current_time = clockEdge();
+    Cycles now = curCycle();
+    bool blocked = false;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < m_active_queues.size(); ++i) {
+        int queue = m_active_queues[i];
+        if (!operateQueue(queue, current_time, now))
+            blocked = true;
+        if (m_pending[queue] > 0) {
+            m_active_queues[kept++] = queue;
+        } else {
+            m_queue_active[queue] = false;
+        }
+    }
+    m_active_queues.resize(kept);
+
+    // Retry the messages that could not be sent in the next cycle
+    if (blocked)
+        scheduleEvent(Cycles(1));
+}
+
+void
+AnalyticalNetwork::print(std::ostream& out) const
+{
+    out << "[AnalyticalNetwork]";
+}
+
+AnalyticalNetwork::
+NetworkStats::NetworkStats(statistics::Group *parent)
+    : statistics::Group(parent),
+      ADD_STAT(msgCount, statistics::units::Count::get(),
+               "Number of messages delivered on each vnet"),
+      ADD_STAT(msgBytes, statistics::units::Byte::get(),
+               "Number of bytes delivered"),
+      ADD_STAT(totalLatency, statistics::units::Cycle::get(),
+               "Total latency of the delivered messages"),
+      ADD_STAT(totalQueueingLatency, statistics::units::Cycle::get(),
+               "Total estimated queueing delay of the delivered messages"),
+      ADD_STAT(avgLatency, statistics::units::Rate<
+                   statistics::units::Cycle, statistics::units::Count>::get(),
+               "Average latency of the delivered messages"),
+      ADD_STAT(avgQueueingLatency, statistics::units::Rate<
+                   statistics::units::Cycle, statistics::units::Count>::get(),
+               "Average estimated queueing delay of the delivered messages")
+{
+    msgCount.init(Network::getNumberOfVirtualNetworks());
+
+    avgLatency = totalLatency / sum(msgCount);
+    avgQueueingLatency = totalQueueingLatency / sum(msgCount);
+}
+
+} // namespace ruby
+} // namespace gem5
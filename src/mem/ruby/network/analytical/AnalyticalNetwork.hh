@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_ANALYTICAL_ANALYTICALNETWORK_HH__
+#define __MEM_RUBY_NETWORK_ANALYTICAL_ANALYTICALNETWORK_HH__
+
+#include <iostream>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/network/Network.hh"
+#include "params/AnalyticalNetwork.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+/**
+ * A network that does not simulate the individual hops of a message.
+ * When a message is injected, its latency to each destination is
+ * computed from the path given by the topology: the latency of the
+ * links and routers on the path, the serialization of the message on
+ * the narrowest link, and an M/D/1 estimate of the queueing delay at
+ * each link based on the utilization measured over the last window.
+ * The message is then enqueued directly into the destination buffer.
+ *
+ * The injection rate of each node is bounded by the bandwidth of its
+ * link to the network, which keeps the bandwidth at saturation
+ * roughly right, and the arrival order of ordered vnets is preserved.
+ */
+class AnalyticalNetwork : public Network, public Consumer
+{
+  public:
+    PARAMS(AnalyticalNetwork);
+
+    AnalyticalNetwork(const Params &p);
+    ~AnalyticalNetwork() = default;
+
+    void init() override;
+
+    void wakeup() override;
+    void storeEventInfo(int info) override;
+
+    bool isVNetOrdered(int vnet) const { return m_ordered[vnet]; }
+
+    // Methods used by Topology to setup the network
+    void makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
+                     std::vector<NetDest>& routing_table_entry) override;
+    void makeExtInLink(NodeID src, SwitchID dest, BasicLink* link,
+                    std::vector<NetDest>& routing_table_entry) override;
+    void makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
+                          std::vector<NetDest>& routing_table_entry,
+                          PortDirection src_outport,
+                          PortDirection dst_inport) override;
+
+    void collateStats() override {}
+    void print(std::ostream& out) const override;
+
+    // Messages are never held by the network, they are either in the
+    // buffers of the source or of the destination controller
+    bool functionalRead(Packet *pkt) override { return false; }
+    bool
+    functionalRead(Packet *pkt, WriteMask &mask) override
+    {
+        return false;
+    }
+    uint32_t functionalWrite(Packet *pkt) override { return 0; }
+
+  private:
+    struct Link
+    {
+        Cycles latency;
+        //! Bandwidth in bytes per cycle
+        double bandwidth;
+        int weight;
+        //! Router at the end of the link, -1 for links to a node
+        int dest;
+
+        //! Traffic seen since the start of the current window
+        Cycles windowStart;
+        double windowBytes;
+        uint64_t windowMsgs;
+
+        //! Estimates computed at the end of the last window
+        double utilization;
+        double serviceTime;
+    };
+
+    int addLink(BasicLink *link, int dest);
+    void addRoutes(SwitchID src, int link_id,
+                   std::vector<NetDest>& routing_table_entry);
+
+    int &
+    route(SwitchID sw, NodeID node, int vnet)
+    {
+        return m_routes[(sw * m_nodes + node) * m_virtual_networks + vnet];
+    }
+
+    /**
+     * Compute the latency of a message sent between two nodes, and
+     * account for the message in the utilization of the links on its
+     * path.
+     */
+    Cycles pathLatency(NodeID src, NodeID dest, int vnet, int bytes,
+                       Cycles now);
+
+    /** Send the ready messages of a node on a vnet. */
+    bool operateQueue(int queue, Tick current_time, Cycles now);
+
+    const Cycles m_window;
+    const double m_max_utilization;
+
+    std::vector<Link> m_links;
+
+    //! Latency of each router
+    std::vector<Cycles> m_router_latency;
+
+    //! Link from each node to the network
+    std::vector<int> m_in_links;
+
+    //! Next link to take from a router to reach a node on a vnet
+    std::vector<int> m_routes;
+
+    //! Cycle at which each node can inject its next message
+    std::vector<double> m_inject_free;
+
+    //! Last arrival time at each node on each vnet, to keep the
+    //! messages of ordered vnets in order
+    std::vector<Tick> m_last_arrival;
+
+    //! Number of messages waiting in each injection queue, and the
+    //! queues that have messages waiting
+    std::vector<int> m_pending;
+    std::vector<bool> m_queue_active;
+    std::vector<int> m_active_queues;
+
+    struct NetworkStats : public statistics::Group
+    {
+        NetworkStats(statistics::Group *parent);
+
+        statistics::Vector msgCount;
+        statistics::Scalar msgBytes;
+        statistics::Scalar totalLatency;
+        statistics::Scalar totalQueueingLatency;
+        statistics::Formula avgLatency;
+        statistics::Formula avgQueueingLatency;
+    } networkStats;
+};
+
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_ANALYTICAL_ANALYTICALNETWORK_HH__
@@ -64,6 +64,18 @@ class Credit : public flit
 
     ~Credit() {};
 
+    static void *
+    operator new(size_t size)
+    {
+        return MessagePool<Credit>::allocate(size);
+    }
+
+    static void
+    operator delete(void *ptr, size_t size)
+    {
+        MessagePool<Credit>::release(ptr, size);
+    }
+
     bool is_free_signal() { return m_is_free_signal; }
 
   private:
@@ -63,8 +63,12 @@ class CrossbarSwitch : public Consumer
     update_sw_winner(int inport, flit *t_flit)
     {
         switchBuffers[inport].insert(t_flit);
+        m_num_flits++;
     }
 
+    //! Whether any flit is waiting to traverse the switch
+    bool has_flits() const { return m_num_flits > 0; }
+
     inline double get_crossbar_activity() { return m_crossbar_activity; }
 
     bool functionalRead(Packet *pkt, WriteMask &mask);
@@ -76,6 +80,7 @@ class CrossbarSwitch : public Consumer
     int m_num_vcs;
     double m_crossbar_activity;
     std::vector<flitBuffer> switchBuffers;
+    int m_num_flits;
 };
 
 } // namespace garnet
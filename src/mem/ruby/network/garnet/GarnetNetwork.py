@@ -52,6 +52,11 @@ class GarnetNetwork(RubyNetwork):
     garnet_deadlock_threshold = Param.UInt32(
         50000, "network-level deadlock threshold"
     )
+    router_bypass = Param.Bool(
+        False,
+        "let flits arriving at an otherwise empty router skip the "
+        "router pipeline when their output is free",
+    )
 
 
 class GarnetNetworkInterface(ClockedObject):
@@ -84,6 +89,9 @@ class GarnetRouter(BasicRouter):
     width = Param.UInt32(
         Parent.ni_flit_size, "bit width supported by the router"
     )
+    bypass = Param.Bool(
+        Parent.router_bypass, "enable the single-cycle router bypass"
+    )
 
 
 add_citation(
@@ -46,7 +46,8 @@ namespace garnet
 
 InputUnit::InputUnit(int id, PortDirection direction, Router *router)
   : Consumer(router), m_router(router), m_id(id), m_direction(direction),
-    m_vc_per_vnet(m_router->get_vc_per_vnet())
+    m_vc_per_vnet(m_router->get_vc_per_vnet()), m_num_buffered_flits(0),
+    m_arrival_vc(-1), m_arrival_time(MaxTick), m_num_bypasses(0)
 {
     const int m_num_vcs = m_router->get_num_vcs();
     m_num_buffer_reads.resize(m_num_vcs/m_vc_per_vnet);
@@ -109,6 +110,9 @@ InputUnit::wakeup()
 
         // Buffer the flit
         virtualChannels[vc].insertFlit(t_flit);
+        m_num_buffered_flits++;
+        m_arrival_vc = vc;
+        m_arrival_time = curTick();
 
         int vnet = vc/m_vc_per_vnet;
         // number of writes same as reads
@@ -139,6 +143,15 @@ InputUnit::wakeup()
     }
 }
 
+void
+InputUnit::bypass_pipeline()
+{
+    assert(get_arrival_vc() != -1);
+    flit *t_flit = virtualChannels[m_arrival_vc].peekTopFlit();
+    t_flit->advance_stage(SA_, curTick());
+    m_num_bypasses++;
+}
+
 // Send a credit back to upstream router for this VC.
 // Called by SwitchAllocator when the flit in this VC wins the Switch.
 void
@@ -181,6 +194,7 @@ InputUnit::resetStats()
         m_num_buffer_reads[j] = 0;
         m_num_buffer_writes[j] = 0;
     }
+    m_num_bypasses = 0;
 }
 
 } // namespace garnet
@@ -116,9 +116,24 @@ class InputUnit : public Consumer
     inline flit*
     getTopFlit(int vc)
     {
+        assert(m_num_buffered_flits > 0);
+        m_num_buffered_flits--;
         return virtualChannels[vc].getTopFlit();
     }
 
+    //! Number of flits held in the input VCs
+    inline int get_num_buffered_flits() const { return m_num_buffered_flits; }
+
+    //! VC of the flit received in the current cycle, -1 if none
+    inline int
+    get_arrival_vc() const
+    {
+        return m_arrival_time == curTick() ? m_arrival_vc : -1;
+    }
+
+    //! Let the flit received in the current cycle go for SA right away
+    void bypass_pipeline();
+
     inline bool
     need_stage(int vc, flit_stage stage, Tick time)
     {
@@ -151,6 +166,7 @@ class InputUnit : public Consumer
     { return m_num_buffer_reads[vnet]; }
     double get_buf_write_activity(unsigned int vnet) const
     { return m_num_buffer_writes[vnet]; }
+    double get_bypass_activity() const { return m_num_bypasses; }
 
     bool functionalRead(Packet *pkt, WriteMask &mask);
     uint32_t functionalWrite(Packet *pkt);
@@ -168,10 +184,14 @@ class InputUnit : public Consumer
 
     // Input Virtual channels
     std::vector<VirtualChannel> virtualChannels;
+    int m_num_buffered_flits;
+    int m_arrival_vc;
+    Tick m_arrival_time;
 
     // Statistical variables
     std::vector<double> m_num_buffer_writes;
     std::vector<double> m_num_buffer_reads;
+    double m_num_bypasses;
 };
 
 } // namespace garnet
@@ -49,7 +49,7 @@ namespace garnet
 {
 
 Router::Router(const Params &p)
-  : BasicRouter(p), Consumer(this), m_latency(p.latency),
+  : BasicRouter(p), Consumer(this), m_latency(p.latency), m_bypass(p.bypass),
     m_virtual_networks(p.virt_nets), m_vc_per_vnet(p.vcs_per_vnet),
     m_num_vcs(m_virtual_networks * m_vc_per_vnet), m_bit_width(p.width),
     m_network_ptr(nullptr), routingUnit(this), switchAllocator(this),
@@ -79,6 +79,11 @@ Router::wakeup()
         m_input_unit[inport]->wakeup();
     }
 
+    // The bypass is only decided once every input unit has received
+    // its flit of the cycle
+    if (m_bypass && m_latency > 1)
+        try_bypass();
+
     // check for incoming credits
     // Note: the credit update is happening before SA
     // buffer turnaround time =
@@ -89,11 +94,68 @@ Router::wakeup()
         m_output_unit[outport]->wakeup();
     }
 
+    // Routers are woken up for credits alone, skip the switch stages
+    // when there is no flit to move
+    bool has_flits = false;
+    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+        if (m_input_unit[inport]->get_num_buffered_flits() > 0) {
+            has_flits = true;
+            break;
+        }
+    }
+
     // Switch Allocation
-    switchAllocator.wakeup();
+    if (has_flits)
+        switchAllocator.wakeup();
 
     // Switch Traversal
-    crossbarSwitch.wakeup();
+    if (crossbarSwitch.has_flits())
+        crossbarSwitch.wakeup();
+}
+
+/*
+ * A flit that arrives at a router holding no other flit can skip the
+ * buffering stages and go through switch allocation and traversal in
+ * the cycle it arrives, provided its output can accept it: a free VC
+ * at the output port for a HEAD/HEAD_TAIL flit, or a credit in the
+ * output VC otherwise. No other flit competes with it for the switch,
+ * and the flits arriving in later cycles would reach SA after it
+ * anyway, so the bypass only shortens the latency of the flit through
+ * this router. It does change the timing of the downstream routers,
+ * and hence what they arbitrate between.
+ */
+void
+Router::try_bypass()
+{
+    // The arriving flit must be the only one held by the router
+    int inport = -1;
+    for (int i = 0; i < m_input_unit.size(); i++) {
+        const int num_flits = m_input_unit[i]->get_num_buffered_flits();
+        if (num_flits == 0)
+            continue;
+        if (num_flits > 1 || inport != -1)
+            return;
+        inport = i;
+    }
+    if (inport == -1 || crossbarSwitch.has_flits())
+        return;
+
+    InputUnit *input_unit = m_input_unit[inport].get();
+    const int invc = input_unit->get_arrival_vc();
+    if (invc == -1)
+        return;
+
+    OutputUnit *output_unit =
+        m_output_unit[input_unit->get_outport(invc)].get();
+    const int outvc = input_unit->get_outvc(invc);
+    if (outvc == -1) {
+        if (!output_unit->has_free_vc(invc / m_vc_per_vnet))
+            return;
+    } else if (!output_unit->has_credit(outvc)) {
+        return;
+    }
+
+    input_unit->bypass_pipeline();
 }
 
 void
@@ -216,6 +278,11 @@ Router::regStats()
         .name(name() + ".sw_output_arbiter_activity")
         .flags(statistics::nozero)
     ;
+
+    m_bypass_activity
+        .name(name() + ".bypass_activity")
+        .flags(statistics::nozero)
+    ;
 }
 
 void
@@ -228,6 +295,10 @@ Router::collateStats()
         }
     }
 
+    for (int i = 0; i < m_input_unit.size(); i++) {
+        m_bypass_activity += m_input_unit[i]->get_bypass_activity();
+    }
+
     m_sw_input_arbiter_activity = switchAllocator.get_input_arbiter_activity();
     m_sw_output_arbiter_activity =
         switchAllocator.get_output_arbiter_activity();
@@ -143,7 +143,10 @@ class Router : public BasicRouter, public Consumer
     uint32_t functionalWrite(Packet *);
 
   private:
+    void try_bypass();
+
     Cycles m_latency;
+    bool m_bypass;
     uint32_t m_virtual_networks, m_vc_per_vnet, m_num_vcs;
     uint32_t m_bit_width;
     GarnetNetwork *m_network_ptr;
@@ -163,6 +166,8 @@ class Router : public BasicRouter, public Consumer
     statistics::Scalar m_sw_output_arbiter_activity;
 
     statistics::Scalar m_crossbar_activity;
+
+    statistics::Scalar m_bypass_activity;
 };
 
 } // namespace garnet
@@ -56,6 +56,20 @@ class flit
 
     virtual ~flit(){};
 
+    // Flits are created and destroyed at every hop and by every
+    // network interface, so they are recycled through a pool
+    static void *
+    operator new(size_t size)
+    {
+        return MessagePool<flit>::allocate(size);
+    }
+
+    static void
+    operator delete(void *ptr, size_t size)
+    {
+        MessagePool<flit>::release(ptr, size);
+    }
+
     int get_outport() {return m_outport; }
     int get_size() { return m_size; }
     Tick get_enqueue_time() { return m_enqueue_time; }
@@ -55,6 +55,7 @@
 #include "config/build_gpu.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/profiler/AddressProfiler.hh"
+#include "mem/ruby/profiler/TransitionProfiler.hh"
 #include "mem/ruby/protocol/MachineType.hh"
 #include "mem/ruby/protocol/RubyRequest.hh"
 
@@ -77,6 +78,7 @@
 #endif
 
 #include "mem/ruby/system/Sequencer.hh"
+#include "sim/core.hh"
 
 namespace gem5
 {
@@ -101,6 +103,14 @@ Profiler::Profiler(const RubySystemParams &p, RubySystem *rs)
         m_inst_profiler_ptr->setHotLines(m_hot_lines);
         m_inst_profiler_ptr->setAllInstructions(m_all_instructions);
     }
+
+    if (p.transition_sample_period != 0) {
+        m_transition_profiler = std::make_unique<TransitionProfiler>(
+            rs->name(), p.transition_sample_period,
+            p.transition_sample_entries, p.transition_region_bits,
+            p.transition_profile_binary);
+        registerExitCallback([this]() { m_transition_profiler->dump(); });
+    }
 }
 
 Profiler::~Profiler()
@@ -67,6 +67,7 @@ namespace ruby
 
 class RubyRequest;
 class AddressProfiler;
+class TransitionProfiler;
 
 class Profiler
 {
@@ -82,6 +83,11 @@ class Profiler
 
     AddressProfiler* getAddressProfiler() { return m_address_profiler_ptr; }
     AddressProfiler* getInstructionProfiler() { return m_inst_profiler_ptr; }
+    TransitionProfiler *
+    getTransitionProfiler()
+    {
+        return m_transition_profiler.get();
+    }
 
     void addAddressTraceSample(const RubyRequest& msg, NodeID id);
 
@@ -96,6 +102,7 @@ class Profiler
 
     AddressProfiler* m_address_profiler_ptr;
     AddressProfiler* m_inst_profiler_ptr;
+    std::unique_ptr<TransitionProfiler> m_transition_profiler;
 
     struct ProfilerStats : public statistics::Group
     {
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/profiler/TransitionProfiler.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "mem/ruby/protocol/TransitionResult.hh"
+#include "sim/cur_tick.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace
+{
+
+const char transitionProfileMagic[8] =
+    {'R', 'U', 'B', 'Y', 'T', 'R', 'N', '1'};
+
+//! Number of regions listed in the JSON profiles
+const size_t numHotRegions = 64;
+
+void
+writeString(std::ostream &out, const std::string &str)
+{
+    uint32_t len = str.size();
+    out.write((const char *)&len, sizeof(len));
+    out.write(str.data(), len);
+}
+
+void
+writeJsonNames(std::ostream &out, const std::vector<std::string> &names)
+{
+    out << "[";
+    for (size_t i = 0; i < names.size(); ++i)
+        out << (i ? ", \"" : "\"") << names[i] << "\"";
+    out << "]";
+}
+
+} // anonymous namespace
+
+TransitionSampler::TransitionSampler(TransitionProfiler &profiler,
+                                     uint16_t cntrl,
+                                     unsigned sample_period,
+                                     unsigned num_entries)
+    : m_profiler(profiler), m_cntrl(cntrl),
+      m_sample_period(sample_period),
+      m_rng(0x9e3779b97f4a7c15ULL * (cntrl + 1)),
+      m_samples(num_entries)
+{
+    fatal_if(num_entries == 0, "The transition profiler needs to keep at "
+             "least one sample per controller\n");
+    m_countdown = nextCountdown();
+}
+
+unsigned
+TransitionSampler::nextCountdown()
+{
+    if (m_sample_period <= 1)
+        return 1;
+
+    // Draw the distance to the next sample uniformly around the sample
+    // period, with a generator private to the controller so that the
+    // controllers can be simulated in parallel
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 7;
+    m_rng ^= m_rng << 17;
+    return m_sample_period / 2 + 1 + m_rng % m_sample_period;
+}
+
+void
+TransitionSampler::setMessage(Tick time, const MachineID *requestor)
+{
+    m_msg_latency = curTick() > time ? curTick() - time : 0;
+    // the default MachineID has the type MachineType_NUM
+    m_msg_requestor = requestor ? *requestor : MachineID();
+}
+
+void
+TransitionSampler::record(int state, int event, Addr addr, int result)
+{
+    TransitionSample &sample = m_samples[m_num_sampled % m_samples.size()];
+    m_num_sampled++;
+
+    sample.tick = curTick();
+    sample.region = m_profiler.region(addr);
+    sample.latency = m_msg_latency;
+    sample.cntrl = m_cntrl;
+    sample.state = state;
+    sample.event = event;
+    sample.requestorType = m_msg_requestor.getType();
+    sample.requestorNum = m_msg_requestor.getNum();
+    sample.result = result;
+    memset(sample.pad, 0, sizeof(sample.pad));
+
+    TransitionStats &stats = m_transitions[(uint32_t)state << 16 | event];
+    stats.count[result]++;
+    stats.latency.add(m_msg_latency);
+
+    RegionStats &region = m_regions[sample.region];
+    region.transitions++;
+    if (result == TransitionResult_ResourceStall ||
+        result == TransitionResult_ProtocolStall) {
+        region.stalls++;
+    }
+
+    // The next transition may not be triggered by a message
+    m_msg_latency = 0;
+    m_msg_requestor = MachineID();
+}
+
+TransitionProfiler::TransitionProfiler(const std::string &name,
+                                       unsigned sample_period,
+                                       unsigned num_entries,
+                                       unsigned region_bits, bool binary)
+    : m_name(name), m_sample_period(sample_period),
+      m_num_entries(num_entries), m_region_bits(region_bits),
+      m_binary(binary)
+{
+    fatal_if(region_bits >= 64, "%s: Invalid transition region size\n",
+             name);
+}
+
+TransitionSampler *
+TransitionProfiler::registerController(const std::string &name,
+                                       MachineID id,
+                                       const std::vector<std::string> &states,
+                                       const std::vector<std::string> &events)
+{
+    fatal_if(m_cntrls.size() >= UINT16_MAX,
+             "%s: Too many controllers to profile\n", m_name);
+
+    ControllerInfo info;
+    info.name = name;
+    info.id = id;
+    info.states = states;
+    info.events = events;
+    info.sampler = std::make_unique<TransitionSampler>(
+        *this, m_cntrls.size(), m_sample_period, m_num_entries);
+    m_cntrls.push_back(std::move(info));
+    return m_cntrls.back().sampler.get();
+}
+
+void
+TransitionProfiler::dump() const
+{
+    const std::string file = m_name +
+        (m_binary ? ".transitions.bin" : ".transitions.json");
+    OutputStream *os = simout.create(file, m_binary);
+    if (m_binary)
+        dumpBinary(*os->stream());
+    else
+        dumpJson(*os->stream());
+    simout.close(os);
+}
+
+void
+TransitionProfiler::dumpBinary(std::ostream &out) const
+{
+    // The header and the names of the controllers, states and events are
+    // followed by the samples of each controller, oldest first
+    out.write(transitionProfileMagic, sizeof(transitionProfileMagic));
+    uint32_t values[] = {
+        (uint32_t)sizeof(TransitionSample), m_sample_period, m_region_bits,
+        (uint32_t)m_cntrls.size()
+    };
+    out.write((const char *)values, sizeof(values));
+
+    for (const auto &cntrl : m_cntrls) {
+        writeString(out, cntrl.name);
+        uint32_t num_names[] = {
+            (uint32_t)cntrl.states.size(), (uint32_t)cntrl.events.size()
+        };
+        out.write((const char *)num_names, sizeof(num_names));
+        for (const auto &state : cntrl.states)
+            writeString(out, state);
+        for (const auto &event : cntrl.events)
+            writeString(out, event);
+    }
+
+    for (const auto &cntrl : m_cntrls) {
+        const TransitionSampler &sampler = *cntrl.sampler;
+        const uint64_t size = sampler.m_samples.size();
+        const uint64_t num = std::min(sampler.m_num_sampled, size);
+        const uint64_t counts[] = { sampler.m_num_sampled, num };
+        out.write((const char *)counts, sizeof(counts));
+        for (uint64_t i = sampler.m_num_sampled - num;
+             i < sampler.m_num_sampled; ++i) {
+            out.write((const char *)&sampler.m_samples[i % size],
+                      sizeof(TransitionSample));
+        }
+    }
+}
+
+void
+TransitionProfiler::dumpJson(std::ostream &out) const
+{
+    static const char *results[] = {
+        "valid", "resource_stall", "protocol_stall", "reject"
+    };
+
+    out << "{\n  \"sample_period\": " << m_sample_period
+        << ",\n  \"region_bits\": " << m_region_bits
+        << ",\n  \"sample_fields\": [\"tick\", \"region\", \"latency\", "
+           "\"state\", \"event\", \"result\", \"requestor\"]"
+        << ",\n  \"controllers\": [";
+
+    for (size_t c = 0; c < m_cntrls.size(); ++c) {
+        const ControllerInfo &cntrl = m_cntrls[c];
+        const TransitionSampler &sampler = *cntrl.sampler;
+
+        out << (c ? ",\n" : "\n") << "    {\n"
+            << "      \"name\": \"" << cntrl.name << "\",\n"
+            << "      \"sampled\": " << sampler.m_num_sampled << ",\n"
+            << "      \"states\": ";
+        writeJsonNames(out, cntrl.states);
+        out << ",\n      \"events\": ";
+        writeJsonNames(out, cntrl.events);
+
+        // Transitions, most stalled first
+        std::vector<std::pair<uint32_t,
+            const TransitionSampler::TransitionStats *>> transitions;
+        for (const auto &t : sampler.m_transitions)
+            transitions.emplace_back(t.first, &t.second);
+        std::sort(transitions.begin(), transitions.end(),
+            [](const auto &a, const auto &b) {
+                uint64_t sa = a.second->count[1] + a.second->count[2];
+                uint64_t sb = b.second->count[1] + b.second->count[2];
+                return sa != sb ? sa > sb : a.first < b.first;
+            });
+
+        out << ",\n      \"transitions\": [";
+        for (size_t i = 0; i < transitions.size(); ++i) {
+            const uint32_t key = transitions[i].first;
+            const auto &stats = *transitions[i].second;
+            out << (i ? ",\n" : "\n")
+                << "        {\"state\": \"" << cntrl.states.at(key >> 16)
+                << "\", \"event\": \"" << cntrl.events.at(key & 0xffff)
+                << "\"";
+            for (int r = 0; r < 4; ++r)
+                out << ", \"" << results[r] << "\": " << stats.count[r];
+            const Histogram &hist = stats.latency;
+            out << ", \"latency\": {\"total\": " << hist.getTotal()
+                << ", \"max\": " << hist.getMax()
+                << ", \"bin_size\": " << hist.getBinSize()
+                << ", \"bins\": [";
+            for (uint32_t b = 0; b < hist.getBins(); ++b)
+                out << (b ? ", " : "") << hist.getData(b);
+            out << "]}}";
+        }
+        out << "\n      ]";
+
+        // Regions with the most stalls
+        std::vector<std::pair<Addr,
+            const TransitionSampler::RegionStats *>> regions;
+        for (const auto &r : sampler.m_regions)
+            regions.emplace_back(r.first, &r.second);
+        const size_t num_regions = std::min(regions.size(), numHotRegions);
+        std::partial_sort(regions.begin(), regions.begin() + num_regions,
+            regions.end(),
+            [](const auto &a, const auto &b) {
+                if (a.second->stalls != b.second->stalls)
+                    return a.second->stalls > b.second->stalls;
+                if (a.second->transitions != b.second->transitions)
+                    return a.second->transitions > b.second->transitions;
+                return a.first < b.first;
+            });
+
+        out << ",\n      \"hot_regions\": [";
+        for (size_t i = 0; i < num_regions; ++i) {
+            out << (i ? ",\n" : "\n") << "        {\"addr\": "
+                << (regions[i].first << m_region_bits)
+                << ", \"transitions\": " << regions[i].second->transitions
+                << ", \"stalls\": " << regions[i].second->stalls << "}";
+        }
+        out << "\n      ],\n      \"samples\": [";
+
+        // Most recent samples, oldest first
+        const uint64_t size = sampler.m_samples.size();
+        const uint64_t num = std::min(sampler.m_num_sampled, size);
+        for (uint64_t i = sampler.m_num_sampled - num;
+             i < sampler.m_num_sampled; ++i) {
+            const TransitionSample &s = sampler.m_samples[i % size];
+            out << (i + num == sampler.m_num_sampled ? "\n" : ",\n")
+                << "        [" << s.tick << ", " << s.region << ", "
+                << s.latency << ", " << s.state << ", " << s.event << ", "
+                << (int)s.result << ", ";
+            if (s.requestorType < MachineType_NUM) {
+                out << "\"" << MachineIDToString(
+                    {(MachineType)s.requestorType, s.requestorNum}) << "\"";
+            } else {
+                out << "null";
+            }
+            out << "]";
+        }
+        out << "\n      ]\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace ruby
+} // namespace gem5
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_PROFILER_TRANSITIONPROFILER_HH__
+#define __MEM_RUBY_PROFILER_TRANSITIONPROFILER_HH__
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/Histogram.hh"
+#include "mem/ruby/common/MachineID.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+/**
+ * A sampled SLICC transition, as written to the binary transition
+ * profiles. The latency is the time since the message that triggered
+ * the transition was created, so it grows with every stall and recycle
+ * of the message. The requestor is MachineType_NUM when the message
+ * does not carry one.
+ */
+struct TransitionSample
+{
+    Tick tick;
+    Addr region;
+    Tick latency;
+    uint16_t cntrl;
+    uint16_t state;
+    uint16_t event;
+    uint16_t requestorType;
+    uint16_t requestorNum;
+    uint8_t result;
+    uint8_t pad[5];
+};
+
+class TransitionProfiler;
+
+/**
+ * Samples the transitions of a controller. About one out of sample
+ * period transitions is recorded, with a random jitter so that the
+ * sampling does not alias with periodic protocol behavior. The samples
+ * are kept in a ring buffer holding the most recent ones, while the
+ * per-transition latency histograms and the per-region counts cover
+ * all the sampled transitions.
+ */
+class TransitionSampler
+{
+  public:
+    TransitionSampler(TransitionProfiler &profiler, uint16_t cntrl,
+                      unsigned sample_period, unsigned num_entries);
+
+    /** Should the current transition be recorded? */
+    bool
+    sample()
+    {
+        if (--m_countdown != 0)
+            return false;
+        m_countdown = nextCountdown();
+        return true;
+    }
+
+    /**
+     * Note the message triggering the transition about to be recorded.
+     * This must be done before the transition, whose actions may pop
+     * the message.
+     *
+     * @param time Creation time of the message
+     * @param requestor Requestor of the message, or null
+     */
+    void setMessage(Tick time, const MachineID *requestor);
+
+    /**
+     * Record a transition, along with the message noted before it, if
+     * any.
+     *
+     * @param result TransitionResult of the transition
+     */
+    void record(int state, int event, Addr addr, int result);
+
+  private:
+    friend class TransitionProfiler;
+
+    struct TransitionStats
+    {
+        TransitionStats() : latency(1, 32) {}
+        uint64_t count[4] = {0, 0, 0, 0};
+        Histogram latency;
+    };
+
+    struct RegionStats
+    {
+        uint64_t transitions = 0;
+        uint64_t stalls = 0;
+    };
+
+    unsigned nextCountdown();
+
+    TransitionProfiler &m_profiler;
+    const uint16_t m_cntrl;
+    const unsigned m_sample_period;
+    unsigned m_countdown;
+    uint64_t m_rng;
+
+    //! Latency and requestor of the message triggering the transition
+    //! being sampled
+    Tick m_msg_latency = 0;
+    MachineID m_msg_requestor;
+
+    //! Ring buffer of the most recent samples
+    std::vector<TransitionSample> m_samples;
+    uint64_t m_num_sampled = 0;
+
+    //! Statistics of each (state, event) pair that was sampled
+    std::unordered_map<uint32_t, TransitionStats> m_transitions;
+    //! Statistics of each address region that was sampled
+    std::unordered_map<Addr, RegionStats> m_regions;
+};
+
+/**
+ * Opt-in sampling profiler of the SLICC transitions of the controllers
+ * of a Ruby system. Unlike the AddressProfiler it only does work for
+ * the sampled transitions, so it can be left on for whole runs. The
+ * profile is written to the output directory at exit, either as JSON or
+ * in a compact binary format.
+ */
+class TransitionProfiler
+{
+  public:
+    TransitionProfiler(const std::string &name, unsigned sample_period,
+                       unsigned num_entries, unsigned region_bits,
+                       bool binary);
+
+    /**
+     * Create the sampler of a controller. The names of the states and
+     * events of the controller are used to label the profile.
+     */
+    TransitionSampler *
+    registerController(const std::string &name, MachineID id,
+                       const std::vector<std::string> &states,
+                       const std::vector<std::string> &events);
+
+    Addr region(Addr addr) const { return addr >> m_region_bits; }
+
+    /** Write the profile to the output directory. */
+    void dump() const;
+
+  private:
+    struct ControllerInfo
+    {
+        std::string name;
+        MachineID id;
+        std::vector<std::string> states;
+        std::vector<std::string> events;
+        std::unique_ptr<TransitionSampler> sampler;
+    };
+
+    void dumpJson(std::ostream &out) const;
+    void dumpBinary(std::ostream &out) const;
+
+    const std::string m_name;
+    const unsigned m_sample_period;
+    const unsigned m_num_entries;
+    const unsigned m_region_bits;
+    const bool m_binary;
+
+    std::vector<ControllerInfo> m_cntrls;
+};
+
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_PROFILER_TRANSITIONPROFILER_HH__
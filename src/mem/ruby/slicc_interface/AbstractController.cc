@@ -142,18 +142,36 @@ AbstractController::profileMsgDelay(uint32_t virtualNetwork, Cycles delay)
     stats.delayVCHistogram[virtualNetwork]->sample(delay);
 }
 
+void
+AbstractController::profileTransitionMessage()
+{
+    if (m_cur_in_buf && !m_cur_in_buf->isEmpty()) {
+        const Message *msg = m_cur_in_buf->peek();
+        MachineID requestor;
+        const bool has_requestor = msg->getRequestorMachine(requestor);
+        m_transition_sampler->setMessage(
+            msg->getTime(), has_requestor ? &requestor : nullptr);
+    }
+}
+
+void
+AbstractController::profileTransition(int state, int event, Addr addr,
+                                      int result)
+{
+    m_transition_sampler->record(state, event, addr, result);
+}
+
 void
 AbstractController::stallBuffer(MessageBuffer* buf, Addr addr)
 {
-    if (m_waiting_buffers.count(addr) == 0) {
-        MsgVecType* msgVec = new MsgVecType;
-        msgVec->resize(m_in_ports, NULL);
-        m_waiting_buffers[addr] = msgVec;
+    MsgVecType &msgVec = m_waiting_buffers[addr];
+    if (msgVec.empty()) {
+        msgVec.resize(m_in_ports, NULL);
     }
     DPRINTF(RubyQueue, "stalling %s port %d addr %#x\n", buf, m_cur_in_port,
             addr);
     assert(m_in_ports > m_cur_in_port);
-    (*(m_waiting_buffers[addr]))[m_cur_in_port] = buf;
+    msgVec[m_cur_in_port] = buf;
 }
 
 void
@@ -162,17 +180,16 @@ AbstractController::wakeUpBuffer(MessageBuffer* buf, Addr addr)
     auto iter = m_waiting_buffers.find(addr);
     if (iter != m_waiting_buffers.end()) {
         bool has_other_msgs = false;
-        MsgVecType* msgVec = iter->second;
-        for (unsigned int port = 0; port < msgVec->size(); ++port) {
-            if ((*msgVec)[port] == buf) {
+        MsgVecType &msgVec = iter->second;
+        for (unsigned int port = 0; port < msgVec.size(); ++port) {
+            if (msgVec[port] == buf) {
                 buf->reanalyzeMessages(addr, clockEdge());
-                (*msgVec)[port] = NULL;
-            } else if ((*msgVec)[port] != NULL) {
+                msgVec[port] = NULL;
+            } else if (msgVec[port] != NULL) {
                 has_other_msgs = true;
             }
         }
         if (!has_other_msgs) {
-            delete msgVec;
             m_waiting_buffers.erase(iter);
         }
     }
@@ -181,41 +198,41 @@ AbstractController::wakeUpBuffer(MessageBuffer* buf, Addr addr)
 void
 AbstractController::wakeUpBuffers(Addr addr)
 {
-    if (m_waiting_buffers.count(addr) > 0) {
+    auto iter = m_waiting_buffers.find(addr);
+    if (iter != m_waiting_buffers.end()) {
         //
         // Wake up all possible lower rank (i.e. lower priority) buffers that could
         // be waiting on this message.
         //
+        MsgVecType &msgVec = iter->second;
         for (int in_port_rank = m_cur_in_port - 1;
              in_port_rank >= 0;
              in_port_rank--) {
-            if ((*(m_waiting_buffers[addr]))[in_port_rank] != NULL) {
-                (*(m_waiting_buffers[addr]))[in_port_rank]->
-                    reanalyzeMessages(addr, clockEdge());
+            if (msgVec[in_port_rank] != NULL) {
+                msgVec[in_port_rank]->reanalyzeMessages(addr, clockEdge());
             }
         }
-        delete m_waiting_buffers[addr];
-        m_waiting_buffers.erase(addr);
+        m_waiting_buffers.erase(iter);
     }
 }
 
 void
 AbstractController::wakeUpAllBuffers(Addr addr)
 {
-    if (m_waiting_buffers.count(addr) > 0) {
+    auto iter = m_waiting_buffers.find(addr);
+    if (iter != m_waiting_buffers.end()) {
         //
         // Wake up all possible buffers that could be waiting on this message.
         //
+        MsgVecType &msgVec = iter->second;
         for (int in_port_rank = m_in_ports - 1;
              in_port_rank >= 0;
              in_port_rank--) {
-            if ((*(m_waiting_buffers[addr]))[in_port_rank] != NULL) {
-                (*(m_waiting_buffers[addr]))[in_port_rank]->
-                    reanalyzeMessages(addr, clockEdge());
+            if (msgVec[in_port_rank] != NULL) {
+                msgVec[in_port_rank]->reanalyzeMessages(addr, clockEdge());
             }
         }
-        delete m_waiting_buffers[addr];
-        m_waiting_buffers.erase(addr);
+        m_waiting_buffers.erase(iter);
     }
 }
 
@@ -226,36 +243,20 @@ AbstractController::wakeUpAllBuffers()
     // Wake up all possible buffers that could be waiting on any message.
     //
 
-    std::vector<MsgVecType*> wokeUpMsgVecs;
     MsgBufType wokeUpMsgBufs;
 
-    if (m_waiting_buffers.size() > 0) {
-        for (WaitingBufType::iterator buf_iter = m_waiting_buffers.begin();
-             buf_iter != m_waiting_buffers.end();
-             ++buf_iter) {
-             for (MsgVecType::iterator vec_iter = buf_iter->second->begin();
-                  vec_iter != buf_iter->second->end();
-                  ++vec_iter) {
-                  //
-                  // Make sure the MessageBuffer has not already be reanalyzed
-                  //
-                  if (*vec_iter != NULL &&
-                      (wokeUpMsgBufs.count(*vec_iter) == 0)) {
-                      (*vec_iter)->reanalyzeAllMessages(clockEdge());
-                      wokeUpMsgBufs.insert(*vec_iter);
-                  }
-             }
-             wokeUpMsgVecs.push_back(buf_iter->second);
-        }
-
-        for (std::vector<MsgVecType*>::iterator wb_iter = wokeUpMsgVecs.begin();
-             wb_iter != wokeUpMsgVecs.end();
-             ++wb_iter) {
-             delete (*wb_iter);
+    for (auto &waiting : m_waiting_buffers) {
+        for (MessageBuffer *buf : waiting.second) {
+            //
+            // Make sure the MessageBuffer has not already be reanalyzed
+            //
+            if (buf != NULL && wokeUpMsgBufs.insert(buf).second) {
+                buf->reanalyzeAllMessages(clockEdge());
+            }
         }
-
-        m_waiting_buffers.clear();
     }
+
+    m_waiting_buffers.clear();
 }
 
 bool
@@ -382,7 +383,7 @@ AbstractController::recvTimingResp(PacketPtr pkt)
         return false;
     }
 
-    std::shared_ptr<MemoryMsg> msg = std::make_shared<MemoryMsg>(clockEdge());
+    RefCountingPtr<MemoryMsg> msg = new MemoryMsg(clockEdge());
     (*msg).m_addr = pkt->getAddr();
     (*msg).m_Sender = m_machineID;
 
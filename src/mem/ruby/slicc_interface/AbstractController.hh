@@ -57,6 +57,7 @@
 #include "mem/ruby/common/Histogram.hh"
 #include "mem/ruby/common/MachineID.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
+#include "mem/ruby/profiler/TransitionProfiler.hh"
 #include "mem/ruby/protocol/AccessPermission.hh"
 #include "mem/ruby/system/CacheRecorder.hh"
 #include "params/RubyController.hh"
@@ -360,6 +361,28 @@ class AbstractController : public ClockedObject, public Consumer
         m_outTrans.erase(iter);
     }
 
+    /**
+     * Note the message of the current in_port, which triggers the
+     * transition about to be sampled by the transition profiler. This
+     * is done before the transition, whose actions may pop the message.
+     */
+    void profileTransitionMessage();
+
+    /** Record a transition sampled by the transition profiler. */
+    void profileTransition(int state, int event, Addr addr, int result);
+
+    /**
+     * Messages stalled with stall_and_wait are parked in their buffer
+     * under their own address, and the buffer is recorded as waiting
+     * on that address. The wake-ups below are keyed by that address:
+     * wakeUpBuffers wakes the lower ranked buffers up, and
+     * wakeUpAllBuffers(addr) all the buffers waiting on it.
+     *
+     * wakeUpAllBuffers() wakes every stalled message of the controller
+     * up. The protocols use it when what a message stalls on is not
+     * its own address, e.g., an L1/L2 transfer or a region, so the
+     * controller cannot tell which messages can make progress.
+     */
     void stallBuffer(MessageBuffer* buf, Addr addr);
     void wakeUpBuffer(MessageBuffer* buf, Addr addr);
     void wakeUpBuffers(Addr addr);
@@ -403,11 +426,19 @@ class AbstractController : public ClockedObject, public Consumer
 
     typedef std::vector<MessageBuffer*> MsgVecType;
     typedef std::set<MessageBuffer*> MsgBufType;
-    typedef std::map<Addr, MsgVecType* > WaitingBufType;
+    // The input ports stalled on each address, indexed by port rank.
+    // Waking the buffers up is independent of the order of the
+    // addresses, as stalled messages go back to their original place
+    // in the buffers, so a hash map gives constant-time lookups.
+    typedef std::unordered_map<Addr, MsgVecType> WaitingBufType;
     WaitingBufType m_waiting_buffers;
 
     unsigned int m_in_ports;
     unsigned int m_cur_in_port;
+    //! Buffer of the in_port being woken up
+    MessageBuffer *m_cur_in_buf = nullptr;
+    //! Sampler of the transitions, null when they are not profiled
+    TransitionSampler *m_transition_sampler = nullptr;
     const int m_number_of_TBEs;
     const int m_transitions_per_cycle;
     const unsigned int m_buffer_size;
@@ -42,9 +42,10 @@
 #define __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 
 #include <iostream>
-#include <memory>
 #include <stack>
+#include <vector>
 
+#include "base/refcnt.hh"
 #include "mem/packet.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/common/WriteMask.hh"
@@ -57,9 +58,75 @@ namespace ruby
 {
 
 class Message;
-typedef std::shared_ptr<Message> MsgPtr;
+typedef RefCountingPtr<Message> MsgPtr;
 
-class Message
+/**
+ * Per-type free list of message storage. The SLICC generated message
+ * classes allocate through it, so that the steady stream of messages
+ * created and destroyed by the controllers reuses the same storage
+ * instead of going through malloc. The free lists are per thread, as
+ * Ruby objects may be simulated by several threads; storage released
+ * by another thread than the one that allocated it simply moves to
+ * the free list of the releasing thread.
+ */
+template <class T>
+class MessagePool
+{
+  private:
+    //! Bound on the number of free blocks kept by each thread
+    static constexpr size_t maxFree = 4096;
+
+    struct FreeList
+    {
+        std::vector<void *> blocks;
+
+        ~FreeList()
+        {
+            for (auto *block : blocks)
+                ::operator delete(block);
+        }
+    };
+
+    static std::vector<void *> &
+    freeBlocks()
+    {
+        thread_local FreeList free_list;
+        return free_list.blocks;
+    }
+
+  public:
+    static void *
+    allocate(size_t size)
+    {
+        auto &blocks = freeBlocks();
+        // Classes deriving from T do not use the pool
+        if (size != sizeof(T) || blocks.empty())
+            return ::operator new(size);
+        void *block = blocks.back();
+        blocks.pop_back();
+        return block;
+    }
+
+    static void
+    release(void *block, size_t size)
+    {
+        auto &blocks = freeBlocks();
+        if (size != sizeof(T) || blocks.size() >= maxFree) {
+            ::operator delete(block);
+            return;
+        }
+        blocks.push_back(block);
+    }
+};
+
+/**
+ * Base class of the messages exchanged by Ruby controllers. Messages
+ * are reference counted through an intrusive, non-atomic count: a
+ * message is only ever referenced by the thread simulating the objects
+ * it is queued at, and is handed over between threads through the
+ * MessageBuffer at quantum boundaries.
+ */
+class Message : public RefCounted
 {
   public:
     Message(Tick curTime)
@@ -68,7 +135,28 @@ class Message
           m_DelayedTicks(0), m_msg_counter(0)
     { }
 
-    Message(const Message &other) = default;
+    // The reference count is not copied, a copy is a new message
+    Message(const Message &other)
+        : RefCounted(),
+          m_time(other.m_time),
+          m_LastEnqueueTime(other.m_LastEnqueueTime),
+          m_DelayedTicks(other.m_DelayedTicks),
+          m_msg_counter(other.m_msg_counter),
+          incoming_link(other.incoming_link),
+          vnet(other.vnet)
+    { }
+
+    Message &
+    operator=(const Message &other)
+    {
+        m_time = other.m_time;
+        m_LastEnqueueTime = other.m_LastEnqueueTime;
+        m_DelayedTicks = other.m_DelayedTicks;
+        m_msg_counter = other.m_msg_counter;
+        incoming_link = other.incoming_link;
+        vnet = other.vnet;
+        return *this;
+    }
 
     virtual ~Message() { }
 
@@ -110,6 +198,22 @@ class Message
     void setMsgCounter(uint64_t c) { m_msg_counter = c; }
     uint64_t getMsgCounter() const { return m_msg_counter; }
 
+    /**
+     * Get the machine that made the request this message is part of.
+     * Returns false if the message does not carry one.
+     */
+    virtual bool getRequestorMachine(MachineID &requestor) const
+    { return false; }
+
+    /**
+     * Get the address of the line this message refers to, used by the
+     * message buffers to skip functional accesses to lines they do not
+     * hold. Returns false if the message does not carry one, in which
+     * case it may match any functional access.
+     */
+    virtual bool getAccessedLine(Addr &line_addr) const
+    { return false; }
+
     // Functions related to network traversal
     virtual const NetDest& getDestination() const
     { panic("getDestination() called on wrong message!"); }
@@ -215,7 +215,19 @@ class RubyRequest : public Message
 
     RubyRequest(Tick curTime) : Message(curTime) {}
     MsgPtr clone() const
-    { return std::shared_ptr<Message>(new RubyRequest(*this)); }
+    { return MsgPtr(new RubyRequest(*this)); }
+
+    static void *
+    operator new(size_t size)
+    {
+        return MessagePool<RubyRequest>::allocate(size);
+    }
+
+    static void
+    operator delete(void *ptr, size_t size)
+    {
+        MessagePool<RubyRequest>::release(ptr, size);
+    }
 
     Addr getLineAddress() const { return m_LineAddress; }
     Addr getPhysicalAddress() const { return m_PhysicalAddress; }
@@ -226,6 +238,13 @@ class RubyRequest : public Message
     const PrefetchBit& getPrefetch() const { return m_Prefetch; }
     RequestPtr getRequestPtr() const { return m_pkt->req; }
 
+    bool
+    getAccessedLine(Addr &line_addr) const override
+    {
+        line_addr = m_LineAddress;
+        return true;
+    }
+
     void setWriteMask(uint32_t offset, uint32_t len,
         std::vector< std::pair<int,AtomicOpFunctor*>> atomicOps);
     void print(std::ostream& out) const;
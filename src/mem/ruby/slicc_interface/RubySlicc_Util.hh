@@ -46,6 +46,7 @@
 #ifndef __MEM_RUBY_SLICC_INTERFACE_RUBYSLICC_UTIL_HH__
 #define __MEM_RUBY_SLICC_INTERFACE_RUBYSLICC_UTIL_HH__
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 
@@ -281,23 +282,24 @@ testAndReadMask(Addr addr, DataBlock& blk, WriteMask& mask, Packet *pkt)
 
 /**
  * This function accepts an address, a data block and a packet. If the address
- * range for the data block contains the address which the packet needs to
- * write, then the data from the packet is written to the data block. True is
- * returned if the data block was written, otherwise false is returned.
+ * range for the data block overlaps the addresses which the packet needs to
+ * write, then the overlapping data from the packet is written to the data
+ * block. The packet may span several lines. True is returned if the data
+ * block was written, otherwise false is returned.
  */
 inline bool
 testAndWrite(Addr addr, DataBlock& blk, Packet *pkt)
 {
-    Addr pktLineAddr = makeLineAddress(pkt->getAddr());
     Addr lineAddr = makeLineAddress(addr);
-
-    if (pktLineAddr == lineAddr) {
-        const uint8_t *data = pkt->getConstPtr<uint8_t>();
-        unsigned int size_in_bytes = pkt->getSize();
-        unsigned startByte = pkt->getAddr() - lineAddr;
-
-        for (unsigned i = 0; i < size_in_bytes; ++i) {
-            blk.setByte(i + startByte, data[i]);
+    Addr pktAddr = pkt->getAddr();
+    Addr start = std::max(pktAddr, lineAddr);
+    Addr end = std::min(pktAddr + pkt->getSize(),
+                        makeNextStrideAddress(lineAddr, 1));
+
+    if (start < end) {
+        const uint8_t *data = pkt->getConstPtr<uint8_t>() + (start - pktAddr);
+        for (Addr byte = start; byte < end; ++byte) {
+            blk.setByte(byte - lineAddr, *data++);
         }
         return true;
     }
@@ -169,6 +169,20 @@ class CacheMemory : public SimObject
     int findTagInSet(int64_t line, Addr tag) const;
     int findTagInSetIgnorePermissions(int64_t cacheSet, Addr tag) const;
 
+    // Index of a way of a set in the flat entry and tag arrays
+    int64_t
+    entryIndex(int64_t cacheSet, int way) const
+    {
+        return cacheSet * m_cache_assoc + way;
+    }
+
+    // Forget the result of the last tag search
+    void
+    resetLastLookup()
+    {
+        m_last_lookup_addr = MaxAddr;
+    }
+
     // Private copy constructor and assignment operator
     CacheMemory(const CacheMemory& obj);
     CacheMemory& operator=(const CacheMemory& obj);
@@ -177,10 +191,19 @@ class CacheMemory : public SimObject
     // Data Members (m_prefix)
     bool m_is_instruction_only_cache;
 
-    // The first index is the # of cache lines.
-    // The second index is the the amount associativity.
-    std::unordered_map<Addr, int> m_tag_index;
-    std::vector<std::vector<AbstractCacheEntry*> > m_cache;
+    // The entries of all the sets, stored set after set, and the line
+    // address held by each way (MaxAddr if the way is empty). A lookup
+    // compares the tags of a set, which are contiguous.
+    std::vector<AbstractCacheEntry*> m_cache;
+    std::vector<Addr> m_tags;
+
+    // The protocols look the same address up several times within a
+    // transition. The way found by the last tag search is kept (-1 if
+    // the address was not present), and reset whenever an entry is
+    // allocated or deallocated. Permissions are still checked on every
+    // lookup, as they change without the cache being involved.
+    mutable Addr m_last_lookup_addr;
+    mutable int m_last_lookup_way;
 
     /** We use the replacement policies from the Classic memory system. */
     replacement_policy::Base *m_replacementPolicy_ptr;
@@ -198,14 +221,14 @@ class CacheMemory : public SimObject
     int m_block_size;
 
     /**
-     * We store all the ReplacementData in a 2-dimensional array. By doing
+     * We store all the ReplacementData in a set-major array. By doing
      * this, we can use all replacement policies from Classic system. Ruby
      * cache will deallocate cache entry every time we evict the cache block
      * so we cannot store the ReplacementData inside the cache entry.
      * Instantiate ReplacementData for multiple times will break replacement
      * policy like TreePLRU.
      */
-    std::vector<std::vector<ReplData> > replacement_data;
+    std::vector<ReplData> replacement_data;
 
     /**
      * Set to true when using WeightedLRU replacement policy, otherwise, set to
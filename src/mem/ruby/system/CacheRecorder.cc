@@ -29,6 +29,16 @@
 
 #include "mem/ruby/system/CacheRecorder.hh"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "base/logging.hh"
 #include "debug/RubyCacheTrace.hh"
 #include "mem/packet.hh"
 #include "mem/ruby/system/RubySystem.hh"
@@ -41,6 +51,13 @@ namespace gem5
 namespace ruby
 {
 
+namespace
+{
+
+const char cacheTraceMagic[8] = {'R', 'U', 'B', 'Y', 'T', 'R', 'C', '2'};
+
+} // anonymous namespace
+
 void
 TraceRecord::print(std::ostream& out) const
 {
@@ -49,49 +66,170 @@ TraceRecord::print(std::ostream& out) const
         << m_type << ", Time: " << m_time << "]";
 }
 
-CacheRecorder::CacheRecorder()
-    : m_uncompressed_trace(NULL),
-      m_uncompressed_trace_size(0),
-      m_block_size_bytes(RubySystem::getBlockSizeBytes())
+void
+CacheTraceRecord::print(std::ostream& out) const
 {
+    out << "[TraceRecord: Node, " << m_cntrl_id << ", "
+        << m_data_address << ", " << (RubyRequestType)m_type << "]";
 }
 
-CacheRecorder::CacheRecorder(uint8_t* uncompressed_trace,
-                             uint64_t uncompressed_trace_size,
-                             std::vector<RubyPort*>& ruby_port_map,
-                             uint64_t block_size_bytes)
-    : m_uncompressed_trace(uncompressed_trace),
-      m_uncompressed_trace_size(uncompressed_trace_size),
-      m_ruby_port_map(ruby_port_map), m_bytes_read(0),
+CacheRecorder::CacheRecorder(std::vector<RubyPort*>& ruby_port_map,
+                             uint64_t block_size_bytes,
+                             unsigned warmup_window)
+    : m_trace(NULL), m_num_trace_records(0), m_trace_buffer(NULL),
+      m_trace_mapping(NULL), m_trace_mapping_size(0),
+      m_ruby_port_map(ruby_port_map),
       m_records_read(0), m_records_flushed(0),
-      m_block_size_bytes(block_size_bytes)
-
+      m_block_size_bytes(block_size_bytes),
+      m_warmup_window(std::max(warmup_window, 1u)), m_outstanding(0),
+      m_retry_port(nullptr),
+      m_retry_event([this]{ retryRequests(); }, "CacheRecorder.retry")
 {
-    if (m_uncompressed_trace != NULL) {
-        if (m_block_size_bytes < RubySystem::getBlockSizeBytes()) {
-            // Block sizes larger than when the trace was recorded are not
-            // supported, as we cannot reliably turn accesses to smaller blocks
-            // into larger ones.
-            panic("Recorded cache block size (%d) < current block size (%d) !!",
-                    m_block_size_bytes, RubySystem::getBlockSizeBytes());
-        }
+    std::vector<RubyPort *> ports;
+    for (RubyPort *port : m_ruby_port_map) {
+        auto it = std::find(ports.begin(), ports.end(), port);
+        m_port_index.push_back(it - ports.begin());
+        if (it == ports.end())
+            ports.push_back(port);
     }
+    m_port_outstanding.resize(ports.size(), 0);
 }
 
 CacheRecorder::~CacheRecorder()
 {
-    if (m_uncompressed_trace != NULL) {
-        delete [] m_uncompressed_trace;
-        m_uncompressed_trace = NULL;
-    }
+    if (m_retry_event.scheduled())
+        m_retry_port->deschedule(m_retry_event);
+    for (auto &request : m_retry_requests)
+        delete request.second;
+    releaseTrace();
     m_ruby_port_map.clear();
 }
 
+void
+CacheRecorder::makeRequest(RubyPort *port, PacketPtr pkt)
+{
+    const RequestStatus status = port->makeRequest(pkt);
+    if (status == RequestStatus_Issued)
+        return;
+
+    DPRINTF(RubyCacheTrace, "Request for %#x not issued (%s), retrying\n",
+            pkt->getAddr(), RequestStatus_to_string(status));
+    m_retry_requests.emplace_back(port, pkt);
+    if (!m_retry_event.scheduled()) {
+        m_retry_port = port;
+        port->schedule(m_retry_event, port->clockEdge(Cycles(1)));
+    }
+}
+
+void
+CacheRecorder::retryRequests()
+{
+    std::vector<std::pair<RubyPort*, PacketPtr>> requests;
+    requests.swap(m_retry_requests);
+    for (auto &request : requests)
+        makeRequest(request.first, request.second);
+}
+
+void
+CacheRecorder::releaseTrace()
+{
+    if (m_trace_mapping != NULL) {
+        munmap(m_trace_mapping, m_trace_mapping_size);
+        m_trace_mapping = NULL;
+    }
+    delete [] m_trace_buffer;
+    m_trace_buffer = NULL;
+    m_trace = NULL;
+    m_num_trace_records = 0;
+}
+
+void
+CacheRecorder::checkBlockSize() const
+{
+    if (m_block_size_bytes < RubySystem::getBlockSizeBytes()) {
+        // Block sizes larger than when the trace was recorded are not
+        // supported, as we cannot reliably turn accesses to smaller blocks
+        // into larger ones.
+        panic("Recorded cache block size (%d) < current block size (%d) !!",
+                m_block_size_bytes, RubySystem::getBlockSizeBytes());
+    }
+}
+
+void
+CacheRecorder::mapTrace(const std::string &filename)
+{
+    releaseTrace();
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        perror("open");
+        fatal("Unable to open trace file %s", filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        fatal("Unable to stat trace file %s", filename);
+    fatal_if(st.st_size < sizeof(CacheTraceHeader),
+             "Cache trace file %s is truncated\n", filename);
+
+    m_trace_mapping_size = st.st_size;
+    // The read requests of the warmup write their responses to the
+    // records, keep these writes private to the process
+    m_trace_mapping = mmap(NULL, m_trace_mapping_size,
+                           PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m_trace_mapping == MAP_FAILED) {
+        m_trace_mapping = NULL;
+        fatal("Unable to map trace file %s", filename);
+    }
+    // The records are only ever replayed from the start to the end
+    madvise(m_trace_mapping, m_trace_mapping_size, MADV_SEQUENTIAL);
+
+    CacheTraceHeader header;
+    memcpy(&header, m_trace_mapping, sizeof(header));
+    fatal_if(memcmp(header.magic, cacheTraceMagic, sizeof(header.magic)),
+             "%s is not a Ruby cache trace\n", filename);
+
+    m_block_size_bytes = header.block_size_bytes;
+    checkBlockSize();
+    fatal_if(header.num_records * recordSize() >
+             m_trace_mapping_size - sizeof(CacheTraceHeader),
+             "Cache trace file %s is truncated\n", filename);
+
+    m_trace = (uint8_t *)m_trace_mapping + sizeof(CacheTraceHeader);
+    m_num_trace_records = header.num_records;
+}
+
+void
+CacheRecorder::loadLegacyTrace(uint8_t *trace, uint64_t trace_size)
+{
+    releaseTrace();
+    checkBlockSize();
+
+    // Convert the records to the layout replayed by the warmup. The old
+    // records are already in the order in which they are replayed.
+    const uint64_t legacy_size = sizeof(TraceRecord) + m_block_size_bytes;
+    m_num_trace_records = trace_size / legacy_size;
+    m_trace_buffer = new uint8_t[m_num_trace_records * recordSize()];
+    for (uint64_t i = 0; i < m_num_trace_records; ++i) {
+        const TraceRecord *old_rec =
+            (const TraceRecord *)(trace + i * legacy_size);
+        CacheTraceRecord *rec =
+            (CacheTraceRecord *)(m_trace_buffer + i * recordSize());
+        rec->m_data_address = old_rec->m_data_address;
+        rec->m_cntrl_id = old_rec->m_cntrl_id;
+        rec->m_type = old_rec->m_type;
+        memcpy(rec->m_data, old_rec->m_data, m_block_size_bytes);
+    }
+    delete [] trace;
+    m_trace = m_trace_buffer;
+}
+
 void
 CacheRecorder::enqueueNextFlushRequest()
 {
-    if (m_records_flushed < m_records.size()) {
-        TraceRecord* rec = m_records[m_records_flushed];
+    if (m_records_flushed < getNumRecords()) {
+        CacheTraceRecord* rec = recordedRecord(m_records_flushed);
         m_records_flushed++;
         auto req = std::make_shared<Request>(rec->m_data_address,
                                              m_block_size_bytes, 0,
@@ -103,7 +241,7 @@ CacheRecorder::enqueueNextFlushRequest()
 
         RubyPort* m_ruby_port_ptr = m_ruby_port_map[rec->m_cntrl_id];
         assert(m_ruby_port_ptr != NULL);
-        m_ruby_port_ptr->makeRequest(pkt);
+        makeRequest(m_ruby_port_ptr, pkt);
 
         DPRINTF(RubyCacheTrace, "Flushing %s\n", *rec);
 
@@ -118,115 +256,146 @@ CacheRecorder::enqueueNextFlushRequest()
 void
 CacheRecorder::enqueueNextFetchRequest()
 {
-    if (m_bytes_read < m_uncompressed_trace_size) {
-        TraceRecord* traceRecord = (TraceRecord*) (m_uncompressed_trace +
-                                                                m_bytes_read);
+    const uint64_t ruby_block_size = RubySystem::getBlockSizeBytes();
+
+    while (m_records_read < m_num_trace_records &&
+           m_outstanding < m_warmup_window) {
+        CacheTraceRecord* traceRecord = replayRecord(m_records_read);
+
+        // Keep the order of the requests through a sequencer and of
+        // the requests to a line. Controllers without a sequencer share
+        // the one of another controller.
+        const uint32_t port_idx = m_port_index[traceRecord->m_cntrl_id];
+        if (m_port_outstanding[port_idx] != 0)
+            break;
+        bool in_flight = false;
+        for (uint64_t offset = 0; offset < m_block_size_bytes;
+                offset += ruby_block_size) {
+            if (m_lines_in_flight.count(
+                    traceRecord->m_data_address + offset)) {
+                in_flight = true;
+                break;
+            }
+        }
+        if (in_flight)
+            break;
 
         DPRINTF(RubyCacheTrace, "Issuing %s\n", *traceRecord);
 
-        for (int rec_bytes_read = 0; rec_bytes_read < m_block_size_bytes;
-                rec_bytes_read += RubySystem::getBlockSizeBytes()) {
+        // Account for the record before issuing it, in case a request
+        // completes while it is being made
+        m_records_read++;
+
+        for (uint64_t rec_bytes_read = 0;
+                rec_bytes_read < m_block_size_bytes;
+                rec_bytes_read += ruby_block_size) {
             RequestPtr req;
             MemCmd::Command requestType;
+            const Addr addr = traceRecord->m_data_address + rec_bytes_read;
 
             if (traceRecord->m_type == RubyRequestType_LD) {
                 requestType = MemCmd::ReadReq;
                 req = std::make_shared<Request>(
-                    traceRecord->m_data_address + rec_bytes_read,
-                    RubySystem::getBlockSizeBytes(), 0,
-                                    Request::funcRequestorId);
+                    addr, ruby_block_size, 0, Request::funcRequestorId);
             }   else if (traceRecord->m_type == RubyRequestType_IFETCH) {
                 requestType = MemCmd::ReadReq;
                 req = std::make_shared<Request>(
-                        traceRecord->m_data_address + rec_bytes_read,
-                        RubySystem::getBlockSizeBytes(),
+                        addr, ruby_block_size,
                         Request::INST_FETCH, Request::funcRequestorId);
             }   else {
                 requestType = MemCmd::WriteReq;
                 req = std::make_shared<Request>(
-                    traceRecord->m_data_address + rec_bytes_read,
-                    RubySystem::getBlockSizeBytes(), 0,
-                                Request::funcRequestorId);
+                    addr, ruby_block_size, 0, Request::funcRequestorId);
             }
 
             Packet *pkt = new Packet(req, requestType);
             pkt->dataStatic(traceRecord->m_data + rec_bytes_read);
             pkt->req->setReqInstSeqNum(m_records_read);
 
+            m_lines_in_flight[addr] = port_idx;
+            m_port_outstanding[port_idx]++;
+            m_outstanding++;
 
             RubyPort* m_ruby_port_ptr =
                 m_ruby_port_map[traceRecord->m_cntrl_id];
             assert(m_ruby_port_ptr != NULL);
-            m_ruby_port_ptr->makeRequest(pkt);
+            makeRequest(m_ruby_port_ptr, pkt);
         }
+    }
 
-        m_bytes_read += (sizeof(TraceRecord) + m_block_size_bytes);
-        m_records_read++;
-    } else {
+    if (m_records_read == m_num_trace_records && m_outstanding == 0) {
         exitSimLoop("Finished Warmup", 0);
         DPRINTF(RubyCacheTrace, "Fetched all %d records\n", m_records_read);
     }
 }
 
+void
+CacheRecorder::fetchRequestDone(PacketPtr pkt)
+{
+    auto it = m_lines_in_flight.find(makeLineAddress(pkt->getAddr()));
+    assert(it != m_lines_in_flight.end());
+    assert(m_port_outstanding[it->second] > 0);
+    assert(m_outstanding > 0);
+    m_port_outstanding[it->second]--;
+    m_outstanding--;
+    m_lines_in_flight.erase(it);
+
+    enqueueNextFetchRequest();
+}
+
 void
 CacheRecorder::addRecord(int cntrl, Addr data_addr, Addr pc_addr,
                          RubyRequestType type, Tick time, DataBlock& data)
 {
-    TraceRecord* rec = (TraceRecord*)malloc(sizeof(TraceRecord) +
-                                            m_block_size_bytes);
+    const uint64_t idx = getNumRecords();
+    m_recorded.resize(m_recorded.size() + recordSize());
+    CacheTraceRecord* rec = recordedRecord(idx);
     rec->m_cntrl_id     = cntrl;
-    rec->m_time         = time;
     rec->m_data_address = data_addr;
-    rec->m_pc_address   = pc_addr;
     rec->m_type         = type;
     memcpy(rec->m_data, data.getData(0, m_block_size_bytes),
            m_block_size_bytes);
+    m_record_times.emplace_back(time, idx);
 
     DPRINTF(RubyCacheTrace, "Inside addRecord with cntrl id %d and type %d\n",
             cntrl, type);
-    m_records.push_back(rec);
 }
 
-uint64_t
-CacheRecorder::aggregateRecords(uint8_t **buf, uint64_t total_size)
+void
+CacheRecorder::writeTrace(const std::string &filename)
 {
-    std::sort(m_records.begin(), m_records.end(), compareTraceRecords);
-
-    int size = m_records.size();
-    uint64_t current_size = 0;
-    int record_size = sizeof(TraceRecord) + m_block_size_bytes;
-
-    for (int i = 0; i < size; ++i) {
-        // Determine if we need to expand the buffer size
-        if (current_size + record_size > total_size) {
-            uint8_t* new_buf = new (std::nothrow) uint8_t[total_size * 2];
-            if (new_buf == NULL) {
-                fatal("Unable to allocate buffer of size %s\n",
-                      total_size * 2);
-            }
-            total_size = total_size * 2;
-            uint8_t* old_buf = *buf;
-            memcpy(new_buf, old_buf, current_size);
-            *buf = new_buf;
-            delete [] old_buf;
-        }
-
-        // Copy the current record into the buffer
-        memcpy(&((*buf)[current_size]), m_records[i], record_size);
-        current_size += record_size;
-
-        free(m_records[i]);
-        m_records[i] = NULL;
+    // Replay the least recently accessed lines first, so that the
+    // replacement state of the caches is rebuilt along with their
+    // contents
+    std::stable_sort(m_record_times.begin(), m_record_times.end(),
+        [](const std::pair<Tick, uint64_t> &a,
+           const std::pair<Tick, uint64_t> &b)
+        { return a.first < b.first; });
+
+    std::ofstream out(filename, std::ios::out | std::ios::binary |
+                      std::ios::trunc);
+    if (!out)
+        fatal("Can't open memory trace file '%s'\n", filename);
+
+    CacheTraceHeader header;
+    memcpy(header.magic, cacheTraceMagic, sizeof(header.magic));
+    header.block_size_bytes = m_block_size_bytes;
+    header.num_records = getNumRecords();
+    out.write((const char *)&header, sizeof(header));
+
+    for (const auto &rec : m_record_times) {
+        out.write((const char *)recordedRecord(rec.second), recordSize());
     }
 
-    m_records.clear();
-    return current_size;
+    out.close();
+    if (out.fail())
+        fatal("Write failed on memory trace file '%s'\n", filename);
 }
 
 uint64_t
 CacheRecorder::getNumRecords() const
 {
-    return m_records.size();
+    return m_record_times.size();
 }
 
 } // namespace ruby
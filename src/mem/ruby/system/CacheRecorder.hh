@@ -29,19 +29,25 @@
 
 /*
  * Recording cache requests made to a ruby cache at certain ruby
- * time. Also dump the requests to a gziped file.
+ * time. Also dump the requests to a trace file in the checkpoint.
  */
 
 #ifndef __MEM_RUBY_SYSTEM_CACHERECORDER_HH__
 #define __MEM_RUBY_SYSTEM_CACHERECORDER_HH__
 
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "base/types.hh"
+#include "mem/packet.hh"
+#include "mem/ruby/protocol/RequestStatus.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/DataBlock.hh"
 #include "mem/ruby/common/TypeDefines.hh"
 #include "mem/ruby/protocol/RubyRequestType.hh"
+#include "sim/eventq.hh"
 
 namespace gem5
 {
@@ -52,10 +58,11 @@ namespace ruby
 class Sequencer;
 class RubyPort;
 /*!
- * Class for recording cache contents. Note that the last element of the
- * class is an array of length zero. It is used for creating variable
- * length object, so that while writing the data to a file one does not
- * need to copy the meta data and the actual data separately.
+ * Layout of the records of the gzipped cache traces written by older
+ * versions, which can still be restored. Note that the last element of
+ * the class is an array of length zero. It is used for creating
+ * variable length object, so that while writing the data to a file one
+ * does not need to copy the meta data and the actual data separately.
  */
 class TraceRecord
 {
@@ -70,23 +77,62 @@ class TraceRecord
     void print(std::ostream& out) const;
 };
 
+/*!
+ * A record of the cache trace files, followed by the data of the block.
+ * The records are stored back to back, in the order they are replayed,
+ * after a CacheTraceHeader.
+ */
+struct CacheTraceRecord
+{
+    Addr m_data_address;
+    uint32_t m_cntrl_id;
+    uint32_t m_type;
+    uint8_t m_data[0];
+
+    void print(std::ostream& out) const;
+};
+
+struct CacheTraceHeader
+{
+    char magic[8];
+    uint64_t block_size_bytes;
+    uint64_t num_records;
+};
+
 class CacheRecorder
 {
   public:
-    CacheRecorder();
+    CacheRecorder(std::vector<RubyPort*>& ruby_port_map,
+                  uint64_t block_size_bytes, unsigned warmup_window);
     ~CacheRecorder();
 
-    CacheRecorder(uint8_t* uncompressed_trace,
-                  uint64_t uncompressed_trace_size,
-                  std::vector<RubyPort*>& ruby_port_map,
-                  uint64_t block_size_bytes);
     void addRecord(int cntrl, Addr data_addr, Addr pc_addr,
                    RubyRequestType type, Tick time, DataBlock& data);
 
-    uint64_t aggregateRecords(uint8_t **data, uint64_t size);
-
     uint64_t getNumRecords() const;
 
+    /*!
+     * Write the recorded cache contents to a trace file, sorted in the
+     * order in which they are replayed. The records are held in memory
+     * from the time they are added until the trace is written, as they
+     * are also used by the flush and can only be sorted once they are
+     * all recorded. They are written from there without another copy.
+     */
+    void writeTrace(const std::string &filename);
+
+    /*!
+     * Map a trace file made by writeTrace in memory for the warmup. The
+     * records are read from the mapping as they are replayed.
+     */
+    void mapTrace(const std::string &filename);
+
+    /*!
+     * Use the uncompressed contents of a gzipped cache trace made by an
+     * older version for the warmup. The recorder takes ownership of the
+     * buffer.
+     */
+    void loadLegacyTrace(uint8_t *trace, uint64_t trace_size);
+
     /*!
      * Function for flushing the memory contents of the caches to the
      * main memory. It goes through the recorded contents of the caches,
@@ -100,35 +146,103 @@ class CacheRecorder
     /*!
      * Function for fetching warming up the memory and the caches. It goes
      * through the recorded contents of the caches, as available in the
-     * checkpoint and issues fetch requests. Except for the first one, a
-     * fetch request is issued only after the previous one has completed.
+     * checkpoint and issues fetch requests. Up to warmup_window requests
+     * are in flight at once, but the requests through a sequencer are
+     * issued one after the other and a line is only fetched through one
+     * sequencer at a time, so that each sequencer issues its requests
+     * in the recorded order. The lines are still fetched concurrently
+     * through different sequencers, so the order in which the shared
+     * levels see them may differ from a replay one request at a time.
      * It should be possible to use this with any protocol.
      */
     void enqueueNextFetchRequest();
 
+    /*!
+     * Notify the recorder that a fetch request it issued has completed,
+     * and issue the next ones.
+     */
+    void fetchRequestDone(PacketPtr pkt);
+
   private:
     // Private copy constructor and assignment operator
     CacheRecorder(const CacheRecorder& obj);
     CacheRecorder& operator=(const CacheRecorder& obj);
 
-    std::vector<TraceRecord*> m_records;
-    uint8_t* m_uncompressed_trace;
-    uint64_t m_uncompressed_trace_size;
+    uint64_t recordSize() const
+    {
+        return sizeof(CacheTraceRecord) + m_block_size_bytes;
+    }
+
+    CacheTraceRecord *
+    replayRecord(uint64_t idx)
+    {
+        return reinterpret_cast<CacheTraceRecord *>(
+            m_trace + idx * recordSize());
+    }
+
+    CacheTraceRecord *
+    recordedRecord(uint64_t idx)
+    {
+        return reinterpret_cast<CacheTraceRecord *>(
+            m_recorded.data() + idx * recordSize());
+    }
+
+    void checkBlockSize() const;
+    void releaseTrace();
+
+    /*!
+     * Make a request through a sequencer. The requests the sequencer
+     * does not accept, e.g. because its request table is full, are
+     * retried on the next cycle of the sequencer.
+     */
+    void makeRequest(RubyPort *port, PacketPtr pkt);
+    void retryRequests();
+
+    //! Recorded records, back to back, and the time of their last
+    //! access along with their index
+    std::vector<uint8_t> m_recorded;
+    std::vector<std::pair<Tick, uint64_t>> m_record_times;
+
+    //! Records of the trace being replayed
+    uint8_t* m_trace;
+    uint64_t m_num_trace_records;
+    //! Buffer or mapping holding the trace being replayed
+    uint8_t* m_trace_buffer;
+    void* m_trace_mapping;
+    uint64_t m_trace_mapping_size;
+
     std::vector<RubyPort*> m_ruby_port_map;
-    uint64_t m_bytes_read;
+    //! Index of the sequencer of each controller, as controllers
+    //! without a sequencer use the one of another controller
+    std::vector<uint32_t> m_port_index;
     uint64_t m_records_read;
     uint64_t m_records_flushed;
     uint64_t m_block_size_bytes;
+
+    //! Maximum and current number of fetch requests in flight
+    const unsigned m_warmup_window;
+    unsigned m_outstanding;
+    //! Fetch requests in flight through each sequencer
+    std::vector<unsigned> m_port_outstanding;
+    //! Sequencer of each line being fetched
+    std::unordered_map<Addr, uint32_t> m_lines_in_flight;
+
+    //! Requests not accepted by their sequencer, to be retried
+    std::vector<std::pair<RubyPort*, PacketPtr>> m_retry_requests;
+    RubyPort *m_retry_port;
+    EventFunctionWrapper m_retry_event;
 };
 
-inline bool
-compareTraceRecords(const TraceRecord* n1, const TraceRecord* n2)
+inline std::ostream&
+operator<<(std::ostream& out, const TraceRecord& obj)
 {
-    return n1->m_time > n2->m_time;
+    obj.print(out);
+    out << std::flush;
+    return out;
 }
 
 inline std::ostream&
-operator<<(std::ostream& out, const TraceRecord& obj)
+operator<<(std::ostream& out, const CacheTraceRecord& obj)
 {
     obj.print(out);
     out << std::flush;
@@ -1007,7 +1007,9 @@ GPUCoalescer::completeHitCallback(std::vector<PacketPtr> & mylist)
 
     RubySystem *rs = m_ruby_system;
     if (RubySystem::getWarmupEnabled()) {
-        rs->m_cache_recorder->enqueueNextFetchRequest();
+        for (auto& pkt : mylist) {
+            rs->m_cache_recorder->fetchRequestDone(pkt);
+        }
     } else if (RubySystem::getCooldownEnabled()) {
         rs->m_cache_recorder->enqueueNextFlushRequest();
     } else {
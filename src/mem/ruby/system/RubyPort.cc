@@ -403,9 +403,6 @@ RubyPort::MemResponsePort::recvFunctional(PacketPtr pkt)
         return;
     }
 
-    assert(pkt->getAddr() + pkt->getSize() <=
-           makeLineAddress(pkt->getAddr()) + RubySystem::getBlockSizeBytes());
-
     if (access_backing_store) {
         // The attached physmem contains the official version of data.
         // The following command performs the real functional access.
@@ -416,7 +413,8 @@ RubyPort::MemResponsePort::recvFunctional(PacketPtr pkt)
         bool accessSucceeded = false;
         bool needsResponse = pkt->needsResponse();
 
-        // Do the functional access on ruby memory
+        // Do the functional access on ruby memory, the packet may span
+        // several lines
         if (pkt->isRead()) {
             accessSucceeded = rs->functionalRead(pkt);
         } else if (pkt->isWrite()) {
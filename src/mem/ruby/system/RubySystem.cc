@@ -43,8 +43,10 @@
 #include <fcntl.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <list>
+#include <memory>
 
 #include "base/compiler.hh"
 #include "base/intmath.hh"
@@ -78,8 +80,17 @@ bool RubySystem::m_cooldown_enabled = false;
 
 RubySystem::RubySystem(const Params &p)
     : ClockedObject(p), m_access_backing_store(p.access_backing_store),
-      m_cache_recorder(NULL)
+      m_warmup_window(p.cache_warmup_window), m_cache_recorder(NULL)
 {
+    // The configuration below is shared by all the Ruby systems, which
+    // may be simulated by different threads, and must therefore agree
+    fatal_if(m_block_size_bytes &&
+             (m_block_size_bytes != p.block_size_bytes ||
+              m_memory_size_bits != p.memory_size_bits ||
+              m_randomization != p.randomization),
+             "%s: Ruby systems must use the same block size, memory size "
+             "and randomization setting\n", name());
+
     m_randomization = p.randomization;
 
     m_block_size_bytes = p.block_size_bytes;
@@ -173,9 +184,7 @@ RubySystem::~RubySystem()
 }
 
 void
-RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
-                              uint64_t cache_trace_size,
-                              uint64_t block_size_bytes)
+RubySystem::makeCacheRecorder(uint64_t block_size_bytes)
 {
     std::vector<RubyPort*> ruby_port_map;
     RubyPort* ruby_port_ptr = NULL;
@@ -211,19 +220,62 @@ RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
     }
 
     // Create the CacheRecorder and record the cache trace
-    m_cache_recorder = new CacheRecorder(uncompressed_trace, cache_trace_size,
-                                         ruby_port_map,
-                                         block_size_bytes);
+    m_cache_recorder = new CacheRecorder(ruby_port_map, block_size_bytes,
+                                         m_warmup_window);
 }
 
+namespace
+{
+
+/**
+ * Gives a functional access exclusive access to all the main event
+ * queues. When the controllers are simulated by several threads, the
+ * state of the controllers and networks owned by other threads is
+ * otherwise changing under the access. The queue of the calling
+ * thread is released first, and all the queues are then taken in
+ * index order so that concurrent functional accesses cannot deadlock.
+ */
+class AllEventQueuesLock
+{
+  private:
+    EventQueue *const ownQueue;
+
+  public:
+    explicit AllEventQueuesLock(bool multi_eventq)
+        : ownQueue(multi_eventq && inParallelMode ? curEventQueue() : nullptr)
+    {
+        if (!ownQueue)
+            return;
+        ownQueue->unlock();
+        for (uint32_t i = 0; i < numMainEventQueues; ++i)
+            getEventQueue(i)->lock();
+    }
+
+    ~AllEventQueuesLock()
+    {
+        if (!ownQueue)
+            return;
+        for (uint32_t i = numMainEventQueues; i > 0; --i)
+            getEventQueue(i - 1)->unlock();
+        ownQueue->lock();
+    }
+};
+
+} // anonymous namespace
+
 void
 RubySystem::memWriteback()
 {
+    // The cache flush replays requests on the event queue of the
+    // RubySystem only
+    fatal_if(m_multi_eventq, "%s: Ruby cache flush is not supported when "
+             "the controllers are on multiple event queues\n", name());
+
     m_cooldown_enabled = true;
 
     // Make the trace so we know what to write back.
     DPRINTF(RubyCacheTrace, "Recording Cache Trace\n");
-    makeCacheRecorder(NULL, 0, getBlockSizeBytes());
+    makeCacheRecorder(getBlockSizeBytes());
     for (int cntrl = 0; cntrl < m_abs_cntrl_vec.size(); cntrl++) {
         m_abs_cntrl_vec[cntrl]->recordCacheTrace(cntrl, m_cache_recorder);
     }
@@ -296,35 +348,6 @@ RubySystem::memWriteback()
     // checkpoint is immediately taken.
 }
 
-void
-RubySystem::writeCompressedTrace(uint8_t *raw_data, std::string filename,
-                                 uint64_t uncompressed_trace_size)
-{
-    // Create the checkpoint file for the memory
-    std::string thefile = CheckpointIn::dir() + "/" + filename.c_str();
-
-    int fd = creat(thefile.c_str(), 0664);
-    if (fd < 0) {
-        perror("creat");
-        fatal("Can't open memory trace file '%s'\n", filename);
-    }
-
-    gzFile compressedMemory = gzdopen(fd, "wb");
-    if (compressedMemory == NULL)
-        fatal("Insufficient memory to allocate compression state for %s\n",
-              filename);
-
-    if (gzwrite(compressedMemory, raw_data, uncompressed_trace_size) !=
-        uncompressed_trace_size) {
-        fatal("Write failed on memory trace file '%s'\n", filename);
-    }
-
-    if (gzclose(compressedMemory)) {
-        fatal("Close failed on memory trace file '%s'\n", filename);
-    }
-    delete[] raw_data;
-}
-
 void
 RubySystem::serialize(CheckpointOut &cp) const
 {
@@ -342,15 +365,15 @@ RubySystem::serialize(CheckpointOut &cp) const
                 "ruby trace");
     }
 
-    // Aggregate the trace entries together into a single array
-    uint8_t *raw_data = new uint8_t[4096];
-    uint64_t cache_trace_size = m_cache_recorder->aggregateRecords(
-                                                        &raw_data, 4096);
-    std::string cache_trace_file = name() + ".cache.gz";
-    writeCompressedTrace(raw_data, cache_trace_file, cache_trace_size);
+    // Write the recorded trace entries to an uncompressed file, so that
+    // it can be mapped in memory when restoring
+    std::string cache_trace_file = name() + ".cache.trace";
+    m_cache_recorder->writeTrace(CheckpointIn::dir() + "/" +
+                                 cache_trace_file);
+    unsigned cache_trace_version = 2;
 
     SERIALIZE_SCALAR(cache_trace_file);
-    SERIALIZE_SCALAR(cache_trace_size);
+    SERIALIZE_SCALAR(cache_trace_version);
 }
 
 void
@@ -398,8 +421,6 @@ RubySystem::readCompressedTrace(std::string filename, uint8_t *&raw_data,
 void
 RubySystem::unserialize(CheckpointIn &cp)
 {
-    uint8_t *uncompressed_trace = NULL;
-
     // This value should be set to the checkpoint-system's block-size.
     // Optional, as checkpoints without it can be run if the
     // checkpoint-system's block-size == current block-size.
@@ -407,25 +428,51 @@ RubySystem::unserialize(CheckpointIn &cp)
     UNSERIALIZE_OPT_SCALAR(block_size_bytes);
 
     std::string cache_trace_file;
-    uint64_t cache_trace_size = 0;
+    // Checkpoints without a version have a gzipped trace
+    unsigned cache_trace_version = 1;
 
     UNSERIALIZE_SCALAR(cache_trace_file);
-    UNSERIALIZE_SCALAR(cache_trace_size);
+    UNSERIALIZE_OPT_SCALAR(cache_trace_version);
     cache_trace_file = cp.getCptDir() + "/" + cache_trace_file;
 
-    readCompressedTrace(cache_trace_file, uncompressed_trace,
-                        cache_trace_size);
     m_warmup_enabled = true;
     m_systems_to_warmup++;
 
     // Create the cache recorder that will hang around until startup.
-    makeCacheRecorder(uncompressed_trace, cache_trace_size, block_size_bytes);
+    makeCacheRecorder(block_size_bytes);
+    if (cache_trace_version == 1) {
+        uint8_t *uncompressed_trace = NULL;
+        uint64_t cache_trace_size = 0;
+        UNSERIALIZE_SCALAR(cache_trace_size);
+        readCompressedTrace(cache_trace_file, uncompressed_trace,
+                            cache_trace_size);
+        m_cache_recorder->loadLegacyTrace(uncompressed_trace,
+                                          cache_trace_size);
+    } else {
+        fatal_if(cache_trace_version != 2,
+                 "Unsupported Ruby cache trace version %d\n",
+                 cache_trace_version);
+        m_cache_recorder->mapTrace(cache_trace_file);
+    }
 }
 
 void
 RubySystem::init()
 {
     registerRequestorIDs();
+
+    // Controllers and networks may be placed on different event queues
+    // and simulated in parallel, in which case they only interact
+    // through message buffers
+    m_multi_eventq = false;
+    for (auto *cntrl : m_abs_cntrl_vec) {
+        if (cntrl->eventQueue() != eventQueue())
+            m_multi_eventq = true;
+    }
+    for (auto &network : m_networks) {
+        if (network->eventQueue() != eventQueue())
+            m_multi_eventq = true;
+    }
 }
 
 void
@@ -449,6 +496,10 @@ RubySystem::startup()
     // state was checkpointed.
 
     if (m_warmup_enabled) {
+        fatal_if(m_multi_eventq, "%s: Ruby cache warmup is not supported "
+                 "when the controllers are on multiple event queues\n",
+                 name());
+
         DPRINTF(RubyCacheTrace, "Starting ruby cache warmup\n");
         // save the current tick value
         Tick curtick_original = curTick();
@@ -499,9 +550,49 @@ RubySystem::resetStats()
     ClockedObject::resetStats();
 }
 
-#ifndef PARTIAL_FUNC_READS
+bool
+RubySystem::forEachLine(PacketPtr pkt,
+                        const std::function<bool(Addr, Packet *)> &f)
+{
+    const Addr start = pkt->getAddr();
+    const Addr end = start + pkt->getSize();
+    Addr line_addr = makeLineAddress(start);
+
+    if (end <= line_addr + m_block_size_bytes)
+        return f(line_addr, pkt);
+
+    const std::vector<bool> &byte_enable = pkt->req->getByteEnable();
+    for (; line_addr < end; line_addr += m_block_size_bytes) {
+        const Addr addr = std::max(start, line_addr);
+        const unsigned size =
+            std::min(end, line_addr + m_block_size_bytes) - addr;
+
+        auto req = std::make_shared<Request>(addr, size,
+            pkt->req->getFlags(), pkt->requestorId());
+        if (!byte_enable.empty()) {
+            auto first = byte_enable.begin() + (addr - start);
+            req->setByteEnable(std::vector<bool>(first, first + size));
+        }
+        Packet line_pkt(req, pkt->cmd);
+        line_pkt.dataStatic(pkt->getPtr<uint8_t>() + (addr - start));
+
+        if (!f(line_addr, &line_pkt))
+            return false;
+    }
+    return true;
+}
+
 bool
 RubySystem::functionalRead(PacketPtr pkt)
+{
+    AllEventQueuesLock all_queues(m_multi_eventq);
+    return forEachLine(pkt, [this](Addr, Packet *line_pkt)
+                       { return functionalReadLine(line_pkt); });
+}
+
+#ifndef PARTIAL_FUNC_READS
+bool
+RubySystem::functionalReadLine(PacketPtr pkt)
 {
     Addr address(pkt->getAddr());
     Addr line_address = makeLineAddress(address);
@@ -617,7 +708,7 @@ RubySystem::functionalRead(PacketPtr pkt)
 }
 #else
 bool
-RubySystem::functionalRead(PacketPtr pkt)
+RubySystem::functionalReadLine(PacketPtr pkt)
 {
     Addr address(pkt->getAddr());
     Addr line_address = makeLineAddress(address);
@@ -720,11 +811,11 @@ RubySystem::functionalRead(PacketPtr pkt)
 bool
 RubySystem::functionalWrite(PacketPtr pkt)
 {
+    AllEventQueuesLock all_queues(m_multi_eventq);
     Addr addr(pkt->getAddr());
-    Addr line_addr = makeLineAddress(addr);
-    AccessPermission access_perm = AccessPermission_NotPresent;
 
-    DPRINTF(RubySystem, "Functional Write request for %#x\n", addr);
+    DPRINTF(RubySystem, "Functional Write request for %#x (%d bytes)\n",
+            addr, pkt->getSize());
 
     [[maybe_unused]] uint32_t num_functional_writes = 0;
 
@@ -732,17 +823,14 @@ RubySystem::functionalWrite(PacketPtr pkt)
     assert(requestorToNetwork.count(pkt->requestorId()));
     int request_net_id = requestorToNetwork[pkt->requestorId()];
     assert(netCntrls.count(request_net_id));
+    const auto &cntrls = netCntrls[request_net_id];
 
-    for (auto& cntrl : netCntrls[request_net_id]) {
+    // Buffers, sequencers and networks write the part of the packet
+    // that overlaps their messages and requests, search them once for
+    // the whole packet
+    for (auto& cntrl : cntrls) {
         num_functional_writes += cntrl->functionalWriteBuffers(pkt);
 
-        access_perm = cntrl->getAccessPermission(line_addr);
-        if (access_perm != AccessPermission_Invalid &&
-            access_perm != AccessPermission_NotPresent) {
-            num_functional_writes +=
-                cntrl->functionalWrite(line_addr, pkt);
-        }
-
         // Also updates requests pending in any sequencer associated
         // with the controller
         if (cntrl->getCPUSequencer()) {
@@ -758,6 +846,21 @@ RubySystem::functionalWrite(PacketPtr pkt)
     for (auto& network : m_networks) {
         num_functional_writes += network->functionalWrite(pkt);
     }
+
+    // The state held by the controllers is looked up by line
+    forEachLine(pkt, [&](Addr line_addr, Packet *line_pkt)
+    {
+        for (auto& cntrl : cntrls) {
+            AccessPermission access_perm =
+                cntrl->getAccessPermission(line_addr);
+            if (access_perm != AccessPermission_Invalid &&
+                access_perm != AccessPermission_NotPresent) {
+                num_functional_writes +=
+                    cntrl->functionalWrite(line_addr, line_pkt);
+            }
+        }
+        return true;
+    });
     DPRINTF(RubySystem, "Messages written = %u\n", num_functional_writes);
 
     return true;
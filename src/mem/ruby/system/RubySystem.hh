@@ -35,6 +35,7 @@
 #ifndef __MEM_RUBY_SYSTEM_RUBYSYSTEM_HH__
 #define __MEM_RUBY_SYSTEM_RUBYSYSTEM_HH__
 
+#include <functional>
 #include <unordered_map>
 
 #include "base/callback.hh"
@@ -100,6 +101,12 @@ class RubySystem : public ClockedObject
     void process();
     void init() override;
     void startup() override;
+
+    /**
+     * Functional accesses. The packet may span several lines, in which
+     * case all of them are accessed while the event queues are locked
+     * once, rather than issuing one access per line.
+     */
     bool functionalRead(Packet *ptr);
     bool functionalWrite(Packet *ptr);
 
@@ -121,15 +128,25 @@ class RubySystem : public ClockedObject
     RubySystem(const RubySystem& obj);
     RubySystem& operator=(const RubySystem& obj);
 
-    void makeCacheRecorder(uint8_t *uncompressed_trace,
-                           uint64_t cache_trace_size,
-                           uint64_t block_size_bytes);
+    void makeCacheRecorder(uint64_t block_size_bytes);
+
+    /** Functional read of a packet within a single line. */
+    bool functionalReadLine(Packet *pkt);
+
+    /**
+     * Call a function with the address and a packet of each line a
+     * functional packet spans, until it returns false. The per line
+     * packets share the data of the original packet; a packet within a
+     * single line is passed as is.
+     *
+     * @return false if the function returned false for any line
+     */
+    bool forEachLine(Packet *pkt,
+                     const std::function<bool(Addr, Packet *)> &f);
 
     static void readCompressedTrace(std::string filename,
                                     uint8_t *&raw_data,
                                     uint64_t &uncompressed_trace_size);
-    static void writeCompressedTrace(uint8_t *raw_data, std::string file,
-                                     uint64_t uncompressed_trace_size);
 
     void processRubyEvent();
   private:
@@ -144,6 +161,10 @@ class RubySystem : public ClockedObject
     static bool m_cooldown_enabled;
     memory::SimpleMemory *m_phys_mem;
     const bool m_access_backing_store;
+    //! Maximum number of cache warmup requests in flight
+    const unsigned m_warmup_window;
+    //! Are the controllers and networks spread over several event queues?
+    bool m_multi_eventq = false;
 
     //std::vector<Network *> m_networks;
     std::vector<std::unique_ptr<Network>> m_networks;
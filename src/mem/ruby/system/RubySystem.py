@@ -57,8 +57,26 @@ class RubySystem(ClockedObject):
         store and only use ruby for timing.",
     )
 
+    cache_warmup_window = Param.Unsigned(
+        16, "maximum number of cache warmup requests in flight"
+    )
+
     # Profiler related configuration variables
     hot_lines = Param.Bool(False, "")
     all_instructions = Param.Bool(False, "")
+    transition_sample_period = Param.Unsigned(
+        0,
+        "sample one out of this many SLICC transitions of each "
+        "controller on average, 0 disables the transition profiler",
+    )
+    transition_sample_entries = Param.Unsigned(
+        4096, "number of recent transition samples kept per controller"
+    )
+    transition_region_bits = Param.Unsigned(
+        12, "log2 of the size of the address regions profiled"
+    )
+    transition_profile_binary = Param.Bool(
+        False, "write the transition profile in binary rather than JSON"
+    )
     num_of_sequencers = Param.Int("")
     number_of_virtual_networks = Param.Unsigned("")
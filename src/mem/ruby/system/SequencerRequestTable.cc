@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/system/SequencerRequestTable.hh"
+
+#include <algorithm>
+
+#include "base/intmath.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+SequencerRequestTable::SequencerRequestTable(unsigned capacity)
+    : m_entries(capacity), m_free(capacity ? 0 : -1),
+      m_slot_bits(ceilLog2(std::max(2 * capacity, 2u)))
+{
+    for (unsigned i = 0; i + 1 < capacity; ++i)
+        m_entries[i].next = i + 1;
+    m_slots.resize(1ULL << m_slot_bits);
+}
+
+int64_t
+SequencerRequestTable::findSlot(Addr line_addr) const
+{
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = home(line_addr); ; i = (i + 1) & mask) {
+        const Slot &slot = m_slots[i];
+        if (slot.head < 0)
+            return -1;
+        if (slot.line == line_addr)
+            return i;
+    }
+}
+
+int32_t
+SequencerRequestTable::allocEntry()
+{
+    if (m_free < 0) {
+        m_entries.emplace_back();
+        return m_entries.size() - 1;
+    }
+    int32_t e = m_free;
+    m_free = m_entries[e].next;
+    return e;
+}
+
+void
+SequencerRequestTable::growSlots()
+{
+    std::vector<Slot> old_slots;
+    old_slots.swap(m_slots);
+    m_slot_bits++;
+    m_slots.resize(1ULL << m_slot_bits);
+
+    const size_t mask = m_slots.size() - 1;
+    for (const auto &slot : old_slots) {
+        if (slot.head < 0)
+            continue;
+        size_t i = home(slot.line);
+        while (m_slots[i].head >= 0)
+            i = (i + 1) & mask;
+        m_slots[i] = slot;
+    }
+}
+
+void
+SequencerRequestTable::eraseSlot(size_t idx)
+{
+    // Move back the slots that follow in the probe sequence, so that
+    // lookups do not need tombstones
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = idx;
+    for (size_t i = (idx + 1) & mask; m_slots[i].head >= 0;
+         i = (i + 1) & mask) {
+        const size_t h = home(m_slots[i].line);
+        const bool in_place = (hole <= i) ? (hole < h && h <= i)
+                                          : (hole < h || h <= i);
+        if (in_place)
+            continue;
+        m_slots[hole] = m_slots[i];
+        hole = i;
+    }
+    m_slots[hole] = Slot();
+    m_num_lines--;
+}
+
+unsigned
+SequencerRequestTable::insert(Addr line_addr, PacketPtr pkt,
+                              RubyRequestType type,
+                              RubyRequestType second_type,
+                              Cycles issue_time)
+{
+    const int32_t e = allocEntry();
+    m_entries[e].req = SequencerRequest(pkt, type, second_type, issue_time);
+    m_entries[e].next = -1;
+    m_size++;
+
+    int64_t idx = findSlot(line_addr);
+    if (idx >= 0) {
+        Slot &slot = m_slots[idx];
+        m_entries[slot.tail].next = e;
+        slot.tail = e;
+        return ++slot.count;
+    }
+
+    if (2 * (m_num_lines + 1) > m_slots.size())
+        growSlots();
+
+    const size_t mask = m_slots.size() - 1;
+    size_t i = home(line_addr);
+    while (m_slots[i].head >= 0)
+        i = (i + 1) & mask;
+    m_slots[i].line = line_addr;
+    m_slots[i].head = e;
+    m_slots[i].tail = e;
+    m_slots[i].count = 1;
+    m_num_lines++;
+    return 1;
+}
+
+SequencerRequest &
+SequencerRequestTable::front(Addr line_addr)
+{
+    const int64_t idx = findSlot(line_addr);
+    assert(idx >= 0);
+    return m_entries[m_slots[idx].head].req;
+}
+
+void
+SequencerRequestTable::popFront(Addr line_addr)
+{
+    const int64_t idx = findSlot(line_addr);
+    assert(idx >= 0);
+    Slot &slot = m_slots[idx];
+
+    const int32_t e = slot.head;
+    slot.head = m_entries[e].next;
+    slot.count--;
+    m_entries[e].req.pkt = nullptr;
+    m_entries[e].next = m_free;
+    m_free = e;
+    m_size--;
+
+    if (slot.head < 0)
+        eraseSlot(idx);
+}
+
+void
+SequencerRequestTable::print(std::ostream &out) const
+{
+    for (const auto &slot : m_slots) {
+        if (slot.head < 0)
+            continue;
+        out << "[ " << slot.line << " =";
+        for (int32_t e = slot.head; e >= 0; e = m_entries[e].next) {
+            out << " "
+                << RubyRequestType_to_string(m_entries[e].req.m_second_type);
+        }
+        out << " ]";
+    }
+}
+
+} // namespace ruby
+} // namespace gem5
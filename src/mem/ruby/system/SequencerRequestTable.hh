@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_SYSTEM_SEQUENCERREQUESTTABLE_HH__
+#define __MEM_RUBY_SYSTEM_SEQUENCERREQUESTTABLE_HH__
+
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/packet.hh"
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/protocol/RubyRequestType.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+struct SequencerRequest
+{
+    PacketPtr pkt;
+    RubyRequestType m_type;
+    RubyRequestType m_second_type;
+    Cycles issue_time;
+    SequencerRequest(PacketPtr _pkt, RubyRequestType _m_type,
+                     RubyRequestType _m_second_type, Cycles _issue_time)
+                : pkt(_pkt), m_type(_m_type), m_second_type(_m_second_type),
+                  issue_time(_issue_time)
+    {}
+
+    bool functionalWrite(Packet *func_pkt) const
+    {
+        // Follow-up on RubyRequest::functionalWrite
+        // This makes sure the hitCallback won't overrite the value we
+        // expect to find
+        assert(func_pkt->isWrite());
+        return func_pkt->trySatisfyFunctional(pkt);
+    }
+};
+
+std::ostream& operator<<(std::ostream& out, const SequencerRequest& obj);
+
+/**
+ * The requests outstanding in a sequencer, grouped by cache line. The
+ * requests are kept in a pool of entries sized for the maximum number
+ * of outstanding requests, and the requests of a line are chained
+ * through the entries in the order they were made. The lines are found
+ * through an open-addressed hash table, so that making and completing a
+ * request does not allocate memory once the table is warm. The pool
+ * only grows in the rare cases where more requests are outstanding,
+ * such as HTM aborts, and the entries never move, so references to
+ * requests stay valid while other requests are made.
+ */
+class SequencerRequestTable
+{
+  public:
+    explicit SequencerRequestTable(unsigned capacity);
+
+    /**
+     * Add a request after the ones outstanding for its line.
+     *
+     * @return Number of requests outstanding for the line, including
+     *         the new one
+     */
+    unsigned insert(Addr line_addr, PacketPtr pkt, RubyRequestType type,
+                    RubyRequestType second_type, Cycles issue_time);
+
+    /** Are there requests outstanding for a line? */
+    bool contains(Addr line_addr) const { return findSlot(line_addr) >= 0; }
+
+    /** Oldest request outstanding for a line, which must have one. */
+    SequencerRequest &front(Addr line_addr);
+
+    /** Remove the oldest request outstanding for a line. */
+    void popFront(Addr line_addr);
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+
+    /**
+     * Call a function on each outstanding request, with the address and
+     * the number of requests of its line. The requests of a line are
+     * visited in the order they were made.
+     */
+    template <typename F>
+    void
+    forEach(F f) const
+    {
+        for (const auto &slot : m_slots) {
+            if (slot.head < 0)
+                continue;
+            for (int32_t e = slot.head; e >= 0; e = m_entries[e].next)
+                f(slot.line, slot.count, m_entries[e].req);
+        }
+    }
+
+    void print(std::ostream &out) const;
+
+  private:
+    struct Entry
+    {
+        Entry() : req(nullptr, RubyRequestType_NULL, RubyRequestType_NULL,
+                      Cycles(0)) {}
+        SequencerRequest req;
+        //! Next request of the line, or next free entry
+        int32_t next = -1;
+    };
+
+    struct Slot
+    {
+        Addr line = 0;
+        //! First and last requests of the line, head is -1 if unused
+        int32_t head = -1;
+        int32_t tail = -1;
+        unsigned count = 0;
+    };
+
+    size_t
+    home(Addr line_addr) const
+    {
+        return (line_addr * 0x9e3779b97f4a7c15ULL) >> (64 - m_slot_bits);
+    }
+
+    int64_t findSlot(Addr line_addr) const;
+    int32_t allocEntry();
+    void eraseSlot(size_t idx);
+    void growSlots();
+
+    //! Entries, a deque so that they do not move when more are added
+    std::deque<Entry> m_entries;
+    int32_t m_free;
+
+    std::vector<Slot> m_slots;
+    unsigned m_slot_bits;
+    size_t m_num_lines = 0;
+    size_t m_size = 0;
+};
+
+inline std::ostream &
+operator<<(std::ostream &out, const SequencerRequestTable &table)
+{
+    table.print(out);
+    return out;
+}
+
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_SYSTEM_SEQUENCERREQUESTTABLE_HH__
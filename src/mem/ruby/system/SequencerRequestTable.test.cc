@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "mem/ruby/system/SequencerRequestTable.hh"
+
+using namespace gem5;
+using namespace gem5::ruby;
+
+namespace
+{
+
+/**
+ * Slot a line hashes to in a table of the given capacity, to build
+ * lines that collide. This mirrors SequencerRequestTable::home().
+ */
+size_t
+homeSlot(Addr line, unsigned capacity)
+{
+    const unsigned bits = ceilLog2(std::max(2 * capacity, 2u));
+    return (line * 0x9e3779b97f4a7c15ULL) >> (64 - bits);
+}
+
+/** The first lines, multiple of 64, hashing to a given slot. */
+std::vector<Addr>
+collidingLines(size_t slot, unsigned capacity, unsigned count)
+{
+    std::vector<Addr> lines;
+    for (Addr line = 0; lines.size() < count; line += 64) {
+        if (homeSlot(line, capacity) == slot)
+            lines.push_back(line);
+    }
+    return lines;
+}
+
+/** Requests are told apart by their issue time. */
+unsigned
+insert(SequencerRequestTable &table, Addr line, uint64_t id)
+{
+    return table.insert(line, nullptr, RubyRequestType_LD,
+                        RubyRequestType_LD, Cycles(id));
+}
+
+uint64_t
+frontId(SequencerRequestTable &table, Addr line)
+{
+    return table.front(line).issue_time;
+}
+
+} // anonymous namespace
+
+/** An empty table holds no line. */
+TEST(SequencerRequestTableTest, Empty)
+{
+    SequencerRequestTable table(4);
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(0, table.size());
+    EXPECT_FALSE(table.contains(0));
+    EXPECT_FALSE(table.contains(0x1000));
+}
+
+/** The requests of a line are kept in the order they were made. */
+TEST(SequencerRequestTableTest, InsertLookupErase)
+{
+    SequencerRequestTable table(4);
+    EXPECT_EQ(1, insert(table, 0x1000, 1));
+    EXPECT_EQ(1, insert(table, 0x2000, 2));
+    EXPECT_EQ(2, insert(table, 0x1000, 3));
+    EXPECT_EQ(3, table.size());
+    EXPECT_FALSE(table.empty());
+
+    EXPECT_TRUE(table.contains(0x1000));
+    EXPECT_TRUE(table.contains(0x2000));
+    EXPECT_FALSE(table.contains(0x3000));
+    EXPECT_EQ(1, frontId(table, 0x1000));
+    EXPECT_EQ(2, frontId(table, 0x2000));
+
+    table.popFront(0x1000);
+    EXPECT_TRUE(table.contains(0x1000));
+    EXPECT_EQ(3, frontId(table, 0x1000));
+
+    table.popFront(0x1000);
+    EXPECT_FALSE(table.contains(0x1000));
+    EXPECT_TRUE(table.contains(0x2000));
+
+    table.popFront(0x2000);
+    EXPECT_TRUE(table.empty());
+    EXPECT_FALSE(table.contains(0x2000));
+
+    // The line can be used again once all its requests are gone
+    EXPECT_EQ(1, insert(table, 0x1000, 4));
+    EXPECT_EQ(4, frontId(table, 0x1000));
+}
+
+/** Requests are visited by line, in the order they were made. */
+TEST(SequencerRequestTableTest, ForEach)
+{
+    SequencerRequestTable table(4);
+    insert(table, 0x1000, 1);
+    insert(table, 0x2000, 2);
+    insert(table, 0x1000, 3);
+
+    std::map<Addr, std::vector<uint64_t>> visited;
+    table.forEach([&](Addr line, unsigned count,
+                      const SequencerRequest &req) {
+        EXPECT_EQ(line == 0x1000 ? 2 : 1, count);
+        visited[line].push_back(req.issue_time);
+    });
+    EXPECT_EQ(std::vector<uint64_t>({1, 3}), visited[0x1000]);
+    EXPECT_EQ(std::vector<uint64_t>({2}), visited[0x2000]);
+}
+
+/**
+ * Lines hashing to the same slot are probed linearly, and erasing one
+ * of them keeps the others reachable.
+ */
+TEST(SequencerRequestTableTest, Collisions)
+{
+    const unsigned capacity = 4;
+    const std::vector<Addr> lines = collidingLines(2, capacity, 3);
+
+    for (int erased = 0; erased < 3; ++erased) {
+        SequencerRequestTable table(capacity);
+        for (int i = 0; i < 3; ++i)
+            insert(table, lines[i], i);
+
+        table.popFront(lines[erased]);
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_EQ(i != erased, table.contains(lines[i]));
+            if (i != erased)
+                EXPECT_EQ(i, frontId(table, lines[i]));
+        }
+    }
+}
+
+/** Probing wraps around the end of the slots. */
+TEST(SequencerRequestTableTest, WrapAround)
+{
+    const unsigned capacity = 4;
+    const size_t last_slot = (1 << ceilLog2(2 * capacity)) - 1;
+    const std::vector<Addr> lines = collidingLines(last_slot, capacity, 3);
+    const std::vector<Addr> first = collidingLines(0, capacity, 1);
+
+    SequencerRequestTable table(capacity);
+    for (int i = 0; i < 3; ++i)
+        insert(table, lines[i], i);
+    // A line homed in the first slot goes after the ones that wrapped
+    insert(table, first[0], 3);
+
+    // Erasing the line in the last slot moves the wrapped lines back
+    table.popFront(lines[0]);
+    EXPECT_FALSE(table.contains(lines[0]));
+    EXPECT_EQ(1, frontId(table, lines[1]));
+    EXPECT_EQ(2, frontId(table, lines[2]));
+    EXPECT_EQ(3, frontId(table, first[0]));
+
+    table.popFront(lines[2]);
+    EXPECT_EQ(1, frontId(table, lines[1]));
+    EXPECT_EQ(3, frontId(table, first[0]));
+    EXPECT_EQ(2, table.size());
+}
+
+/**
+ * The table grows past its capacity, and requests do not move while
+ * other requests are made.
+ */
+TEST(SequencerRequestTableTest, Growth)
+{
+    SequencerRequestTable table(2);
+    insert(table, 0, 0);
+    const SequencerRequest *first = &table.front(0);
+
+    const unsigned num_lines = 100;
+    for (unsigned i = 1; i < num_lines; ++i) {
+        for (unsigned j = 0; j < 3; ++j)
+            EXPECT_EQ(j + 1, insert(table, i * 64, i * 3 + j));
+    }
+    EXPECT_EQ(&table.front(0), first);
+    EXPECT_EQ(0, uint64_t(first->issue_time));
+    EXPECT_EQ(1 + (num_lines - 1) * 3, table.size());
+
+    for (unsigned i = 1; i < num_lines; ++i) {
+        for (unsigned j = 0; j < 3; ++j) {
+            ASSERT_TRUE(table.contains(i * 64));
+            EXPECT_EQ(i * 3 + j, frontId(table, i * 64));
+            table.popFront(i * 64);
+        }
+        EXPECT_FALSE(table.contains(i * 64));
+    }
+    EXPECT_EQ(1, table.size());
+}
+
+/** Random requests and completions match a reference model. */
+TEST(SequencerRequestTableTest, Random)
+{
+    std::mt19937 rng(1);
+    SequencerRequestTable table(16);
+    std::map<Addr, std::deque<uint64_t>> model;
+    size_t size = 0;
+
+    for (uint64_t id = 0; id < 20000; ++id) {
+        const Addr line = (rng() % 64) * 64;
+        if (model.size() < 24 && rng() % 2) {
+            model[line].push_back(id);
+            EXPECT_EQ(model[line].size(), insert(table, line, id));
+            size++;
+        } else if (!model.empty()) {
+            auto it = model.lower_bound(line);
+            if (it == model.end())
+                it = model.begin();
+            ASSERT_TRUE(table.contains(it->first));
+            EXPECT_EQ(it->second.front(), frontId(table, it->first));
+            table.popFront(it->first);
+            it->second.pop_front();
+            if (it->second.empty()) {
+                EXPECT_FALSE(table.contains(it->first));
+                model.erase(it);
+            }
+            size--;
+        }
+        ASSERT_EQ(size, table.size());
+    }
+
+    for (Addr line = 0; line < 64 * 64; line += 64)
+        EXPECT_EQ(model.count(line) != 0, table.contains(line));
+}
@@ -801,6 +801,28 @@ $c_ident::init()
                 event = f"{self.ident}_Event_{trans.event.ident}"
                 code("possibleTransition($state, $event);")
 
+        code(
+            """
+
+TransitionProfiler *transition_profiler =
+    params().ruby_system->getProfiler()->getTransitionProfiler();
+if (transition_profiler) {
+    std::vector<std::string> state_names;
+    for (${ident}_State state = ${ident}_State_FIRST;
+         state < ${ident}_State_NUM; ++state) {
+        state_names.push_back(${ident}_State_to_string(state));
+    }
+    std::vector<std::string> event_names;
+    for (${ident}_Event event = ${ident}_Event_FIRST;
+         event < ${ident}_Event_NUM; ++event) {
+        event_names.push_back(${ident}_Event_to_string(event));
+    }
+    m_transition_sampler = transition_profiler->registerController(
+        name(), m_machineID, state_names, event_names);
+}
+"""
+        )
+
         code.dedent()
         code(
             """
@@ -1492,6 +1514,7 @@ ${ident}_Controller::wakeup()
                 code('m_cur_in_port = ${{port.pairs["rank"]}};')
             else:
                 code("m_cur_in_port = 0;")
+            code("m_cur_in_buf = m_${{port.pairs['buffer_expr'].name}}_ptr;")
             if port in port_to_buf_map:
                 code("try {")
                 code.indent()
@@ -1622,6 +1645,14 @@ DPRINTF(RubyGenerated, "%s, Time: %lld, state: %s, event: %s, addr: %#x\\n",
         *this, curCycle(), ${ident}_State_to_string(state),
         ${ident}_Event_to_string(event), addr);
 
+// The actions may pop the message triggering the transition, so it is
+// noted before the transition is done
+const bool sampled =
+    m_transition_sampler && m_transition_sampler->sample();
+if (sampled) {
+    profileTransitionMessage();
+}
+
 TransitionResult result =
 """
         )
@@ -1645,6 +1676,10 @@ TransitionResult result =
         code(
             """
 
+if (sampled) {
+    profileTransition(state, event, addr, result);
+}
+
 if (result == TransitionResult_Valid) {
     DPRINTF(RubyGenerated, "next_state: %s\\n",
             ${ident}_State_to_string(next_state));
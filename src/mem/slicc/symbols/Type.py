@@ -326,10 +326,63 @@ $klass ${{self.c_ident}}$parent
 MsgPtr
 clone() const
 {
-     return std::shared_ptr<Message>(new ${{self.c_ident}}(*this));
+     return MsgPtr(new ${{self.c_ident}}(*this));
+}
+
+// Messages are allocated from a per-type pool
+static void *
+operator new(size_t size)
+{
+    return MessagePool<${{self.c_ident}}>::allocate(size);
+}
+
+static void
+operator delete(void *ptr, size_t size)
+{
+    MessagePool<${{self.c_ident}}>::release(ptr, size);
 }
 """
             )
+
+            # Expose the machine the message originates from, if any
+            for ident in ("Requestor", "Sender"):
+                dm = self.data_members.get(ident)
+                if (
+                    dm is not None
+                    and "abstract" not in dm
+                    and dm.type.c_ident == "MachineID"
+                ):
+                    code(
+                        """
+bool
+getRequestorMachine(MachineID &requestor) const override
+{
+    requestor = m_${{dm.ident}};
+    return true;
+}
+"""
+                    )
+                    break
+
+            # Expose the line the message refers to, if any
+            for ident in ("addr", "LineAddress"):
+                dm = self.data_members.get(ident)
+                if (
+                    dm is not None
+                    and "abstract" not in dm
+                    and dm.type.c_ident == "Addr"
+                ):
+                    code(
+                        """
+bool
+getAccessedLine(Addr &line_addr) const override
+{
+    line_addr = makeLineAddress(m_${{dm.ident}});
+    return true;
+}
+"""
+                    )
+                    break
         else:
             code(
                 """
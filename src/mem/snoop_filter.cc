@@ -42,6 +42,7 @@
 
 #include "mem/snoop_filter.hh"
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/SnoopFilter.hh"
@@ -52,17 +53,137 @@ namespace gem5
 
 const int SnoopFilter::SNOOP_MASK_SIZE;
 
+SnoopFilter::SnoopFilter(const SnoopFilterParams &p)
+    : SimObject(p), system(p.system),
+      requestorId(p.system->getRequestorId(this)),
+      linesize(p.system->cacheLineSize()),
+      lineShift(floorLog2(p.system->cacheLineSize())),
+      lookupLatency(p.lookup_latency),
+      maxEntryCount(p.max_capacity / p.system->cacheLineSize()),
+      assoc(p.assoc), numSets(maxEntryCount / p.assoc),
+      numValidEntries(0), touchCount(0),
+      stats(this)
+{
+    fatal_if(assoc == 0 || maxEntryCount % assoc != 0,
+             "%s: max_capacity (%d lines) must be a multiple of the "
+             "associativity (%d)\n", name(), maxEntryCount, assoc);
+    fatal_if(!isPowerOf2(numSets),
+             "%s: the number of sets (%d) must be a power of 2\n",
+             name(), numSets);
+
+    table.resize(maxEntryCount);
+}
+
 void
-SnoopFilter::eraseIfNullEntry(SnoopFilterCache::iterator& sf_it)
+SnoopFilter::eraseIfNullEntry(SnoopEntry *sf_entry)
 {
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem& sf_item = sf_entry->item;
     if ((sf_item.requested | sf_item.holder).none()) {
-        cachedLocations.erase(sf_it);
+        sf_entry->valid = false;
+        numValidEntries--;
+        stats.occupancy = numValidEntries;
         DPRINTF(SnoopFilter, "%s:   Removed SF entry.\n",
                 __func__);
     }
 }
 
+SnoopFilter::SnoopEntry *
+SnoopFilter::findEntry(Addr line_addr)
+{
+    SnoopEntry *set = &table[setIndex(line_addr) * assoc];
+    for (unsigned way = 0; way < assoc; ++way) {
+        if (set[way].valid && set[way].lineAddr == line_addr) {
+            return &set[way];
+        }
+    }
+    return nullptr;
+}
+
+SnoopFilter::SnoopEntry *
+SnoopFilter::allocateEntry(Addr line_addr)
+{
+    SnoopEntry *set = &table[setIndex(line_addr) * assoc];
+    while (true) {
+        SnoopEntry *victim = nullptr;
+        for (unsigned way = 0; way < assoc; ++way) {
+            SnoopEntry *entry = &set[way];
+            if (!entry->valid) {
+                victim = entry;
+                break;
+            }
+            // lines with requests in flight cannot be evicted, as the
+            // responses still have to update the tracking information
+            if (entry->item.requested.none() &&
+                (!victim || entry->lastTouch < victim->lastTouch)) {
+                victim = entry;
+            }
+        }
+
+        panic_if(!victim, "%s: all the ways of the set for %#llx have "
+                 "requests in flight, consider increasing the snoop "
+                 "filter capacity\n", name(), line_addr);
+
+        if (!victim->valid) {
+            numValidEntries++;
+            stats.occupancy = numValidEntries;
+
+            victim->lineAddr = line_addr;
+            victim->valid = true;
+            victim->item = SnoopItem();
+            return victim;
+        }
+
+        DPRINTF(SnoopFilter, "%s:   evicting %#llx SF value %x.%x\n",
+                __func__, victim->lineAddr, victim->item.requested,
+                victim->item.holder);
+        stats.capacityEvictions++;
+
+        // stop tracking the victim before back-invalidating it, in
+        // atomic mode the writebacks caused by the back-invalidation
+        // come back through the filter before it returns, and they
+        // may also allocate entries in the set, so look for a free
+        // way again afterwards
+        const Addr victim_addr = victim->lineAddr;
+        const SnoopMask holders = victim->item.holder;
+        victim->valid = false;
+        numValidEntries--;
+        backInvalidate(victim_addr, holders);
+    }
+}
+
+void
+SnoopFilter::backInvalidate(Addr line_addr, SnoopMask holders)
+{
+    SnoopList ports = maskToPortList(holders);
+    if (ports.empty())
+        return;
+
+    Request::Flags flags = Request::CLEAN | Request::INVALIDATE;
+    if (line_addr & LineSecure) {
+        flags.set(Request::SECURE);
+    }
+    RequestPtr req = std::make_shared<Request>(line_addr & ~Addr(LineSecure),
+                                               linesize, flags, requestorId);
+
+    for (const auto& p : ports) {
+        // the holders write back any dirty data, including the data
+        // of pending writebacks, with a WriteClean as part of handling
+        // the snoop, and there is no response to a cache maintenance
+        // snoop from above
+        Packet pkt(req, MemCmd::CleanInvalidReq);
+        stats.backInvalidations++;
+        if (system->isTimingMode()) {
+            pkt.setExpressSnoop();
+            p->sendTimingSnoopReq(&pkt);
+        } else {
+            p->sendAtomicSnoop(&pkt);
+        }
+        if (pkt.satisfied()) {
+            stats.backInvalidationWritebacks++;
+        }
+    }
+}
+
 std::pair<SnoopFilter::SnoopList, Cycles>
 SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
                            cpu_side_port)
@@ -78,21 +199,25 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
         line_addr |= LineSecure;
     }
     SnoopMask req_port = portToMask(cpu_side_port);
-    reqLookupResult.it = cachedLocations.find(line_addr);
-    bool is_hit = (reqLookupResult.it != cachedLocations.end());
+    reqLookupResult.entry = findEntry(line_addr);
+    bool is_hit = (reqLookupResult.entry != nullptr);
 
     // If the snoop filter has no entry, and we should not allocate,
     // do not create a new snoop filter entry, simply return a NULL
     // portlist.
-    if (!is_hit && !allocate)
+    // The same goes for evictions of lines that are not tracked, as
+    // the line may have been back-invalidated while the eviction
+    // was on its way.
+    if (!is_hit && (!allocate || cpkt->isEviction()))
         return snoopDown(lookupLatency);
 
-    // If no hit in snoop filter create a new element and update iterator
+    // If no hit in snoop filter create a new element and update the
+    // lookup result
     if (!is_hit) {
-        reqLookupResult.it =
-            cachedLocations.emplace(line_addr, SnoopItem()).first;
+        reqLookupResult.entry = allocateEntry(line_addr);
     }
-    SnoopItem& sf_item = reqLookupResult.it->second;
+    reqLookupResult.entry->lastTouch = ++touchCount;
+    SnoopItem& sf_item = reqLookupResult.entry->item;
     SnoopMask interested = sf_item.holder | sf_item.requested;
 
     // Store unmodified value of snoop filter item in temp storage in
@@ -159,10 +284,10 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
 void
 SnoopFilter::finishRequest(bool will_retry, Addr addr, bool is_secure)
 {
-    if (reqLookupResult.it != cachedLocations.end()) {
+    if (reqLookupResult.entry) {
         // since we rely on the caller, do a basic check to ensure
         // that finishRequest is being called following lookupRequest
-        assert(reqLookupResult.it->first == \
+        assert(reqLookupResult.entry->lineAddr == \
                 (is_secure ? ((addr & ~(Addr(linesize - 1))) | LineSecure) : \
                  (addr & ~(Addr(linesize - 1)))));
         if (will_retry) {
@@ -170,13 +295,14 @@ SnoopFilter::finishRequest(bool will_retry, Addr addr, bool is_secure)
             // Undo any changes made in lookupRequest to the snoop filter
             // entry if the request will come again. retryItem holds
             // the previous value of the snoopfilter entry.
-            reqLookupResult.it->second = retry_item;
+            reqLookupResult.entry->item = retry_item;
 
             DPRINTF(SnoopFilter, "%s:   restored SF value %x.%x\n",
                     __func__,  retry_item.requested, retry_item.holder);
         }
 
-        eraseIfNullEntry(reqLookupResult.it);
+        eraseIfNullEntry(reqLookupResult.entry);
+        reqLookupResult.entry = nullptr;
     }
 }
 
@@ -191,12 +317,8 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    bool is_hit = (sf_it != cachedLocations.end());
-
-    panic_if(!is_hit && (cachedLocations.size() >= maxEntryCount),
-             "snoop filter exceeded capacity of %d cache blocks\n",
-             maxEntryCount);
+    SnoopEntry *sf_entry = findEntry(line_addr);
+    bool is_hit = (sf_entry != nullptr);
 
     // If the snoop filter has no entry, simply return a NULL
     // portlist, there is no point creating an entry only to remove it
@@ -204,7 +326,7 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
     if (!is_hit)
         return snoopDown(lookupLatency);
 
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem& sf_item = sf_entry->item;
 
     SnoopMask interested = (sf_item.holder | sf_item.requested);
 
@@ -234,7 +356,7 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
         sf_item.holder = 0;
         DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(sf_entry);
     }
 
     return snoopSelected(maskToPortList(interested), lookupLatency);
@@ -264,7 +386,9 @@ SnoopFilter::updateSnoopResponse(const Packet* cpkt,
     }
     SnoopMask rsp_mask = portToMask(rsp_port);
     SnoopMask req_mask = portToMask(req_port);
-    SnoopItem& sf_item = cachedLocations[line_addr];
+    SnoopEntry *sf_entry = findEntry(line_addr);
+    panic_if(!sf_entry, "SF has no entry for %#llx\n", line_addr);
+    SnoopItem& sf_item = sf_entry->item;
 
     DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
             __func__,  sf_item.requested, sf_item.holder);
@@ -311,18 +435,17 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    bool is_hit = sf_it != cachedLocations.end();
+    SnoopEntry *sf_entry = findEntry(line_addr);
 
     // Nothing to do if it is not a hit
-    if (!is_hit)
+    if (!sf_entry)
         return;
 
     // If the snoop response has no sharers the line is passed in
     // Modified state, and we know that there are no other copies, or
     // they will all be invalidated imminently
     if (!cpkt->hasSharers()) {
-        SnoopItem& sf_item = sf_it->second;
+        SnoopItem& sf_item = sf_entry->item;
 
         DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
@@ -330,7 +453,7 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
         DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
 
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(sf_entry);
     }
 }
 
@@ -353,12 +476,12 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
     if (cpkt->isSecure()) {
         line_addr |= LineSecure;
     }
-    auto sf_it = cachedLocations.find(line_addr);
-    if (sf_it == cachedLocations.end())
+    SnoopEntry *sf_entry = findEntry(line_addr);
+    if (!sf_entry)
         return;
 
     SnoopMask response_mask = portToMask(cpu_side_port);
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem& sf_item = sf_entry->item;
 
     DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
             __func__,  sf_item.requested, sf_item.holder);
@@ -377,7 +500,7 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
         if (cpkt->isInvalidate()) {
             sf_item.holder &= ~response_mask;
         }
-        eraseIfNullEntry(sf_it);
+        eraseIfNullEntry(sf_entry);
     } else {
         // Any other response implies that a cache above will have the
         // block.
@@ -405,7 +528,18 @@ SnoopFilter::SnoopFilterStats::SnoopFilterStats(statistics::Group *parent)
                "holder of the requested data."),
       ADD_STAT(hitMultiSnoops, statistics::units::Count::get(),
                "Number of snoops hitting in the snoop filter with multiple "
-               "(>1) holders of the requested data.")
+               "(>1) holders of the requested data."),
+      ADD_STAT(occupancy, statistics::units::Count::get(),
+               "Average number of lines tracked by the snoop filter."),
+      ADD_STAT(capacityEvictions, statistics::units::Count::get(),
+               "Number of lines evicted from the snoop filter to make room "
+               "for new ones."),
+      ADD_STAT(backInvalidations, statistics::units::Count::get(),
+               "Number of back-invalidation snoops sent to the holders of "
+               "evicted lines."),
+      ADD_STAT(backInvalidationWritebacks, statistics::units::Count::get(),
+               "Number of back-invalidation snoops that caused a dirty "
+               "line to be written back.")
 {}
 
 void
@@ -44,8 +44,8 @@
 #define __MEM_SNOOP_FILTER_HH__
 
 #include <bitset>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "mem/packet.hh"
 #include "mem/port.hh"
@@ -76,6 +76,13 @@ namespace gem5
  * | holder) should be notified and the requesting MSHRs will take
  * care of ordering.
  *
+ * The tracking information is kept in a set-associative table of a
+ * fixed size. When a new line has to be tracked and its set is full,
+ * the least recently used entry without outstanding requests is
+ * evicted, and the caches that hold the evicted line are sent a
+ * back-invalidation (a clean and invalidate snoop) so that the
+ * filter keeps an inclusive view of the caches above it.
+ *
  * Overall, some trickery is required because:
  * (1) snoops are not followed by an ACK, but only evoke a response if
  *     they need to (hit dirty)
@@ -95,13 +102,7 @@ class SnoopFilter : public SimObject
 
     typedef std::vector<QueuedResponsePort*> SnoopList;
 
-    SnoopFilter (const SnoopFilterParams &p) :
-        SimObject(p), reqLookupResult(cachedLocations.end()),
-        linesize(p.system->cacheLineSize()), lookupLatency(p.lookup_latency),
-        maxEntryCount(p.max_capacity / p.system->cacheLineSize()),
-        stats(this)
-    {
-    }
+    SnoopFilter(const SnoopFilterParams &p);
 
     /**
      * Init a new snoop filter and tell it about all the cpu_sideports
@@ -200,6 +201,20 @@ class SnoopFilter : public SimObject
      */
     void updateResponse(const Packet *cpkt, const ResponsePort& cpu_side_port);
 
+    /**
+     * Check if a snoop response belongs to a back-invalidation sent
+     * by this snoop filter. Such responses have no requestor waiting
+     * for them and should be sunk by the crossbar.
+     *
+     * @param cpkt Pointer to const Packet holding the snoop response.
+     * @return True if the response is for a back-invalidation.
+     */
+    bool
+    isBackInvalidation(const Packet *cpkt) const
+    {
+        return cpkt->req->requestorId() == requestorId;
+    }
+
     virtual void regStats();
 
   protected:
@@ -220,10 +235,22 @@ class SnoopFilter : public SimObject
         SnoopMask requested;
         SnoopMask holder;
     };
+
     /**
-     * HashMap of SnoopItems indexed by line address
+     * Entry of the snoop filter table, tagged with the line address
+     * (including the LineSecure bit).
      */
-    typedef std::unordered_map<Addr, SnoopItem> SnoopFilterCache;
+    struct SnoopEntry
+    {
+        /** Line address of the tracked line, valid only if valid */
+        Addr lineAddr = 0;
+        /** Whether the entry tracks a line */
+        bool valid = false;
+        /** Last access, used to pick a victim on capacity evictions */
+        uint64_t lastTouch = 0;
+        /** Tracking information of the line */
+        SnoopItem item;
+    };
 
     /**
      * Simple factory methods for standard return values.
@@ -261,10 +288,51 @@ class SnoopFilter : public SimObject
     /**
      * Removes snoop filter items which have no requestors and no holders.
      */
-    void eraseIfNullEntry(SnoopFilterCache::iterator& sf_it);
+    void eraseIfNullEntry(SnoopEntry *sf_entry);
+
+    /**
+     * Find the table entry tracking a line.
+     *
+     * @param line_addr Line address, including the LineSecure bit.
+     * @return The matching entry, nullptr if the line is not tracked.
+     */
+    SnoopEntry *findEntry(Addr line_addr);
+
+    /**
+     * Allocate a table entry for a line that is not tracked yet. If
+     * the set of the line is full, the least recently used entry
+     * without outstanding requests is evicted, and its holders
+     * back-invalidated.
+     *
+     * @param line_addr Line address, including the LineSecure bit.
+     * @return The newly allocated entry.
+     */
+    SnoopEntry *allocateEntry(Addr line_addr);
 
-    /** Simple hash set of cached addresses. */
-    SnoopFilterCache cachedLocations;
+    /**
+     * Invalidate all the copies of a line held in the caches above,
+     * by sending them a clean and invalidate snoop. Dirty copies are
+     * written back to the level below as part of the snoop.
+     *
+     * @param line_addr Line address, including the LineSecure bit.
+     * @param holders Ports that hold a copy of the line.
+     */
+    void backInvalidate(Addr line_addr, SnoopMask holders);
+
+    /**
+     * Set of a line in the table.
+     */
+    unsigned
+    setIndex(Addr line_addr) const
+    {
+        return (line_addr >> lineShift) & (numSets - 1);
+    }
+
+    /**
+     * The snoop filter table, with the ways of a set next to each
+     * other.
+     */
+    std::vector<SnoopEntry> table;
 
     /**
      * A request lookup must be followed by a call to finishRequest to inform
@@ -274,8 +342,8 @@ class SnoopFilter : public SimObject
      */
     struct ReqLookupResult
     {
-        /** Iterator used to store the result from lookupRequest. */
-        SnoopFilterCache::iterator it;
+        /** Entry used to store the result from lookupRequest. */
+        SnoopEntry *entry;
 
         /**
          * Variable to temporarily store value of snoopfilter entry
@@ -284,29 +352,36 @@ class SnoopFilter : public SimObject
          */
         SnoopItem retryItem;
 
-        /**
-         * The constructor must be informed of the internal cache's end
-         * iterator, so do not allow the compiler to implictly define it.
-         *
-         * @param end_it Iterator to the end of the internal cache.
-         */
-        ReqLookupResult(SnoopFilterCache::iterator end_it)
-            : it(end_it), retryItem{0, 0}
+        ReqLookupResult()
+            : entry(nullptr), retryItem{0, 0}
         {
         }
-        ReqLookupResult() = delete;
     } reqLookupResult;
 
     /** List of all attached snooping CPU-side ports. */
     SnoopList cpuSidePorts;
     /** Track the mapping from port ids to the local mask ids. */
     std::vector<PortID> localResponsePortIds;
+    /** System we are part of, used to know the memory mode. */
+    System *system;
+    /** Requestor id used for back-invalidation snoops. */
+    const RequestorID requestorId;
     /** Cache line size. */
     const Addr linesize;
+    /** Log2 of the cache line size. */
+    const unsigned lineShift;
     /** Latency for doing a lookup in the filter */
     const Cycles lookupLatency;
-    /** Max capacity in terms of cache blocks tracked, for sanity checking */
+    /** Max capacity in terms of cache blocks tracked */
     const unsigned maxEntryCount;
+    /** Associativity of the table */
+    const unsigned assoc;
+    /** Number of sets in the table */
+    const unsigned numSets;
+    /** Number of valid entries in the table */
+    unsigned numValidEntries;
+    /** Counter providing the recency of accesses to the table */
+    uint64_t touchCount;
 
     /**
      * Use the lower bits of the address to keep track of the line status
@@ -329,6 +404,11 @@ class SnoopFilter : public SimObject
         statistics::Scalar totSnoops;
         statistics::Scalar hitSingleSnoops;
         statistics::Scalar hitMultiSnoops;
+
+        statistics::Average occupancy;
+        statistics::Scalar capacityEvictions;
+        statistics::Scalar backInvalidations;
+        statistics::Scalar backInvalidationWritebacks;
     } stats;
 };
 
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/trace_window.hh"
+
+#include <algorithm>
+
+#include "base/debug.hh"
+#include "base/logging.hh"
+#include "mem/request.hh"
+
+namespace gem5
+{
+
+bool TraceWindow::_active = false;
+uint32_t TraceWindow::generation = 1;
+unsigned TraceWindow::depth = 0;
+AddrRangeList TraceWindow::ranges;
+std::vector<RequestorID> TraceWindow::requestors;
+bool TraceWindow::hasPCRange = false;
+Addr TraceWindow::pcStart = 0;
+Addr TraceWindow::pcEnd = 0;
+ObjectMatch TraceWindow::objects;
+
+void
+TraceWindow::update()
+{
+    panic_if(depth != 0,
+             "Trace window predicates changed while it is open.\n");
+
+    ++generation;
+    _active = !ranges.empty() || !requestors.empty() || hasPCRange ||
+        !objects.empty();
+
+    if (_active)
+        debug::Flag::windowClose();
+    else
+        debug::Flag::windowOpen();
+}
+
+void
+TraceWindow::addRange(const AddrRange &range)
+{
+    ranges.push_back(range);
+    update();
+}
+
+void
+TraceWindow::addRequestor(RequestorID id)
+{
+    requestors.push_back(id);
+    update();
+}
+
+void
+TraceWindow::setPCRange(Addr start, Addr end)
+{
+    fatal_if(start >= end, "Empty trace window PC range [%#x, %#x).\n",
+             start, end);
+    hasPCRange = true;
+    pcStart = start;
+    pcEnd = end;
+    update();
+}
+
+void
+TraceWindow::addObject(const std::string &expr)
+{
+    objects.add(ObjectMatch(expr));
+    update();
+}
+
+void
+TraceWindow::clear()
+{
+    ranges.clear();
+    requestors.clear();
+    hasPCRange = false;
+    objects = ObjectMatch();
+    update();
+}
+
+bool
+TraceWindow::matches(const Port &port, const Packet *pkt)
+{
+    if (!objects.empty()) {
+        if (port.traceWindowGeneration != generation) {
+            port.traceWindowMatch = objects.match(port.name());
+            port.traceWindowGeneration = generation;
+        }
+        if (!port.traceWindowMatch)
+            return false;
+    }
+
+    if (!ranges.empty()) {
+        // Packets without an address, e.g., memory synchronization
+        // requests, cannot overlap any range
+        if (!pkt->hasAddr() || !pkt->hasSize())
+            return false;
+
+        const AddrRange accessed = pkt->getAddrRange();
+        if (std::none_of(ranges.begin(), ranges.end(),
+                         [&accessed](const AddrRange &range) {
+                             return range.intersects(accessed);
+                         })) {
+            return false;
+        }
+    }
+
+    const RequestPtr &req = pkt->req;
+    if (!requestors.empty()) {
+        if (std::find(requestors.begin(), requestors.end(),
+                      req->requestorId()) == requestors.end()) {
+            return false;
+        }
+    }
+
+    if (hasPCRange) {
+        if (!req->hasPC() || req->getPC() < pcStart || req->getPC() >= pcEnd)
+            return false;
+    }
+
+    return true;
+}
+
+void
+TraceWindow::open(const Port &port, const Packet *pkt, bool &opened)
+{
+    // Nested accesses, e.g., atomic accesses going down the hierarchy,
+    // only need to be matched while the window is closed
+    if (depth == 0 && !matches(port, pkt))
+        return;
+
+    if (depth++ == 0)
+        debug::Flag::windowOpen();
+    opened = true;
+}
+
+void
+TraceWindow::close()
+{
+    if (--depth == 0)
+        debug::Flag::windowClose();
+}
+
+} // namespace gem5
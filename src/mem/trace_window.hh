@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Restriction of debug tracing to a window of memory accesses.
+ */
+
+#ifndef __MEM_TRACE_WINDOW_HH__
+#define __MEM_TRACE_WINDOW_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/addr_range.hh"
+#include "base/compiler.hh"
+#include "base/match.hh"
+#include "base/types.hh"
+#include "mem/packet.hh"
+#include "sim/port.hh"
+
+namespace gem5
+{
+
+/**
+ * Restricts debug tracing to the handling of the memory accesses that
+ * match a set of predicates: address ranges, requestor IDs, a PC range
+ * and expressions on the name of the port receiving the access. Each
+ * predicate that is set must match. Once a predicate is set, the trace
+ * window is closed, so no debug flag is tracing, and it is only opened
+ * while a matching access is being received by a port.
+ *
+ * The window is flipped by updating the debug flags, so that DPRINTF
+ * still checks a single flag outside of it. The object expressions
+ * are evaluated once per port and cached until the predicates change.
+ * The tick window is set separately, through the global enabling of
+ * the debug flags.
+ */
+class TraceWindow
+{
+  private:
+    /** Whether any predicate is set. */
+    static bool _active;
+
+    /** Changed along with the predicates, to invalidate port matches. */
+    static uint32_t generation;
+
+    /** Number of nested accesses the window is open for. */
+    static unsigned depth;
+
+    static AddrRangeList ranges;
+    static std::vector<RequestorID> requestors;
+    static bool hasPCRange;
+    static Addr pcStart;
+    static Addr pcEnd;
+    static ObjectMatch objects;
+
+    /** Update the window once the predicates have changed. */
+    static void update();
+
+    static bool matches(const Port &port, const Packet *pkt);
+
+    static void open(const Port &port, const Packet *pkt, bool &opened);
+    static void close();
+
+  public:
+    /** Trace the accesses that overlap a range. */
+    static void addRange(const AddrRange &range);
+
+    /** Trace the accesses made by a requestor. */
+    static void addRequestor(RequestorID id);
+
+    /** Trace the accesses made by instructions in [start, end). */
+    static void setPCRange(Addr start, Addr end);
+
+    /** Trace the accesses received by the ports matching an expression. */
+    static void addObject(const std::string &expr);
+
+    /** Remove all the predicates, tracing everything again. */
+    static void clear();
+
+    static bool active() { return _active; }
+
+    /**
+     * Keeps the window open for the lifetime of the scope if the
+     * access matches the predicates, to be created around the call
+     * to the receive function of a port.
+     */
+    class Scope
+    {
+      private:
+        bool opened = false;
+
+      public:
+        Scope(const Port &port, const Packet *pkt)
+        {
+            if (GEM5_UNLIKELY(_active))
+                open(port, pkt, opened);
+        }
+
+        ~Scope()
+        {
+            if (GEM5_UNLIKELY(opened))
+                close();
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+};
+
+} // namespace gem5
+
+#endif // __MEM_TRACE_WINDOW_HH__
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "base/debug.hh"
+#include "base/gtest/cur_tick_fake.hh"
+#include "mem/packet.hh"
+#include "mem/request.hh"
+#include "mem/trace_window.hh"
+#include "sim/port.hh"
+
+using namespace gem5;
+
+// Requests are time stamped with curTick()
+GTestTickHandler tickHandler;
+
+namespace
+{
+
+class TestPort : public Port
+{
+  public:
+    TestPort(const std::string &name) : Port(name, InvalidPortID) {}
+};
+
+debug::SimpleFlag flag("TraceWindowTest", "");
+
+/** Enables the test flag and clears the predicates after each test. */
+class TraceWindowTest : public testing::Test
+{
+  protected:
+    TestPort port{"system.cpu.dcache_port"};
+
+    void
+    SetUp() override
+    {
+        debug::Flag::globalEnable();
+        flag.enable();
+    }
+
+    void
+    TearDown() override
+    {
+        TraceWindow::clear();
+        flag.disable();
+        debug::Flag::globalDisable();
+    }
+
+    /** Is the window open while the port receives the packet? */
+    bool
+    traced(const Port &p, const PacketPtr pkt)
+    {
+        TraceWindow::Scope scope(p, pkt);
+        return flag.tracing();
+    }
+
+    bool traced(const PacketPtr pkt) { return traced(port, pkt); }
+};
+
+PacketPtr
+makePacket(Addr addr, unsigned size, RequestorID id, MemCmd cmd)
+{
+    auto req = std::make_shared<Request>(addr, size, 0, id);
+    return new Packet(req, cmd);
+}
+
+PacketPtr
+makePCPacket(Addr addr, Addr pc)
+{
+    auto req = std::make_shared<Request>(addr, 8, 0, 0, pc, 0);
+    req->setPaddr(addr);
+    return new Packet(req, MemCmd::ReadReq);
+}
+
+} // anonymous namespace
+
+/** Without predicates, every access is traced. */
+TEST_F(TraceWindowTest, Inactive)
+{
+    if (!TRACING_ON)
+        GTEST_SKIP();
+
+    EXPECT_FALSE(TraceWindow::active());
+    std::unique_ptr<Packet> pkt(makePacket(0x1000, 8, 0, MemCmd::ReadReq));
+    EXPECT_TRUE(traced(pkt.get()));
+    EXPECT_TRUE(flag.tracing());
+}
+
+/** Only the accesses overlapping a range are traced. */
+TEST_F(TraceWindowTest, Range)
+{
+    if (!TRACING_ON)
+        GTEST_SKIP();
+
+    TraceWindow::addRange(AddrRange(0x1000, 0x2000));
+    EXPECT_TRUE(TraceWindow::active());
+    EXPECT_FALSE(flag.tracing());
+
+    std::unique_ptr<Packet> inside(makePacket(0x1800, 8, 0, MemCmd::ReadReq));
+    std::unique_ptr<Packet> overlap(makePacket(0xffc, 8, 0, MemCmd::ReadReq));
+    std::unique_ptr<Packet> outside(makePacket(0x2000, 8, 0,
+                                               MemCmd::ReadReq));
+    EXPECT_TRUE(traced(inside.get()));
+    EXPECT_TRUE(traced(overlap.get()));
+    EXPECT_FALSE(traced(outside.get()));
+
+    // The window closes once the access is handled
+    EXPECT_FALSE(flag.tracing());
+}
+
+/** Accesses without an address never match a range. */
+TEST_F(TraceWindowTest, RangeNoAddress)
+{
+    if (!TRACING_ON)
+        GTEST_SKIP();
+
+    TraceWindow::addRange(AddrRange(0, 0x2000));
+
+    // A memory synchronization request only has a virtual address
+    auto req = std::make_shared<Request>(0, 0, 0, 0, 0, 0);
+    Packet sync(req, MemCmd::MemSyncReq);
+    ASSERT_FALSE(sync.hasAddr());
+    EXPECT_FALSE(traced(&sync));
+
+    // Without a range, the access can match the other predicates
+    TraceWindow::clear();
+    TraceWindow::addRequestor(0);
+    EXPECT_TRUE(traced(&sync));
+}
+
+/** Only the accesses of the given requestors are traced. */
+TEST_F(TraceWindowTest, Requestor)
+{
+    if (!TRACING_ON)
+        GTEST_SKIP();
+
+    TraceWindow::addRequestor(3);
+    TraceWindow::addRequestor(5);
+
+    std::unique_ptr<Packet> a(makePacket(0x1000, 8, 3, MemCmd::ReadReq));
+    std::unique_ptr<Packet> b(makePacket(0x1000, 8, 4, MemCmd::ReadReq));
+    std::unique_ptr<Packet> c(makePacket(0x1000, 8, 5, MemCmd::WriteReq));
+    EXPECT_TRUE(traced(a.get()));
+    EXPECT_FALSE(traced(b.get()));
+    EXPECT_TRUE(traced(c.get()));
+}
+
+/** Only the accesses made by instructions in the PC range are traced. */
+TEST_F(TraceWindowTest, PCRange)
+{
+    if (!TRACING_ON)
+        GTEST_SKIP();
+
+    TraceWindow::setPCRange(0x400000, 0x400100);
+
+    std::unique_ptr<Packet> in(makePCPacket(0x1000, 0x4000fc));
+    std::unique_ptr<Packet> out(makePCPacket(0x1000, 0x400100));
+    std::unique_ptr<Packet> no_pc(makePacket(0x1000, 8, 0, MemCmd::ReadReq));
+    EXPECT_TRUE(traced(in.get()));
+    EXPECT_FALSE(traced(out.get()));
+    EXPECT_FALSE(traced(no_pc.get()));
+}
+
+/** Only the accesses received by the matching ports are traced. */
+TEST_F(TraceWindowTest, Object)
+{
+    if (!TRACING_ON)
+        GTEST_SKIP();
+
+    TraceWindow::addObject("system.cpu");
+    TestPort other("system.mem_ctrl.port");
+
+    std::unique_ptr<Packet> pkt(makePacket(0x1000, 8, 0, MemCmd::ReadReq));
+    EXPECT_TRUE(traced(pkt.get()));
+    EXPECT_FALSE(traced(other, pkt.get()));
+}
+
+/** Every predicate set must match. */
+TEST_F(TraceWindowTest, AllPredicates)
+{
+    if (!TRACING_ON)
+        GTEST_SKIP();
+
+    TraceWindow::addRange(AddrRange(0x1000, 0x2000));
+    TraceWindow::addRequestor(1);
+
+    std::unique_ptr<Packet> both(makePacket(0x1000, 8, 1, MemCmd::ReadReq));
+    std::unique_ptr<Packet> range(makePacket(0x1000, 8, 2, MemCmd::ReadReq));
+    std::unique_ptr<Packet> id(makePacket(0x3000, 8, 1, MemCmd::ReadReq));
+    EXPECT_TRUE(traced(both.get()));
+    EXPECT_FALSE(traced(range.get()));
+    EXPECT_FALSE(traced(id.get()));
+}
+
+/** Nested accesses keep the window open until the outermost ends. */
+TEST_F(TraceWindowTest, Nested)
+{
+    if (!TRACING_ON)
+        GTEST_SKIP();
+
+    TraceWindow::addRequestor(1);
+    TestPort downstream("system.membus.port");
+
+    std::unique_ptr<Packet> outer(makePacket(0x1000, 8, 1, MemCmd::ReadReq));
+    std::unique_ptr<Packet> inner(makePacket(0x1000, 8, 2, MemCmd::ReadReq));
+    {
+        TraceWindow::Scope scope(port, outer.get());
+        EXPECT_TRUE(flag.tracing());
+        // The inner access does not match, but is handled on behalf
+        // of the outer one
+        EXPECT_TRUE(traced(downstream, inner.get()));
+        EXPECT_TRUE(flag.tracing());
+    }
+    EXPECT_FALSE(flag.tracing());
+}
@@ -0,0 +1,172 @@
+# Copyright (c) 2024 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Cache of resolved SimObject configurations.
+
+Instantiating a large configuration is dominated by the resolution of
+the SimObject params in Python and their conversion to the C++ param
+structs. Runs of a parameter sweep frequently instantiate the very same
+configuration, so the resolved configuration, in the config.ini format,
+is kept in a cache directory keyed by everything the configuration
+script depends on: the gem5 build, the script, its arguments and the
+source of the Python modules it loaded. On a hit the proxies and params are
+not resolved in Python at all. The C++ SimObjects are built directly
+from the cached file by the C++ configuration manager, and attached to
+the Python SimObjects, which are then initialized as usual.
+
+Building from the cache requires gem5 to be built with C++
+configuration support (scons --with-cxx-config). Configurations which
+depend on anything else, e.g. environment variables or the contents of
+data files, must not be cached, or the cache must be cleared when these
+change.
+"""
+
+import hashlib
+import importlib.util
+import io
+import os
+import sys
+import tempfile
+
+import _m5.core
+from m5.util import (
+    fatal,
+    inform,
+    warn,
+)
+
+_config_name = "config.ini"
+
+
+def _main_script(options):
+    """Source of the configuration script. The script is run in a scope
+    of its own, so it is not found in sys.modules: it is the file given
+    on the command line, the -c string or the -m module."""
+
+    if options.c:
+        return options.c[0].encode()
+
+    if options.m:
+        spec = importlib.util.find_spec(options.m[0])
+        path = spec.origin if spec else None
+    else:
+        path = sys.argv[0]
+
+    # Modules embedded in gem5 are covered by the build
+    if not path or not os.path.isfile(path):
+        return b""
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def _cache_key(options):
+    """Hash of the gem5 build, the configuration script, its arguments
+    and the source of the Python modules it loaded"""
+
+    key = hashlib.sha256()
+    key.update(_m5.core.gem5Version.encode())
+    key.update(_m5.core.compileDate.encode())
+    key.update(hashlib.sha256(_main_script(options)).digest())
+    for arg in sys.argv:
+        key.update(arg.encode() + b"\0")
+
+    # Modules embedded in gem5 are covered by the build, and the ones of
+    # the Python installation are not expected to change
+    prefixes = tuple({sys.prefix, sys.base_prefix})
+    for name, module in sorted(sys.modules.items()):
+        path = getattr(module, "__file__", None)
+        if not path or path.startswith(prefixes) or not os.path.isfile(path):
+            continue
+        key.update(path.encode() + b"\0")
+        with open(path, "rb") as f:
+            key.update(hashlib.sha256(f.read()).digest())
+
+    return key.hexdigest()
+
+
+class InstantiationCache:
+    """Entry of the instantiation cache for the current configuration"""
+
+    def __init__(self, cache_dir, options):
+        self.available = _m5.core.cxxConfigAvailable()
+        if not self.available:
+            warn(
+                "gem5 was built without C++ configuration support "
+                "(--with-cxx-config), the instantiation cache is disabled."
+            )
+            return
+
+        self.key = _cache_key(options)
+        self.path = os.path.join(cache_dir, self.key, _config_name)
+
+    def hit(self):
+        return self.available and os.path.isfile(self.path)
+
+    def store(self, config):
+        """Store the resolved configuration. The file is written under a
+        temporary name and renamed, so that concurrent runs of a sweep
+        never see a partial entry."""
+
+        if not self.available:
+            return
+
+        entry_dir = os.path.dirname(self.path)
+        os.makedirs(entry_dir, exist_ok=True)
+        fd, tmp_path = tempfile.mkstemp(dir=entry_dir, suffix=".tmp")
+        with os.fdopen(fd, "w") as f:
+            f.write(config)
+        os.replace(tmp_path, self.path)
+        inform(f"Stored instantiation cache entry {self.key}")
+
+    def load(self):
+        with open(self.path) as f:
+            return f.read()
+
+    def createCCObjects(self, root):
+        """Build the C++ SimObjects from the cached configuration and
+        attach them to the Python SimObjects"""
+
+        inform(f"Instantiating from cache entry {self.key}")
+        cc_objects = _m5.core.instantiateFromConfig(self.path)
+        for obj in root.descendants():
+            cc_object = cc_objects.get(obj.path())
+            if cc_object is None:
+                fatal(
+                    f"{obj.path()} is not in instantiation cache entry "
+                    f"{self.key}, remove it from the cache."
+                )
+            obj._ccObject = cc_object
+
+
+def resolvedConfig(root):
+    """The resolved configuration of the SimObjects in the config.ini
+    format. The params must have been unproxied."""
+
+    ini = io.StringIO()
+    # Print ini sections in sorted order for easier diffing
+    for obj in sorted(root.descendants(), key=lambda o: o.path()):
+        obj.print_ini(ini)
+    return ini.getvalue()
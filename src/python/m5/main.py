@@ -227,6 +227,53 @@ def parse_options():
         default="stats.txt",
         help="Sets the output file for statistics [Default: %default]",
     )
+    option(
+        "--stats-filter",
+        metavar="GLOB[,GLOB]",
+        action="append",
+        split=",",
+        help="Only dump the stats matching one of the globs, "
+        "a !GLOB excludes the stats it matches",
+    )
+    option(
+        "--stats-threads",
+        metavar="N",
+        type="int",
+        default=1,
+        help="Number of threads formatting text stat dumps "
+        "[Default: %default]",
+    )
+    option(
+        "--stats-publish",
+        metavar="PATH",
+        default="",
+        help="Publish stat snapshots while simulating to the clients of "
+        "the Unix socket PATH in the output directory",
+    )
+    option(
+        "--stats-publish-filter",
+        metavar="GLOB[,GLOB]",
+        action="append",
+        split=",",
+        help="Only publish the stats matching one of the globs, "
+        "a !GLOB excludes the stats it matches",
+    )
+    option(
+        "--stats-publish-ticks",
+        metavar="TICKS",
+        type="int",
+        default=0,
+        help="Simulated ticks between stat snapshots, 0 to disable "
+        "[Default: %default]",
+    )
+    option(
+        "--stats-publish-seconds",
+        metavar="SECONDS",
+        type="float",
+        default=1.0,
+        help="Host seconds between stat snapshots, 0 to disable "
+        "[Default: %default]",
+    )
     option(
         "--stats-help",
         action="callback",
@@ -261,6 +308,15 @@ def parse_options():
         help="Create DOT & pdf outputs of the DVFS configuration"
         + " [Default: %default]",
     )
+    option(
+        "--instantiate-cache",
+        metavar="DIR",
+        default="",
+        help="Cache the resolved configuration in DIR and instantiate "
+        "repeated runs of the same configuration from it; needs a build "
+        "with --with-cxx-config, and skips the JSON and DOT outputs on a "
+        "hit [Default: disabled]",
+    )
 
     # Debugging options
     group("Debugging Options")
@@ -301,6 +357,52 @@ def parse_options():
         help="Sets the output file for debug. Append '.gz' to the name for it"
         " to be compressed automatically [Default: %default]",
     )
+    option(
+        "--debug-format",
+        metavar="{text,binary}",
+        default="text",
+        choices=["text", "binary"],
+        help="Format of the debug output. A binary output records the raw"
+        " message arguments, which is much faster than formatting them, and"
+        " is turned into text with --debug-decode [Default: %default]",
+    )
+    option(
+        "--debug-decode",
+        metavar="FILE",
+        default=None,
+        help="Decode the binary debug output FILE to the debug output file"
+        " and exit",
+    )
+    option(
+        "--debug-window-addr",
+        metavar="RANGE[,RANGE]",
+        action="append",
+        split=",",
+        help="Only trace the handling of accesses to RANGE, given as"
+        " START:END or START+SIZE",
+    )
+    option(
+        "--debug-window-requestor",
+        metavar="ID[,ID]",
+        action="append",
+        split=",",
+        help="Only trace the handling of accesses made by requestor ID",
+    )
+    option(
+        "--debug-window-pc",
+        metavar="RANGE",
+        default=None,
+        help="Only trace the handling of accesses made by instructions in"
+        " RANGE, given as START:END or START+SIZE",
+    )
+    option(
+        "--debug-window-object",
+        metavar="EXPR[,EXPR]",
+        action="append",
+        split=",",
+        help="Only trace the handling of accesses received by EXPR sim"
+        " objects",
+    )
     option(
         "--debug-activate",
         metavar="EXPR[,EXPR]",
@@ -542,7 +644,7 @@ def main():
         print()
 
     # check to make sure we can find the listed script
-    if not (options.c or options.m) and (
+    if not (options.c or options.m or options.debug_decode) and (
         not arguments or not os.path.isfile(arguments[0])
     ):
         if arguments and not os.path.isfile(arguments[0]):
@@ -558,6 +660,16 @@ def main():
 
     # set stats options
     stats.addStatVisitor(options.stats_file)
+    if options.stats_filter:
+        stats.setDumpFilter(options.stats_filter)
+    stats.setDumpThreads(options.stats_threads)
+    if options.stats_publish:
+        stats.publish(
+            options.stats_publish,
+            stats=options.stats_publish_filter,
+            period=options.stats_publish_ticks,
+            host_period=options.stats_publish_seconds,
+        )
 
     # Disable listeners unless running interactively or explicitly
     # enabled
@@ -610,7 +722,10 @@ def main():
         e = event.create(trace.disable, event.Event.Debug_Enable_Pri)
         event.mainq.schedule(e, options.debug_end)
 
-    trace.output(options.debug_file)
+    if options.debug_format == "binary" and not options.debug_decode:
+        trace.outputBinary(options.debug_file)
+    else:
+        trace.output(options.debug_file)
 
     for activate in options.debug_activate:
         _check_tracing()
@@ -620,6 +735,26 @@ def main():
         _check_tracing()
         trace.ignore(ignore)
 
+    for window in options.debug_window_addr:
+        _check_tracing()
+        trace.windowAddRange(*trace.parse_range(window))
+
+    for requestor in options.debug_window_requestor:
+        _check_tracing()
+        trace.windowAddRequestor(int(requestor, 0))
+
+    if options.debug_window_pc:
+        _check_tracing()
+        trace.windowSetPCRange(*trace.parse_range(options.debug_window_pc))
+
+    for window in options.debug_window_object:
+        _check_tracing()
+        trace.windowAddObject(window)
+
+    if options.debug_decode:
+        trace.decode(options.debug_decode)
+        sys.exit(0)
+
     sys.argv = arguments
 
     if options.m:
@@ -0,0 +1,343 @@
+# Copyright (c) 2024 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Sampled simulation with detailed samples simulated in forked processes.
+
+The sampler fast-forwards a simulation with fast CPUs, e.g. atomic or KVM
+CPUs, and forks a child process at every sample point. The child switches
+to the detailed CPUs, simulates a warmup period and a measurement period,
+writes its stats and exits, while the parent keeps fast-forwarding. The
+children share the memory of the parent copy-on-write, and several of them
+run at the same time. Once all samples are done, the stats of the samples
+are aggregated.
+
+Example:
+    sampler = ForkSampler(
+        system,
+        list(zip(system.cpu, system.detailed_cpu)),
+        interval=100_000_000_000,
+        warmup=1_000_000_000,
+        measure=100_000_000,
+    )
+    results = sampler.run()
+    print(results["stats"]["system.detailed_cpu.ipc"]["mean"])
+
+Listeners must be disabled, e.g. with --listener-mode=off, to fork.
+"""
+
+import json
+import math
+import os
+import sys
+import traceback
+
+import m5
+import _m5.core
+import _m5.stats
+from m5.util import (
+    fatal,
+    inform,
+    warn,
+)
+
+from . import (
+    objects,
+    stats,
+)
+
+
+def _vector_values(name, result, subnames, total, print_total):
+    """Name the elements of a vector or formula stat as in stats.txt"""
+
+    # A single element is named after the stat, e.g. the IPC formula
+    if len(result) == 1:
+        return {name: result[0]}
+
+    # Once a vector has subnames, only its named elements are printed
+    have_sub = any(subnames)
+    values = {}
+    for i, value in enumerate(result):
+        sub = subnames[i] if i < len(subnames) else ""
+        if have_sub and not sub:
+            continue
+        values[f"{name}::{sub if have_sub else i}"] = value
+    if print_total:
+        values[f"{name}::total"] = total
+    return values
+
+
+def _flatten_stats():
+    """Get the value of the scalar, vector and formula stats by name"""
+
+    values = {}
+
+    def visit(group, prefix):
+        for stat in group.getStats():
+            if not (stat.flags & stats.flags.display):
+                continue
+            name = prefix + stat.name
+            if isinstance(stat, _m5.stats.ScalarInfo):
+                stat.prepare()
+                values[name] = stat.result
+            elif isinstance(stat, _m5.stats.VectorInfo):
+                stat.prepare()
+                values.update(
+                    _vector_values(
+                        name,
+                        stat.result,
+                        stat.subnames,
+                        stat.total,
+                        stat.flags & stats.flags.total,
+                    )
+                )
+        for name, child in group.getStatGroups().items():
+            visit(child, f"{prefix}{name}.")
+
+    visit(objects.Root.getInstance().getCCObject(), "")
+    return values
+
+
+def _aggregate(samples):
+    """Get the mean, standard deviation, range and 95% confidence interval
+    of each stat over the samples, weighting the samples"""
+
+    total_weight = sum(sample["weight"] for sample in samples)
+    names = {}
+    for sample in samples:
+        for name, value in sample["stats"].items():
+            names.setdefault(name, []).append((sample["weight"], value))
+
+    result = {}
+    for name, points in sorted(names.items()):
+        points = [(w, v) for w, v in points if math.isfinite(v)]
+        if not points:
+            continue
+        weight = sum(w for w, _ in points)
+        mean = sum(w * v for w, v in points) / weight
+        var = 0.0
+        if len(points) > 1:
+            var = sum(w * (v - mean) ** 2 for w, v in points) / weight
+            var *= len(points) / (len(points) - 1)
+        stdev = math.sqrt(var)
+        result[name] = {
+            "mean": mean,
+            "stdev": stdev,
+            "min": min(v for _, v in points),
+            "max": max(v for _, v in points),
+            "ci95": 1.96 * stdev / math.sqrt(len(points)),
+            "samples": len(points),
+            "weight": weight / total_weight,
+        }
+    return result
+
+
+class ForkSampler:
+    """Sample a simulation, simulating the samples in forked children
+
+    Sample points are either every interval ticks, or at the given ticks,
+    optionally weighted as with SimPoints. At each of them, a child
+    process switches the CPUs given as (fast_cpu, detailed_cpu) pairs, as
+    for m5.switchCpus(), warms up the detailed CPUs for warmup ticks,
+    resets the stats and simulates measure ticks. Its output directory,
+    by default sample<N> in the output directory of the parent, holds the
+    stats of the sample.
+
+    Once done, the parent writes the aggregated stats of the samples to
+    sampling.json in its output directory.
+    """
+
+    def __init__(
+        self,
+        system,
+        switch_cpus,
+        interval=None,
+        warmup=0,
+        measure=None,
+        ticks=None,
+        weights=None,
+        max_children=None,
+        outdir="%(parent)s/sample%(sample)i",
+        stats_file="stats.txt",
+    ):
+        """
+        :param system: Simulated system
+        :param switch_cpus: List of (fast_cpu, detailed_cpu) tuples
+        :param interval: Ticks between periodic sample points
+        :param warmup: Ticks simulated in detail before measuring
+        :param measure: Ticks measured in each sample
+        :param ticks: Ticks of the sample points, rather than periodic
+        :param weights: Weight of each of the given sample points
+        :param max_children: Number of samples simulated at the same time,
+            the number of host cores by default
+        :param outdir: Output directory of the samples, formatted with
+            parent, the output directory of the parent, and sample, the
+            number of the sample
+        :param stats_file: Stat output of the samples, as for
+            m5.stats.addStatVisitor()
+        """
+
+        if (interval is None) == (ticks is None):
+            fatal("Either a sampling interval or sample ticks must be given")
+        if measure is None or measure <= 0:
+            fatal("The measurement period of the samples must be given")
+        if weights is not None and (
+            ticks is None or len(weights) != len(ticks)
+        ):
+            fatal("There must be one weight per sample tick")
+
+        self.system = system
+        self.switch_cpus = switch_cpus
+        self.interval = interval
+        self.warmup = warmup
+        self.measure = measure
+        self.ticks = sorted(ticks) if ticks is not None else None
+        self.weights = weights
+        self.max_children = max_children or os.cpu_count() or 1
+        self.outdir = outdir
+        self.stats_file = stats_file
+
+        # Running children, by pid, and the samples done
+        self._children = {}
+        self._samples = []
+
+    def _sample_points(self):
+        if self.ticks is not None:
+            weights = self.weights or [1.0] * len(self.ticks)
+            yield from zip(self.ticks, weights)
+        else:
+            tick = self.interval
+            while True:
+                yield tick, 1.0
+                tick += self.interval
+
+    def _run_sample(self, index):
+        """Simulate a sample, in the child, and exit"""
+
+        status = 1
+        try:
+            # The outputs opened by the parent are in its directory
+            stats.outputList.clear()
+            stats.addStatVisitor(self.stats_file)
+
+            m5.switchCpus(self.system, self.switch_cpus, verbose=False)
+            if self.warmup:
+                m5.simulate(self.warmup)
+            stats.reset()
+            event = m5.simulate(self.measure)
+            stats.dump()
+
+            result = {
+                "index": index,
+                "tick": m5.curTick(),
+                "cause": event.getCause(),
+                "stats": _flatten_stats(),
+            }
+            from m5 import options
+
+            with open(os.path.join(options.outdir, "sample.json"), "w") as f:
+                json.dump(result, f)
+            status = 0
+        except BaseException:
+            traceback.print_exc()
+        finally:
+            sys.stdout.flush()
+            sys.stderr.flush()
+            # Skip the exit handlers of the parent, which dump its stats
+            os._exit(status)
+
+    def _reap(self, block):
+        """Collect the samples of the children that are done, waiting for
+        one of them if block is set"""
+
+        while self._children:
+            pid, status = os.waitpid(-1, 0 if block else os.WNOHANG)
+            if pid == 0:
+                return
+            if pid not in self._children:
+                continue
+            index, tick, weight, outdir = self._children.pop(pid)
+            path = os.path.join(outdir, "sample.json")
+            if os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0:
+                with open(path) as f:
+                    sample = json.load(f)
+                sample.update(weight=weight, outdir=outdir, start=tick)
+                self._samples.append(sample)
+            else:
+                warn(f"Sample {index} at tick {tick} failed, see {outdir}")
+            if block:
+                return
+
+    def run(self, max_samples=None):
+        """Fast-forward the simulation, forking a child for each sample
+
+        Returns when the simulation exits, or after max_samples samples,
+        once all the children are done. The aggregated stats are returned
+        and written to sampling.json in the output directory.
+        """
+
+        from m5 import options
+
+        if not _m5.core.listenersDisabled():
+            fatal("Listeners must be disabled to fork samples")
+
+        parent = options.outdir
+        for index, (tick, weight) in enumerate(self._sample_points()):
+            if max_samples is not None and index >= max_samples:
+                break
+            if tick > m5.curTick():
+                event = m5.simulate(tick - m5.curTick())
+                if event.getCause() != "simulate() limit reached":
+                    inform(f"Sampling stopped: {event.getCause()}")
+                    break
+            elif tick < m5.curTick():
+                warn(f"Skipping sample {index} at tick {tick}, in the past")
+                continue
+
+            while len(self._children) >= self.max_children:
+                self._reap(block=True)
+
+            outdir = self.outdir % {"parent": parent, "sample": index}
+            # m5.fork() formats the directory again
+            pid = m5.fork(outdir.replace("%", "%%"))
+            if pid == 0:
+                self._run_sample(index)
+            self._children[pid] = (index, tick, weight, outdir)
+            self._reap(block=False)
+
+        while self._children:
+            self._reap(block=True)
+
+        self._samples.sort(key=lambda sample: sample["index"])
+        result = {
+            "samples": [
+                {k: v for k, v in sample.items() if k != "stats"}
+                for sample in self._samples
+            ],
+            "stats": _aggregate(self._samples) if self._samples else {},
+        }
+        with open(os.path.join(parent, "sampling.json"), "w") as f:
+            json.dump(result, f, indent=1)
+        return result
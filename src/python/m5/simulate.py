@@ -61,6 +61,10 @@ from . import (
     ticks,
 )
 from .citations import gather_citations
+from .instantiate_cache import (
+    InstantiationCache,
+    resolvedConfig,
+)
 from .util import (
     attrdict,
     fatal,
@@ -99,18 +103,32 @@ def instantiate(ckpt_dir=None):
     for obj in root.descendants():
         obj.adoptOrphanParams()
 
-    # Unproxy in sorted order for determinism
-    for obj in root.descendants():
-        obj.unproxyParams()
+    cache = None
+    cached = False
+    if options.instantiate_cache:
+        cache = InstantiationCache(options.instantiate_cache, options)
+        cached = cache.hit()
+
+    config = None
+    if cached:
+        # The params are already resolved in the cached configuration
+        if options.dump_config:
+            config = cache.load()
+    else:
+        # Unproxy in sorted order for determinism
+        for obj in root.descendants():
+            obj.unproxyParams()
+        if options.dump_config or cache:
+            config = resolvedConfig(root)
 
     if options.dump_config:
         ini_file = open(os.path.join(options.outdir, options.dump_config), "w")
-        # Print ini sections in sorted order for easier diffing
-        for obj in sorted(root.descendants(), key=lambda o: o.path()):
-            obj.print_ini(ini_file)
+        ini_file.write(config)
         ini_file.close()
 
-    if options.json_config:
+    # The JSON and DOT outputs need the params resolved in Python, they
+    # are not generated when instantiating from the cache
+    if options.json_config and not cached:
         try:
             import json
 
@@ -123,7 +141,7 @@ def instantiate(ckpt_dir=None):
         except ImportError:
             pass
 
-    if options.dot_config:
+    if options.dot_config and not cached:
         do_dot(root, options.outdir, options.dot_config)
         do_ruby_dot(root, options.outdir, options.dot_config)
 
@@ -131,10 +149,15 @@ def instantiate(ckpt_dir=None):
     stats.initSimStats()
 
     # Create the C++ sim objects and connect ports
-    for obj in root.descendants():
-        obj.createCCObject()
-    for obj in root.descendants():
-        obj.connectPorts()
+    if cached:
+        cache.createCCObjects(root)
+    else:
+        for obj in root.descendants():
+            obj.createCCObject()
+        for obj in root.descendants():
+            obj.connectPorts()
+        if cache:
+            cache.store(config)
 
     # Do a second pass to finish initializing the sim objects
     for obj in root.descendants():
@@ -190,6 +190,28 @@ def _hdf5Factory(fn, chunking=10, desc=True, formulas=True):
     return _m5.stats.initHDF5(fn, chunking, desc, formulas)
 
 
+@_url_factory(["columnar"])
+def _columnarFactory(fn, desc=True):
+    """Output stats in a binary columnar format.
+
+    Each value is a column whose name, unit and description are only
+    written the first time it is dumped. Every subsequent dump only
+    holds the values that changed since the previous one, which makes
+    periodic stat dumps much faster and smaller than text. The file
+    can be loaded into a pandas DataFrame, one row per dump, with
+    util/stats_columnar.py.
+
+    Parameters:
+      * desc (bool): Output stat descriptions (default: True)
+
+    Example:
+      columnar://stats.bin?desc=False
+
+    """
+
+    return _m5.stats.initColumnar(fn, desc)
+
+
 @_url_factory(["json"])
 def _jsonFactory(fn):
     """Output stats in JSON format.
@@ -343,6 +365,9 @@ def enable():
 
     _m5.stats.enable()
 
+    if _publish_args is not None:
+        _m5.stats.startPublisher(*_publish_args)
+
 
 def prepare():
     """Prepare all stats for data access.  This must be done before
@@ -356,33 +381,85 @@ def prepare():
     _visit_stats(lambda g, s: s.prepare())
 
 
-def _dump_to_visitor(visitor, roots=None):
-    # New stats
-    def dump_group(group):
-        for stat in group.getStats():
-            stat.visit(visitor)
-        for n, g in group.getStatGroups().items():
-            visitor.beginGroup(n)
-            dump_group(g)
-            visitor.endGroup()
-
+def _dump_to_visitor(visitor, roots=None, prepare=False):
+    # New stats, the stats of the groups are dumped, and optionally
+    # prepared, by C++ code to skip the ones that are filtered out
     if roots:
         # New stats from selected subroots.
         for root in roots:
-            for p in root.path_list():
-                visitor.beginGroup(p)
-            dump_group(root)
-            for p in reversed(root.path_list()):
-                visitor.endGroup()
+            _m5.stats.dumpGroup(
+                visitor, root.getCCObject(), root.path_list(), prepare
+            )
     else:
         # New stats starting from root.
-        dump_group(Root.getInstance())
+        _m5.stats.dumpGroup(
+            visitor, Root.getInstance().getCCObject(), [], prepare
+        )
 
         # Legacy stats
         for stat in stats_list:
             stat.visit(visitor)
 
 
+def setDumpFilter(patterns):
+    """Select the stats that are dumped by their full name
+
+    Patterns are shell globs, e.g. "system.cpu*.ipc", and a pattern
+    starting with '!' excludes the stats it matches. If there is any
+    including pattern, only the stats matching one of them are dumped.
+    Stats that are filtered out are not evaluated when dumping, the
+    filter does not apply to the JSON output.
+
+    """
+
+    _m5.stats.setDumpFilter(list(patterns))
+
+
+def setDumpThreads(threads):
+    """Set the number of host threads formatting the text stat dumps"""
+
+    _m5.stats.setDumpThreads(threads)
+
+
+_publish_args = None
+
+
+def publish(path, stats=None, period=0, host_period=1.0, ring_size=4 << 20):
+    """Publish snapshots of the stats to a local socket while simulating
+
+    Clients connecting to the Unix socket at path, relative to the output
+    directory, receive the value of the selected stats every period ticks
+    and every host_period seconds, when they are not 0. Snapshots are
+    streamed in the format of the columnar stat output, and can be read
+    with util/stats_columnar.py. A snapshot is dropped rather than slowing
+    down the simulation if the clients do not keep up.
+
+    Parameters:
+        path: Path of the socket, or '@name' for an abstract socket
+        stats: Optional list of globs selecting the stats, as for
+            setDumpFilter()
+        period: Simulated ticks between snapshots
+        host_period: Host seconds between snapshots
+        ring_size: Size in bytes of the buffer of pending snapshots
+    """
+
+    global _publish_args
+    if _publish_args is not None:
+        fatal("The stats are already published to %s\n", _publish_args[0])
+    _publish_args = (
+        path,
+        list(stats or []),
+        int(period),
+        float(host_period),
+        int(ring_size),
+    )
+
+    # The publisher is started with the stats package if it is not
+    # enabled yet
+    if _m5.stats.enabled():
+        _m5.stats.startPublisher(*_publish_args)
+
+
 lastDump = 0
 # List[SimObject].
 global_dump_roots = []
@@ -409,16 +486,27 @@ def dump(roots=None):
         return
 
     # Only prepare stats the first time we dump them in the same tick.
+    prepare_groups = False
     if new_dump:
         _m5.stats.processDumpQueue()
         # Notify new-style stats group that we are about to dump stats.
         sim_root = Root.getInstance()
         if sim_root:
             sim_root.preDumpStats()
-        prepare()
+        if all_roots:
+            prepare()
+        else:
+            # The stats of the groups are prepared along with the
+            # first output, skipping the ones that are filtered out
+            for stat in stats_list:
+                stat.prepare()
+            prepare_groups = True
 
     for output in outputList:
         if isinstance(output, JsonOutputVistor):
+            if prepare_groups:
+                _visit_stats(lambda g, s: s.prepare())
+                prepare_groups = False
             if not all_roots:
                 output.dump(Root.getInstance())
             else:
@@ -426,8 +514,11 @@ def dump(roots=None):
         else:
             if output.valid():
                 output.begin()
-                _dump_to_visitor(output, roots=all_roots)
+                _dump_to_visitor(
+                    output, roots=all_roots, prepare=prepare_groups
+                )
                 output.end()
+                prepare_groups = False
 
 
 def reset():
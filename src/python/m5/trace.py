@@ -27,8 +27,25 @@
 # Export native methods to Python
 from _m5.trace import (
     activate,
+    decode,
     disable,
     enable,
     ignore,
     output,
+    outputBinary,
+    windowAddObject,
+    windowAddRange,
+    windowAddRequestor,
+    windowClear,
+    windowSetPCRange,
 )
+
+
+def parse_range(expr):
+    """Parse a range given as START:END or START+SIZE, END excluded."""
+    if "+" in expr:
+        start, size = expr.split("+", 1)
+        start = int(start, 0)
+        return start, start + int(size, 0)
+    start, end = expr.split(":", 1)
+    return int(start, 0), int(end, 0)
@@ -44,6 +44,9 @@
 #include "pybind11/stl.h"
 
 #include <ctime>
+#include <map>
+#include <memory>
+#include <string>
 
 #include "base/addr_range.hh"
 #include "base/inet.hh"
@@ -55,6 +58,8 @@
 #include "base/types.hh"
 #include "sim/core.hh"
 #include "sim/cur_tick.hh"
+#include "sim/cxx_config_ini.hh"
+#include "sim/cxx_manager.hh"
 #include "sim/drain.hh"
 #include "sim/serialize.hh"
 #include "sim/sim_object.hh"
@@ -83,6 +88,47 @@ PybindSimObjectResolver::resolveSimObject(const std::string &name)
     return f(name).cast<SimObject *>();
 }
 
+/**
+ * Configuration file and manager used to build the SimObjects from a
+ * cached configuration. They are kept for the rest of the simulation,
+ * as the SimObjects refer to the params held by the manager.
+ */
+static std::unique_ptr<CxxConfigFileBase> cachedConfigFile;
+static std::unique_ptr<CxxConfigManager> cachedConfigManager;
+
+/**
+ * Create the SimObjects described by a resolved config.ini and connect
+ * their ports, without going through the Python params. Returns the
+ * objects indexed by name, so that Python can attach them to its own
+ * SimObjects.
+ */
+static std::map<std::string, SimObject *>
+instantiateFromConfig(const std::string &config_file)
+{
+    panic_if(cachedConfigManager,
+             "SimObjects already created from a cached configuration.");
+    fatal_if(cxxConfigDirectory().empty(),
+             "gem5 was built without C++ configuration support "
+             "(--with-cxx-config).");
+
+    cachedConfigFile = std::make_unique<CxxIniFile>();
+    fatal_if(!cachedConfigFile->load(config_file),
+             "Can't open cached configuration '%s'.", config_file);
+
+    cachedConfigManager =
+        std::make_unique<CxxConfigManager>(*cachedConfigFile);
+    try {
+        cachedConfigManager->findAllObjects();
+        for (auto *object : cachedConfigManager->objectsInOrder)
+            cachedConfigManager->bindObjectPorts(object);
+    } catch (CxxConfigManager::Exception &e) {
+        fatal("Cached configuration '%s' can't be instantiated, %s: %s",
+              config_file, e.name, e.message);
+    }
+
+    return cachedConfigManager->objectsByName;
+}
+
 extern const char *compileDate;
 extern const char *gem5Version;
 
@@ -341,6 +387,17 @@ pybind_init_core(py::module_ &m_native)
 
         ;
 
+    /*
+     * Instantiation from a cached configuration
+     */
+    m_core
+        .def("cxxConfigAvailable", []() {
+            return !cxxConfigDirectory().empty();
+        })
+        .def("instantiateFromConfig", &instantiateFromConfig,
+             py::return_value_policy::reference)
+        ;
+
 
     init_drain(m_native);
     init_serialize(m_native);
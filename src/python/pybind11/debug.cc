@@ -42,13 +42,20 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 
+#include <zfstream.h>
+
+#include <fstream>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "base/compiler.hh"
 #include "base/debug.hh"
+#include "base/logging.hh"
 #include "base/output.hh"
 #include "base/trace.hh"
+#include "mem/trace_window.hh"
+#include "sim/core.hh"
 #include "sim/debug.hh"
 
 namespace py = pybind11;
@@ -56,6 +63,16 @@ namespace py = pybind11;
 namespace gem5
 {
 
+/** Write out the messages buffered by the current logger, if binary. */
+static void
+flushBinaryLogger()
+{
+    auto *logger = dynamic_cast<trace::BinaryLogger *>(
+        trace::getDebugLogger());
+    if (logger)
+        logger->flush();
+}
+
 static void
 output(const char *filename)
 {
@@ -64,9 +81,47 @@ output(const char *filename)
     if (!file_stream)
         file_stream = simout.create(filename);
 
+    flushBinaryLogger();
     trace::setDebugLogger(new trace::OstreamLogger(*file_stream->stream()));
 }
 
+static void
+outputBinary(const char *filename)
+{
+    OutputStream *file_stream = simout.find(filename);
+
+    if (!file_stream)
+        file_stream = simout.create(filename, true);
+
+    // The messages are buffered by each thread until a chunk is full.
+    // Setting a logger deletes the current one, so only the logger
+    // current when gem5 exits is flushed then.
+    static bool flush_registered = false;
+    if (!flush_registered) {
+        registerExitCallback(flushBinaryLogger);
+        flush_registered = true;
+    }
+
+    flushBinaryLogger();
+    trace::setDebugLogger(new trace::BinaryLogger(*file_stream->stream()));
+}
+
+static void
+decode(const char *filename)
+{
+    const std::string name(filename);
+    std::unique_ptr<std::istream> in;
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, ".gz") == 0)
+        in.reset(new gzifstream(filename, std::ios::in | std::ios::binary));
+    else
+        in.reset(new std::ifstream(filename, std::ios::binary));
+    fatal_if(!*in, "Could not open binary trace '%s'.\n", filename);
+
+    if (!trace::BinaryTrace::decode(*in, *trace::getDebugLogger()))
+        warn("Binary trace '%s' is truncated or malformed.\n", filename);
+    trace::output().flush();
+}
+
 static void
 activate(const char *expr)
 {
@@ -129,10 +184,19 @@ pybind_init_debug(py::module_ &m_native)
     py::module_ m_trace = m_native.def_submodule("trace");
     m_trace
         .def("output", &output)
+        .def("outputBinary", &outputBinary)
+        .def("decode", &decode)
         .def("activate", &activate)
         .def("ignore", &ignore)
         .def("enable", &trace::enable)
         .def("disable", &trace::disable)
+        .def("windowAddRange", [](Addr start, Addr end) {
+                TraceWindow::addRange(AddrRange(start, end));
+            })
+        .def("windowAddRequestor", &TraceWindow::addRequestor)
+        .def("windowSetPCRange", &TraceWindow::setPCRange)
+        .def("windowAddObject", &TraceWindow::addObject)
+        .def("windowClear", &TraceWindow::clear)
         ;
 }
 
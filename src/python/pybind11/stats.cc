@@ -42,6 +42,8 @@
 #include "pybind11/stl.h"
 
 #include "base/statistics.hh"
+#include "base/stats/columnar.hh"
+#include "base/stats/dump.hh"
 #include "base/stats/text.hh"
 #include "config/have_hdf5.hh"
 
@@ -114,10 +116,20 @@ pybind_init_stats(py::module_ &m_native)
 #if HAVE_HDF5
         .def("initHDF5", &statistics::initHDF5)
 #endif
+        .def("initColumnar", &statistics::initColumnar)
+        .def("setDumpFilter", &statistics::setDumpFilter)
+        .def("setDumpThreads", &statistics::setDumpThreads)
+        .def("dumpGroup", [](statistics::Output &output,
+                             statistics::Group &root,
+                             const std::vector<std::string> &path,
+                             bool prepare) {
+            statistics::dumpGroup(output, root, path, prepare);
+        })
         .def("registerPythonStatsHandlers",
              &statistics::registerPythonStatsHandlers)
         .def("schedStatEvent", &statistics::schedStatEvent)
         .def("periodicStatDump", &statistics::periodicStatDump)
+        .def("startPublisher", &statistics::startPublisher)
         .def("updateEvents", &statistics::updateEvents)
         .def("processResetQueue", &statistics::processResetQueue)
         .def("processDumpQueue", &statistics::processDumpQueue)
@@ -49,6 +49,13 @@ class MemoryMode(Enum):
     vals = ["invalid", "atomic", "timing", "atomic_noncaching"]
 
 
+# How the backing stores are written to checkpoints: as a single gzip
+# file, or as an image of chunks processed in parallel, which are either
+# compressed or kept as is so that they are mapped lazily when restoring.
+class MemoryCheckpointFormat(ScopedEnum):
+    vals = ["gzip", "chunked", "mapped"]
+
+
 class System(SimObject):
     type = "System"
     cxx_header = "sim/system.hh"
@@ -104,6 +111,15 @@ class System(SimObject):
         "shared_backstore is non-empty.",
     )
 
+    memory_checkpoint_format = Param.MemoryCheckpointFormat(
+        "gzip", "Format of the physical memory in checkpoints"
+    )
+    memory_checkpoint_threads = Param.Unsigned(
+        0,
+        "Number of host threads writing and reading the physical memory "
+        "of checkpoints, 0 for one per host core",
+    )
+
     cache_line_size = Param.Unsigned(64, "Cache line size in bytes")
 
     redirect_paths = VectorParam.RedirectPath([], "Path redirections")
@@ -44,6 +44,7 @@ namespace gem5
 extern volatile bool async_event;       ///< Some asynchronous event has happened.
 extern volatile bool async_statdump;    ///< Async request to dump stats.
 extern volatile bool async_statreset;   ///< Async request to reset stats.
+extern volatile bool async_statpublish; ///< Async request to publish stats.
 extern volatile bool async_exit;        ///< Async request to exit simulator.
 extern volatile bool async_io;          ///< Async I/O request (SIGIO).
 extern volatile bool async_exception;   ///< Python exception.
@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/embedded.hh"
+
+#include <deque>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/statistics.hh"
+#include "base/stats/dump.hh"
+#include "base/stats/text.hh"
+#include "base/stats/values.hh"
+#include "mem/external_master.hh"
+#include "mem/packet.hh"
+#include "mem/request.hh"
+#include "sim/core.hh"
+#include "sim/cur_tick.hh"
+#include "sim/cxx_config_ini.hh"
+#include "sim/cxx_manager.hh"
+#include "sim/drain.hh"
+#include "sim/eventq.hh"
+#include "sim/serialize.hh"
+#include "sim/sim_events.hh"
+#include "sim/sim_object.hh"
+#include "sim/simulate.hh"
+#include "sim/stat_control.hh"
+
+namespace gem5
+{
+
+namespace
+{
+
+/**
+ * Port of an ExternalMaster through which the host injects accesses.
+ * Timing accesses are queued and sent from an event, so that they are
+ * issued from within the simulation loop.
+ */
+class InjectionPort : public ExternalMaster::ExternalPort
+{
+  private:
+    /** Access the response of a packet completes */
+    struct AccessState : public Packet::SenderState
+    {
+        EmbeddedSimulation::AccessCallback callback;
+        Tick issueTick;
+
+        AccessState(EmbeddedSimulation::AccessCallback _callback,
+                    Tick issue_tick)
+            : callback(std::move(_callback)), issueTick(issue_tick)
+        {}
+    };
+
+    std::deque<PacketPtr> pending;
+    bool waitingRetry = false;
+    EventFunctionWrapper sendEvent;
+
+    RequestPtr
+    makeRequest(const EmbeddedSimulation::Access &access) const
+    {
+        return std::make_shared<Request>(access.addr, access.size, 0,
+                                         owner.id);
+    }
+
+    void
+    sendPending()
+    {
+        while (!pending.empty()) {
+            if (!sendTimingReq(pending.front())) {
+                waitingRetry = true;
+                return;
+            }
+            pending.pop_front();
+        }
+    }
+
+  public:
+    InjectionPort(const std::string &_name, ExternalMaster &_owner)
+        : ExternalPort(_name, _owner),
+          sendEvent([this]{ sendPending(); }, _name + ".sendEvent")
+    {}
+
+    void
+    inject(const EmbeddedSimulation::Access &access,
+           EmbeddedSimulation::AccessCallback callback)
+    {
+        auto req = makeRequest(access);
+        PacketPtr pkt = access.write ? Packet::createWrite(req) :
+            Packet::createRead(req);
+        pkt->allocate();
+        if (access.write)
+            pkt->setData(access.data.data());
+        pkt->pushSenderState(new AccessState(std::move(callback), curTick()));
+
+        pending.push_back(pkt);
+        if (!waitingRetry && !sendEvent.scheduled())
+            owner.schedule(sendEvent, curTick());
+    }
+
+    void
+    access(EmbeddedSimulation::Access &access)
+    {
+        Packet pkt(makeRequest(access),
+                   access.write ? MemCmd::WriteReq : MemCmd::ReadReq);
+        pkt.dataStatic(access.data.data());
+        sendFunctional(&pkt);
+    }
+
+    bool
+    recvTimingResp(PacketPtr pkt) override
+    {
+        auto *state = safe_cast<AccessState *>(pkt->popSenderState());
+
+        EmbeddedSimulation::Access access;
+        access.addr = pkt->getAddr();
+        access.size = pkt->getSize();
+        access.write = pkt->isWrite();
+        access.data.assign(pkt->getConstPtr<uint8_t>(),
+                           pkt->getConstPtr<uint8_t>() + pkt->getSize());
+        access.issueTick = state->issueTick;
+        access.completeTick = curTick();
+
+        if (state->callback)
+            state->callback(access);
+
+        delete state;
+        delete pkt;
+        return true;
+    }
+
+    void
+    recvReqRetry() override
+    {
+        waitingRetry = false;
+        sendPending();
+    }
+};
+
+} // anonymous namespace
+
+class EmbeddedSimulation::Impl : public ExternalMaster::Handler
+{
+  public:
+    /** Simulation the stat dumps and resets of the objects go to */
+    static Impl *current;
+
+    /** Whether a simulation was ever created by this process */
+    static bool created;
+
+    CxxIniFile configFile;
+    std::unique_ptr<CxxConfigManager> configManager;
+    SimObject *root = nullptr;
+
+    /** Injection ports by their port_data */
+    std::map<std::string, InjectionPort *> ports;
+
+    bool instantiated = false;
+    bool needStartup = true;
+
+    ExternalMaster::ExternalPort *
+    getExternalPort(const std::string &name, ExternalMaster &owner,
+                    const std::string &port_data) override
+    {
+        fatal_if(ports.count(port_data),
+                 "%s: Injection port '%s' is already in use.",
+                 name, port_data);
+        auto *port = new InjectionPort(name, owner);
+        ports[port_data] = port;
+        return port;
+    }
+
+    InjectionPort &
+    port(const std::string &name)
+    {
+        auto it = ports.find(name);
+        if (it == ports.end()) {
+            throw Error(csprintf("No injection port named '%s'. Add an "
+                                 "ExternalMaster with port_type=\"embedded\" "
+                                 "and port_data=\"%s\" to the "
+                                 "configuration.", name, name));
+        }
+        return *it->second;
+    }
+
+    void
+    requireInstantiated(bool instantiated_state) const
+    {
+        if (instantiated != instantiated_state) {
+            throw Error(instantiated ?
+                        "The simulation is already instantiated." :
+                        "The simulation isn't instantiated yet.");
+        }
+    }
+
+    /** Bind the stats of the objects in the same hierarchy as the
+     *  objects themselves, as the Python configuration does */
+    void
+    bindStatHierarchy()
+    {
+        for (auto &[name, object] : configManager->objectsByName) {
+            if (object == root)
+                continue;
+            auto pos = name.rfind('.');
+            SimObject *parent = pos == std::string::npos ? root :
+                configManager->objectsByName.at(name.substr(0, pos));
+            const std::string child = pos == std::string::npos ? name :
+                name.substr(pos + 1);
+            parent->addStatGroup(child.c_str(), object);
+        }
+    }
+
+    void
+    enableStats()
+    {
+        auto enable = [](statistics::Info *info) {
+            panic_if(!info->check() || !info->baseCheck(),
+                     "Stat '%s' (%d) was not properly initialized by a "
+                     "regStats() function.", info->name, info->id);
+            if (!(info->flags & statistics::display))
+                info->name = csprintf("__Stat%06d", info->id);
+            info->enable();
+        };
+
+        for (auto *info : statistics::statsList())
+            enable(info);
+        visitStats(*root, "", [&](statistics::Info *info,
+                                  const std::string &) { enable(info); });
+        statistics::enable();
+    }
+
+    template <typename Visitor>
+    void
+    visitStats(statistics::Group &group, const std::string &prefix,
+               const Visitor &visitor)
+    {
+        for (auto *info : group.getStats())
+            visitor(info, prefix);
+        for (auto &[name, child] : group.getStatGroups())
+            visitStats(*child, prefix + name + ".", visitor);
+    }
+
+    void
+    dumpStats()
+    {
+        statistics::processDumpQueue();
+        root->preDumpStats();
+
+        statistics::Output *output =
+            statistics::initText("stats.txt", true, true);
+        if (!output->valid())
+            return;
+        output->begin();
+        statistics::dumpGroup(*output, *root, {}, true);
+        for (auto *info : statistics::statsList()) {
+            info->prepare();
+            info->visit(*output);
+        }
+        output->end();
+    }
+
+    void
+    resetStats()
+    {
+        root->resetStats();
+        for (auto *info : statistics::statsList())
+            info->reset();
+        statistics::processResetQueue();
+    }
+
+    /** Simulate until the objects are drained */
+    void
+    drain()
+    {
+        while (!DrainManager::instance().tryDrain()) {
+            GlobalSimLoopExitEvent *exit_event;
+            do {
+                exit_event = simulate();
+            } while (exit_event->getCause() != "Finished drain");
+        }
+    }
+};
+
+EmbeddedSimulation::Impl *EmbeddedSimulation::Impl::current = nullptr;
+bool EmbeddedSimulation::Impl::created = false;
+
+EmbeddedSimulation::EmbeddedSimulation(const std::string &config_file,
+                                       const std::string &output_dir,
+                                       uint64_t tick_frequency)
+    : impl(new Impl)
+{
+    if (Impl::created)
+        throw Error("Only one simulation can be run by a process.");
+    Impl::created = true;
+    if (cxxConfigDirectory().empty()) {
+        throw Error("gem5 was built without C++ configuration support "
+                    "(--with-cxx-config).");
+    }
+    if (!impl->configFile.load(config_file))
+        throw Error(csprintf("Can't open config file '%s'.", config_file));
+    Impl::current = impl.get();
+
+    setOutputDir(output_dir);
+    setClockFrequency(tick_frequency);
+    fixClockFrequency();
+    curEventQueue(getEventQueue(0));
+
+    statistics::initSimStats();
+    statistics::registerHandlers(
+        []() { if (Impl::current) Impl::current->resetStats(); },
+        []() { if (Impl::current) Impl::current->dumpStats(); });
+
+    ExternalMaster::registerHandler("embedded", impl.get());
+
+    impl->configManager.reset(new CxxConfigManager(impl->configFile));
+}
+
+EmbeddedSimulation::~EmbeddedSimulation()
+{
+    Impl::current = nullptr;
+}
+
+void
+EmbeddedSimulation::setParam(const std::string &object,
+                             const std::string &param,
+                             const std::string &value)
+{
+    impl->requireInstantiated(false);
+    try {
+        impl->configManager->setParam(object, param, value);
+    } catch (CxxConfigManager::Exception &e) {
+        throw Error(e.name + ": " + e.message);
+    }
+}
+
+void
+EmbeddedSimulation::setParamVector(const std::string &object,
+                                   const std::string &param,
+                                   const std::vector<std::string> &values)
+{
+    impl->requireInstantiated(false);
+    try {
+        impl->configManager->setParamVector(object, param, values);
+    } catch (CxxConfigManager::Exception &e) {
+        throw Error(e.name + ": " + e.message);
+    }
+}
+
+void
+EmbeddedSimulation::instantiate(const std::string &checkpoint_dir)
+{
+    impl->requireInstantiated(false);
+    impl->instantiated = true;
+
+    CxxConfigManager &manager = *impl->configManager;
+    try {
+        manager.findAllObjects();
+        for (auto *object : manager.objectsInOrder)
+            manager.bindObjectPorts(object);
+        impl->root = &manager.getObject<SimObject>("root");
+        impl->bindStatHierarchy();
+        manager.instantiate(false);
+    } catch (CxxConfigManager::Exception &e) {
+        throw Error(e.name + ": " + e.message);
+    }
+    impl->enableStats();
+
+    if (checkpoint_dir.empty()) {
+        manager.initState();
+    } else {
+        SimObject::setSimObjectResolver(&manager.getSimObjectResolver());
+        CheckpointIn checkpoint(checkpoint_dir);
+        DrainManager::instance().preCheckpointRestore();
+        manager.loadState(checkpoint);
+    }
+
+    // Shift the stat events scheduled in the past of a checkpoint
+    statistics::updateEvents();
+}
+
+EmbeddedSimulation::ExitInfo
+EmbeddedSimulation::run(uint64_t ticks)
+{
+    impl->requireInstantiated(true);
+
+    if (impl->needStartup) {
+        impl->configManager->startup();
+        impl->needStartup = false;
+    }
+    if (DrainManager::instance().isDrained())
+        DrainManager::instance().resume();
+
+    GlobalSimLoopExitEvent *exit_event =
+        simulate(ticks == maxTick ? MaxTick : ticks);
+    return {exit_event->getCause(), exit_event->getCode(), gem5::curTick()};
+}
+
+uint64_t
+EmbeddedSimulation::curTick() const
+{
+    return gem5::curTick();
+}
+
+std::map<std::string, double>
+EmbeddedSimulation::stats()
+{
+    impl->requireInstantiated(true);
+
+    statistics::processDumpQueue();
+    impl->root->preDumpStats();
+
+    std::map<std::string, double> values;
+    auto add = [&values](statistics::Info *info, const std::string &prefix) {
+        if (!(info->flags & statistics::display))
+            return;
+        info->prepare();
+
+        statistics::addValues(*info, prefix + info->name, values);
+    };
+
+    for (auto *info : statistics::statsList())
+        add(info, "");
+    impl->visitStats(*impl->root, "", add);
+    return values;
+}
+
+double
+EmbeddedSimulation::stat(const std::string &name)
+{
+    const auto values = stats();
+    auto it = values.find(name);
+    if (it == values.end())
+        throw Error(csprintf("No stat named '%s'.", name));
+    return it->second;
+}
+
+void
+EmbeddedSimulation::resetStats()
+{
+    impl->requireInstantiated(true);
+    impl->resetStats();
+}
+
+void
+EmbeddedSimulation::dumpStats()
+{
+    impl->requireInstantiated(true);
+    impl->dumpStats();
+}
+
+void
+EmbeddedSimulation::checkpoint(const std::string &dir)
+{
+    impl->requireInstantiated(true);
+
+    impl->drain();
+    impl->configManager->forEachObject(&SimObject::memWriteback);
+    SimObject::serializeAll(dir);
+    DrainManager::instance().resume();
+}
+
+void
+EmbeddedSimulation::inject(const std::string &port, const Access &access,
+                           AccessCallback callback)
+{
+    impl->requireInstantiated(true);
+    if (access.write && access.data.size() < access.size)
+        throw Error("The data of a write is smaller than its size.");
+    impl->port(port).inject(access, std::move(callback));
+}
+
+void
+EmbeddedSimulation::access(const std::string &port, Access &access)
+{
+    impl->requireInstantiated(true);
+    if (access.write && access.data.size() < access.size)
+        throw Error("The data of a write is smaller than its size.");
+    access.data.resize(access.size);
+    access.issueTick = access.completeTick = gem5::curTick();
+    impl->port(port).access(access);
+}
+
+} // namespace gem5
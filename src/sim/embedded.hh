@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *
+ * Interface for embedding gem5 in a host program. A simulation is
+ * built from a config.ini written by a Python configured gem5 run and
+ * driven entirely from C++, Python is neither needed nor entered.
+ *
+ * This header only depends on the standard library, so that host
+ * programs linking against libgem5 do not depend on the internal gem5
+ * headers. Build the library with C++ configuration support, e.g.:
+ *
+ *     scons --with-cxx-config --without-python build/ARM/libgem5_opt.so
+ */
+
+#ifndef __SIM_EMBEDDED_HH__
+#define __SIM_EMBEDDED_HH__
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace gem5
+{
+
+/**
+ * A gem5 simulation embedded in a host program.
+ *
+ * The simulation goes through the following steps:
+ * <ul>
+ *   <li>construction, which loads the configuration. Parameters can
+ *     then be overridden with setParam and setParamVector</li>
+ *   <li>instantiate, which builds the SimObjects and initializes them,
+ *     optionally restoring a checkpoint</li>
+ *   <li>any sequence of run, stat reads and resets, checkpoints and
+ *     memory accesses</li>
+ * </ul>
+ *
+ * gem5 keeps global simulation state, so a process holds at most one
+ * simulation over its lifetime. Hosts running many simulations should
+ * run each of them in its own process, e.g. by forking a worker.
+ *
+ * Memory traffic is injected through ExternalMaster objects of the
+ * configuration with port_type "embedded"; their port_data names the
+ * port in calls to inject and access.
+ *
+ * Errors in the configuration and misuse of the interface are reported
+ * by throwing Error. Errors detected by the simulated objects themselves
+ * are reported by gem5 as usual, i.e. fatal and panic end the process.
+ */
+class EmbeddedSimulation
+{
+  public:
+    /** Error in the configuration or use of the simulation */
+    class Error : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /** Why and when run returned */
+    struct ExitInfo
+    {
+        std::string cause;
+        int code;
+        uint64_t tick;
+    };
+
+    /** Memory access injected into or completed by the simulation */
+    struct Access
+    {
+        uint64_t addr = 0;
+        unsigned size = 0;
+        bool write = false;
+        /** Data written, or read once the access completed */
+        std::vector<uint8_t> data;
+        /** Ticks the access was issued and completed at */
+        uint64_t issueTick = 0;
+        uint64_t completeTick = 0;
+    };
+
+    using AccessCallback = std::function<void(const Access &)>;
+
+    static constexpr uint64_t maxTick = std::numeric_limits<uint64_t>::max();
+
+    /**
+     * @param config_file config.ini describing the simulated system
+     * @param output_dir Directory the simulation writes its outputs to
+     * @param tick_frequency Number of ticks per second, which must be
+     *     the one of the run that generated the configuration
+     */
+    EmbeddedSimulation(const std::string &config_file,
+                       const std::string &output_dir = "m5out",
+                       uint64_t tick_frequency = 1000000000000ULL);
+    ~EmbeddedSimulation();
+
+    EmbeddedSimulation(const EmbeddedSimulation &) = delete;
+    EmbeddedSimulation &operator=(const EmbeddedSimulation &) = delete;
+
+    /** Override a parameter of an object before instantiation */
+    void setParam(const std::string &object, const std::string &param,
+                  const std::string &value);
+    void setParamVector(const std::string &object, const std::string &param,
+                        const std::vector<std::string> &values);
+
+    /**
+     * Build and initialize all the objects of the configuration.
+     *
+     * @param checkpoint_dir Checkpoint to restore, if not empty
+     */
+    void instantiate(const std::string &checkpoint_dir = "");
+
+    /**
+     * Simulate until an exit event, e.g. the end of the workload, or
+     * until the given number of ticks went by.
+     */
+    ExitInfo run(uint64_t ticks = maxTick);
+
+    uint64_t curTick() const;
+
+    /**
+     * Current value of the statistics, by name as in stats.txt. A
+     * vector or formula with a single element, e.g. system.cpu.ipc, is
+     * named after the statistic itself. Otherwise its elements are
+     * named name::subname, or name::index when it has no subnames, and
+     * its total is name::total if stats.txt prints it. Distributions
+     * are summarized by name::samples and name::mean. Other kinds of
+     * statistics are only included in the dumps.
+     */
+    std::map<std::string, double> stats();
+
+    /** Value of a single statistic, as named by stats() */
+    double stat(const std::string &name);
+
+    /** Reset all statistics */
+    void resetStats();
+
+    /** Append the statistics to stats.txt in the output directory */
+    void dumpStats();
+
+    /**
+     * Drain the simulation and write a checkpoint to the given
+     * directory. The simulation then carries on as if uninterrupted.
+     */
+    void checkpoint(const std::string &dir);
+
+    /**
+     * Issue a timing access through an injection port at the current
+     * tick. The access is sent when the simulation runs, and the
+     * callback is called from within run when it completes. The
+     * simulated system must be in timing mode, and the access must not
+     * cross a cache line.
+     */
+    void inject(const std::string &port, const Access &access,
+                AccessCallback callback = {});
+
+    /**
+     * Perform a functional access through an injection port right away.
+     * The data of reads is stored in the access.
+     */
+    void access(const std::string &port, Access &access);
+
+  private:
+    class Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace gem5
+
+#endif // __SIM_EMBEDDED_HH__
@@ -66,6 +66,13 @@ class Port
     /** Descriptive name (for DPRINTF output) */
     const std::string portName;
 
+    friend class TraceWindow;
+
+    /** Whether the trace window objects match this port, cached for the
+     *  generation of the trace window predicates below. */
+    mutable bool traceWindowMatch = false;
+    mutable uint32_t traceWindowGeneration = 0;
+
   protected:
 
     class UnboundPortException {};
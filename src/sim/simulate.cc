@@ -312,6 +312,11 @@ doSimLoop(EventQueue *eventq)
                 async_statreset = false;
             }
 
+            if (async_statpublish) {
+                async_statpublish = false;
+                statistics::schedPublishEvent();
+            }
+
             if (async_io) {
                 async_io = false;
                 pollQueue.service();
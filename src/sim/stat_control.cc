@@ -48,11 +48,16 @@
 #include <fstream>
 #include <iostream>
 #include <list>
+#include <memory>
 
 #include "base/callback.hh"
 #include "base/statistics.hh"
+#include "base/stats/publisher.hh"
 #include "base/time.hh"
+#include "sim/async.hh"
+#include "sim/core.hh"
 #include "sim/global_event.hh"
+#include "sim/root.hh"
 
 namespace gem5
 {
@@ -61,6 +66,9 @@ namespace statistics
 {
 
 GlobalEvent *dumpEvent;
+GlobalEvent *publishEvent;
+
+std::unique_ptr<Publisher> publisher;
 
 void
 initSimStats()
@@ -112,6 +120,66 @@ schedStatEvent(bool dump, bool reset, Tick when, Tick repeat)
     dumpEvent = new StatEvent(when + simQuantum, dump, reset, repeat);
 }
 
+/**
+ * Event to take a snapshot of the statistics for the publisher.
+ */
+class PublishEvent : public GlobalEvent
+{
+  private:
+    Tick repeat;
+
+  public:
+    PublishEvent(Tick _when, Tick _repeat)
+        : GlobalEvent(_when, Stat_Event_Pri, 0), repeat(_repeat)
+    {
+    }
+
+    virtual void
+    process()
+    {
+        if (publisher && Root::root())
+            publisher->publish(*Root::root());
+
+        if (repeat)
+            statistics::schedPublishEvent(curTick() + repeat, repeat);
+    }
+
+    const char *description() const { return "GlobalPublishEvent"; }
+};
+
+void
+startPublisher(const std::string &path,
+               const std::vector<std::string> &patterns,
+               Tick period, double host_period, size_t ring_size)
+{
+    fatal_if(publisher, "The stats publisher is already started\n");
+
+    // Snapshots on host time are requested by the publisher thread,
+    // and taken by the simulation thread like asynchronous dumps
+    publisher = std::make_unique<Publisher>(
+        path, patterns, ring_size, host_period, [] {
+            async_statpublish = true;
+            async_event = true;
+        });
+    registerExitCallback([] { publisher.reset(); });
+
+    if (period != 0)
+        schedPublishEvent(curTick() + period, period);
+}
+
+void
+schedPublishEvent(Tick when, Tick repeat)
+{
+    if (!publisher)
+        return;
+
+    // Like for the dumps, the snapshot is taken after the next sync
+    // amongst the event queues
+    GlobalEvent *event = new PublishEvent(when + simQuantum, repeat);
+    if (repeat)
+        publishEvent = event;
+}
+
 void
 periodicStatDump(Tick period)
 {
@@ -156,6 +224,12 @@ updateEvents()
         Tick _when = dumpEvent->when();
         dumpEvent->reschedule(_when + curTick());
     }
+
+    // The periodic snapshots of the publisher are shifted the same way
+    if (publishEvent != NULL &&
+        (publishEvent->scheduled() && publishEvent->when() < curTick())) {
+        publishEvent->reschedule(publishEvent->when() + curTick());
+    }
 }
 
 } // namespace statistics
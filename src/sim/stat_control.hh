@@ -41,6 +41,9 @@
 #ifndef __SIM_STAT_CONTROL_HH__
 #define __SIM_STAT_CONTROL_HH__
 
+#include <string>
+#include <vector>
+
 #include "base/compiler.hh"
 #include "base/types.hh"
 #include "sim/cur_tick.hh"
@@ -81,6 +84,29 @@ void schedStatEvent(bool dump, bool reset, Tick when = curTick(),
  * @param period The period at which the dumping should occur.
  */
 void periodicStatDump(Tick period = 0);
+
+/**
+ * Start publishing snapshots of the stats to the clients of a local
+ * socket as the simulation runs, see statistics::Publisher. Snapshots
+ * are taken every given amount of simulated time, host time, or both.
+ * @param path Path of the socket, relative to the output directory.
+ * @param patterns Stats to publish, all of them if empty.
+ * @param period Simulated time between snapshots, 0 to disable.
+ * @param host_period Host seconds between snapshots, 0 to disable.
+ * @param ring_size Size in bytes of the buffer of pending snapshots.
+ */
+void startPublisher(const std::string &path,
+                    const std::vector<std::string> &patterns,
+                    Tick period, double host_period, size_t ring_size);
+
+/**
+ * Schedule a snapshot of the stats to publish. This does nothing if the
+ * publisher is not started.
+ * @param when When the snapshot should be taken.
+ * @param repeat How often the snapshot should repeat. Set 0 to disable
+ * repeating.
+ */
+void schedPublishEvent(Tick when = curTick(), Tick repeat = 0);
 } // namespace statistics
 } // namespace gem5
 
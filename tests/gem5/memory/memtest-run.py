@@ -24,12 +24,27 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+import argparse
+
 import m5
 from m5.objects import *
 
 m5.util.addToPath("../../../configs/")
 from common.Caches import *
 
+parser = argparse.ArgumentParser()
+parser.add_argument(
+    "--atomic", action="store_true", help="Use atomic (non-timing) mode"
+)
+parser.add_argument(
+    "--snoop-filter-size",
+    type=str,
+    default=None,
+    help="Capacity of a fully associative snoop filter in front of the "
+    "L2, small enough for the L1s to cause back-invalidations",
+)
+args = parser.parse_args()
+
 # MAX CORES IS 8 with the fals sharing method
 nb_cores = 8
 cpus = [MemTest(max_loads=1e5, progress_interval=1e4) for i in range(nb_cores)]
@@ -49,6 +64,11 @@ system.cpu_clk_domain = SrcClockDomain(
 )
 
 system.toL2Bus = L2XBar(clk_domain=system.cpu_clk_domain)
+if args.snoop_filter_size:
+    size = m5.util.convert.toMemorySize(args.snoop_filter_size)
+    lines = size // system.cache_line_size.value
+    system.toL2Bus.snoop_filter.max_capacity = args.snoop_filter_size
+    system.toL2Bus.snoop_filter.assoc = lines
 system.l2c = L2Cache(clk_domain=system.cpu_clk_domain, size="64kB", assoc=8)
 system.l2c.cpu_side = system.toL2Bus.mem_side_ports
 
@@ -74,7 +94,7 @@ system.physmem.port = system.membus.mem_side_ports
 # -----------------------
 
 root = Root(full_system=False, system=system)
-root.system.mem_mode = "timing"
+root.system.mem_mode = "atomic" if args.atomic else "timing"
 
 m5.instantiate()
 exit_event = m5.simulate()
@@ -70,6 +70,25 @@ gem5_verify_config(
     length=constants.long_tag,
 )
 
+# A snoop filter much smaller than the L1s makes it back-invalidate
+# lines all the time, including lines with a pending writeback, whose
+# dirty data must not be lost
+for name, args in (
+    ("memtest-small-snoop-filter", ["--snoop-filter-size=4KiB"]),
+    (
+        "memtest-small-snoop-filter-atomic",
+        ["--snoop-filter-size=4KiB", "--atomic"],
+    ),
+):
+    gem5_verify_config(
+        name=name,
+        verifiers=(),  # MemTest panics on a data mismatch
+        config=joinpath(getcwd(), "memtest-run.py"),
+        config_args=args,
+        valid_isas=(constants.null_tag,),
+        length=constants.long_tag,
+    )
+
 null_tests = [
     ("garnet_synth_traffic", None, ["--sim-cycles", "5000000"]),
     ("memcheck", None, ["--maxtick", "2000000000", "--prefetchers"]),
@@ -119,9 +138,39 @@ null_tests = [
         ],
     ),
     ("ruby_random_test", None, ["--maxloads", "5000"]),
+    (
+        "ruby_random_test-analytical",
+        "ruby_random_test",
+        ["--maxloads", "5000", "--network=analytical"],
+    ),
     ("ruby_direct_test", None, ["--requests", "50000"]),
 ]
 
+# The L1 transitions triggered by the responses of the directory must be
+# profiled with the directory as their requestor, which is only known
+# before the transition pops the response
+gem5_verify_config(
+    name="ruby_random_test-transition-profile",
+    fixtures=(),
+    verifiers=(
+        verifier.MatchFileRegex(
+            r'.*"Directory_0"\]', ["system.ruby.transitions.json"]
+        ),
+    ),
+    config=joinpath(
+        config.base_dir, "configs", "example", "ruby_random_test.py"
+    ),
+    config_args=[
+        "--maxloads",
+        "1000",
+        "--ruby-transition-sample-period",
+        "1",
+    ],
+    valid_isas=(constants.null_tag,),
+    valid_hosts=constants.supported_hosts,
+    length=constants.long_tag,
+)
+
 for test_name, basename_noext, args in null_tests:
     if basename_noext == None:
         basename_noext = test_name
@@ -41,11 +41,15 @@
 Built in test cases that verify particular details about a gem5 run.
 """
 import json
+import math
 import os
 import re
 
 from testlib import test_util
-from testlib.configuration import constants
+from testlib.configuration import (
+    config,
+    constants,
+)
 from testlib.helper import (
     diff_out_file,
     joinpath,
@@ -80,6 +84,91 @@ class CheckH5StatsExist(Verifier):
             test_util.fail("Could not find h5 stats file %s", h5_file)
 
 
+class MatchColumnarStats(Verifier):
+    """
+    Checks that a columnar stat file holds the values of the text stat
+    file dumped along with it, by loading it with util/stats_columnar.py.
+    This covers the delta dumps, which only hold the changed values and
+    are filled in by the reader.
+    """
+
+    def __init__(self, stats_file="stats.bin", text_file="stats.txt"):
+        super().__init__()
+        self.stats_file = stats_file
+        self.text_file = text_file
+
+    @staticmethod
+    def _text_dumps(path):
+        """Values of each dump of a text stat file, as strings by name."""
+        dumps = []
+        with open(path) as f:
+            for line in f:
+                if line.startswith("---------- Begin"):
+                    dumps.append({})
+                elif dumps and line.strip() and not line.startswith("-"):
+                    fields = line.split()
+                    dumps[-1][fields[0]] = fields[1]
+        return dumps
+
+    @staticmethod
+    def _matches(text, value):
+        """Check a value against its text, printed in fixed point."""
+        expected = float(text)
+        if not math.isfinite(expected):
+            return text == str(value)
+        # Allow for the rounding to the printed decimals, and for the
+        # rounding of large values when parsing the text
+        decimals = len(text.partition(".")[2])
+        tolerance = 0.5 * 10**-decimals + abs(expected) * 1e-15
+        return abs(value - expected) <= tolerance
+
+    def test(self, params):
+        import importlib.util
+
+        tempdir = params.fixtures[constants.tempdir_fixture_name].path
+        spec = importlib.util.spec_from_file_location(
+            "stats_columnar",
+            joinpath(config.base_dir, "util", "stats_columnar.py"),
+        )
+        stats_columnar = importlib.util.module_from_spec(spec)
+        spec.loader.exec_module(stats_columnar)
+
+        columns, dumps = stats_columnar.read(
+            joinpath(tempdir, self.stats_file)
+        )
+        frame = stats_columnar.load(joinpath(tempdir, self.stats_file))
+        text_dumps = self._text_dumps(joinpath(tempdir, self.text_file))
+
+        if len(text_dumps) < 2 or len(frame) != len(text_dumps):
+            test_util.fail(
+                f"Expected the same number of dumps, and at least two, in "
+                f"{self.text_file} ({len(text_dumps)}) and "
+                f"{self.stats_file} ({len(frame)})"
+            )
+        if all(len(ids) == len(columns) for _, ids, _ in dumps[1:]):
+            test_util.fail(f"No delta dump found in {self.stats_file}")
+
+        compared = 0
+        for (tick, row), text in zip(frame.iterrows(), text_dumps):
+            if text.get("finalTick") != str(tick):
+                test_util.fail(
+                    f"Dump at tick {tick} does not match finalTick "
+                    f"{text.get('finalTick')}"
+                )
+            for name, value in row.items():
+                if name not in text:
+                    continue
+                if not self._matches(text[name], value):
+                    test_util.fail(
+                        f"{name} at tick {tick} is {value} in "
+                        f"{self.stats_file} and {text[name]} in "
+                        f"{self.text_file}"
+                    )
+                compared += 1
+        if compared == 0:
+            test_util.fail("No stat found in both stat files")
+
+
 class MatchGoldStandard(Verifier):
     """
     Compares a standard output to the test output and passes if they match,
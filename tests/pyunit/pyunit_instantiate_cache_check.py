@@ -0,0 +1,90 @@
+# Copyright (c) 2024 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+import os
+import sys
+import tempfile
+import unittest
+from types import SimpleNamespace
+from unittest import mock
+
+from m5.instantiate_cache import _cache_key
+
+
+class InstantiateCacheKeyTestSuite(unittest.TestCase):
+    """Test that the key of the instantiation cache covers the
+    configuration script"""
+
+    def setUp(self):
+        self.dir = tempfile.TemporaryDirectory()
+        self.script = os.path.join(self.dir.name, "config.py")
+
+    def tearDown(self):
+        self.dir.cleanup()
+
+    def _write(self, source):
+        with open(self.script, "w") as f:
+            f.write(source)
+
+    def _key(self, options, argv):
+        with mock.patch.object(sys, "argv", argv):
+            return _cache_key(options)
+
+    def test_script_file(self):
+        options = SimpleNamespace(c=None, m=None)
+        argv = [self.script, "--cpus", "4"]
+
+        self._write("num_cpus = 4\n")
+        key = self._key(options, argv)
+        self.assertEqual(self._key(options, argv), key)
+
+        self._write("num_cpus = 8\n")
+        self.assertNotEqual(self._key(options, argv), key)
+
+    def test_script_string(self):
+        argv = ["-c", "--cpus", "4"]
+        key = self._key(SimpleNamespace(c=["num_cpus = 4", []], m=None), argv)
+        self.assertEqual(
+            self._key(SimpleNamespace(c=["num_cpus = 4", []], m=None), argv),
+            key,
+        )
+        self.assertNotEqual(
+            self._key(SimpleNamespace(c=["num_cpus = 8", []], m=None), argv),
+            key,
+        )
+
+    def test_script_module(self):
+        options = SimpleNamespace(c=None, m=["config_module", []])
+        argv = ["config_module"]
+        module = os.path.join(self.dir.name, "config_module.py")
+        with mock.patch.object(sys, "path", [self.dir.name] + sys.path):
+            with open(module, "w") as f:
+                f.write("num_cpus = 4\n")
+            key = self._key(options, argv)
+
+            with open(module, "w") as f:
+                f.write("num_cpus = 8\n")
+            self.assertNotEqual(self._key(options, argv), key)
@@ -0,0 +1,83 @@
+# Copyright (c) 2024 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+import unittest
+
+from m5.sampling import (
+    _aggregate,
+    _vector_values,
+)
+
+
+class SamplingStatsTestSuite(unittest.TestCase):
+    """Test that the sampled stats are named as in stats.txt"""
+
+    def test_single_element(self):
+        # Scalar formulas, e.g. the IPC, are single element vectors
+        self.assertEqual(
+            _vector_values("system.cpu.ipc", [1.5], [], 1.5, False),
+            {"system.cpu.ipc": 1.5},
+        )
+        self.assertEqual(
+            _vector_values("system.cpu.ipc", [1.5], ["only"], 1.5, True),
+            {"system.cpu.ipc": 1.5},
+        )
+
+    def test_indexed(self):
+        self.assertEqual(
+            _vector_values("misses", [1, 2, 3], [], 6, False),
+            {"misses::0": 1, "misses::1": 2, "misses::2": 3},
+        )
+        self.assertEqual(
+            _vector_values("misses", [1, 2], [], 3, True),
+            {"misses::0": 1, "misses::1": 2, "misses::total": 3},
+        )
+
+    def test_subnames(self):
+        # Only the named elements are printed once there are subnames
+        self.assertEqual(
+            _vector_values("hits", [1, 2, 3], ["read", "", "write"], 6, 0),
+            {"hits::read": 1, "hits::write": 3},
+        )
+
+    def test_aggregate(self):
+        samples = [
+            {
+                "weight": 1,
+                "stats": _vector_values(
+                    "system.detailed_cpu.ipc", [1.0], [], 1.0, False
+                ),
+            },
+            {
+                "weight": 1,
+                "stats": _vector_values(
+                    "system.detailed_cpu.ipc", [2.0], [], 2.0, False
+                ),
+            },
+        ]
+        result = _aggregate(samples)
+        self.assertAlmostEqual(result["system.detailed_cpu.ipc"]["mean"], 1.5)
+        self.assertEqual(result["system.detailed_cpu.ipc"]["samples"], 2)
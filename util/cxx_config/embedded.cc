@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2024 The Regents of the University of California
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *
+ *  Demonstration of the embedded simulation interface of sim/embedded.hh.
+ *  Loads a config.ini, optionally restores a checkpoint, runs for a
+ *  number of ticks, prints the stats matching a prefix and optionally
+ *  checkpoints the simulation.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "sim/embedded.hh"
+
+int
+main(int argc, char **argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+            << " <config-file.ini> <ticks> [ <stat prefix> ]"
+            " [ -r <restore dir> ] [ -s <checkpoint dir> ]\n";
+        return EXIT_FAILURE;
+    }
+
+    const std::string config_file(argv[1]);
+    const uint64_t ticks = std::stoull(argv[2]);
+    std::string prefix, restore_dir, checkpoint_dir;
+
+    for (int i = 3; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "-r" && i + 1 < argc)
+            restore_dir = argv[++i];
+        else if (arg == "-s" && i + 1 < argc)
+            checkpoint_dir = argv[++i];
+        else
+            prefix = arg;
+    }
+
+    try {
+        gem5::EmbeddedSimulation sim(config_file);
+        sim.instantiate(restore_dir);
+
+        auto exit = sim.run(ticks);
+        std::cerr << "Exit at tick " << exit.tick << ", cause: "
+            << exit.cause << '\n';
+
+        for (const auto &[name, value] : sim.stats()) {
+            if (name.compare(0, prefix.size(), prefix) == 0)
+                std::cout << name << ' ' << value << '\n';
+        }
+
+        if (!checkpoint_dir.empty())
+            sim.checkpoint(checkpoint_dir);
+    } catch (gem5::EmbeddedSimulation::Error &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -35,12 +35,15 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-# This script is used to dump protobuf packet traces to ASCII
-# format.
+# This script is used to dump protobuf and binary packet traces to ASCII
+# format, and to convert protobuf packet traces to the binary format read
+# and written by gem5 (see src/mem/packet_trace.hh).
 
 import os
+import struct
 import subprocess
 import sys
+import zlib
 
 import protolib
 
@@ -49,68 +52,233 @@ util_dir = os.path.dirname(os.path.realpath(__file__))
 subprocess.check_call(["make", "--quiet", "-C", util_dir, "packet_pb2.py"])
 import packet_pb2
 
+# Binary packet trace format, see src/mem/packet_trace.hh
+BINARY_MAGIC = b"gem5ptrc"
+BINARY_VERSION = 1
+BINARY_RECORD = struct.Struct("<QQQQIIII")
+BINARY_BLOCK = struct.Struct("<III")
+BINARY_BLOCK_RECORDS = 1 << 16
+RAW_BLOCK = 0
+DEFLATE_BLOCK = 1
+HAS_FLAGS = 1 << 0
+HAS_PKT_ID = 1 << 1
+HAS_PC = 1 << 2
 
-def main():
-    if len(sys.argv) != 3:
-        print("Usage: ", sys.argv[0], " <protobuf input> <ASCII output>")
-        exit(-1)
 
-    # Open the file in read mode
-    proto_in = protolib.openFileRd(sys.argv[1])
+def is_binary_trace(path):
+    with open(path, "rb") as f:
+        return f.read(len(BINARY_MAGIC)) == BINARY_MAGIC
 
-    try:
-        ascii_out = open(sys.argv[2], "w")
-    except OSError:
-        print("Failed to open ", sys.argv[2], " for writing")
-        exit(-1)
+
+def read_string(f):
+    (length,) = struct.unpack("<I", f.read(4))
+    return f.read(length).decode()
+
+
+def write_string(f, s):
+    data = s.encode()
+    f.write(struct.pack("<I", len(data)))
+    f.write(data)
+
+
+def read_binary(path):
+    """Read a binary packet trace, returning its header and a generator
+    of (pkt_id, cmd, addr, size, flags, tick, pc) tuples, where the
+    optional fields are None when not present"""
+    f = open(path, "rb")
+    if f.read(len(BINARY_MAGIC)) != BINARY_MAGIC:
+        raise ValueError(f"{path} is not a binary packet trace")
+    (version, tick_freq) = struct.unpack("<IQ", f.read(12))
+    if version != BINARY_VERSION:
+        raise ValueError(f"Unsupported binary packet trace version {version}")
+    obj_id = read_string(f)
+    (num_ids,) = struct.unpack("<I", f.read(4))
+    id_strings = []
+    for _ in range(num_ids):
+        (key,) = struct.unpack("<I", f.read(4))
+        id_strings.append((key, read_string(f)))
+
+    def packets():
+        while True:
+            block_header = f.read(BINARY_BLOCK.size)
+            if not block_header:
+                break
+            num, encoding, stored_size = BINARY_BLOCK.unpack(block_header)
+            data = f.read(stored_size)
+            if encoding == DEFLATE_BLOCK:
+                data = zlib.decompress(data)
+            for fields in BINARY_RECORD.iter_unpack(data):
+                tick, addr, pc, pkt_id, cmd, size, flags, valid = fields
+                yield (
+                    pkt_id if valid & HAS_PKT_ID else None,
+                    cmd,
+                    addr,
+                    size,
+                    flags if valid & HAS_FLAGS else None,
+                    tick,
+                    pc if valid & HAS_PC else None,
+                )
+        f.close()
+
+    return (obj_id, tick_freq, id_strings), packets()
+
+
+def read_protobuf(path):
+    """Read a protobuf packet trace, returning the same as read_binary"""
+    proto_in = protolib.openFileRd(path)
 
     # Read the magic number in 4-byte Little Endian
     magic_number = proto_in.read(4).decode()
 
     if magic_number != "gem5":
-        print("Unrecognized file", sys.argv[1])
-        exit(-1)
-
-    print("Parsing packet header")
+        raise ValueError(f"Unrecognized file {path}")
 
     # Add the packet header
     header = packet_pb2.PacketHeader()
     protolib.decodeMessage(proto_in, header)
+    id_strings = [(i.key, i.value) for i in header.id_strings]
 
-    print("Object id:", header.obj_id)
-    print("Tick frequency:", header.tick_freq)
+    def packets():
+        packet = packet_pb2.Packet()
+        # Decode the packet messages until we hit the end of the file
+        while protolib.decodeMessage(proto_in, packet):
+            yield (
+                packet.pkt_id if packet.HasField("pkt_id") else None,
+                packet.cmd,
+                packet.addr,
+                packet.size,
+                packet.flags if packet.HasField("flags") else None,
+                packet.tick,
+                packet.pc if packet.HasField("pc") else None,
+            )
+        proto_in.close()
 
-    for id_string in header.id_strings:
-        print("Master id %d: %s" % (id_string.key, id_string.value))
+    return (header.obj_id, header.tick_freq, id_strings), packets()
 
-    print("Parsing packets")
 
+def write_binary(path, header, packets):
+    """Write a binary packet trace with deflate compressed blocks"""
+    obj_id, tick_freq, id_strings = header
     num_packets = 0
-    packet = packet_pb2.Packet()
+    with open(path, "wb") as out:
+        out.write(BINARY_MAGIC)
+        out.write(struct.pack("<IQ", BINARY_VERSION, tick_freq))
+        write_string(out, obj_id)
+        out.write(struct.pack("<I", len(id_strings)))
+        for key, value in id_strings:
+            out.write(struct.pack("<I", key))
+            write_string(out, value)
+
+        def write_block(records):
+            raw = b"".join(records)
+            data = zlib.compress(raw, 1)
+            encoding = DEFLATE_BLOCK
+            if len(data) >= len(raw):
+                data, encoding = raw, RAW_BLOCK
+            out.write(BINARY_BLOCK.pack(len(records), encoding, len(data)))
+            out.write(data)
+
+        records = []
+        for pkt_id, cmd, addr, size, flags, tick, pc in packets:
+            valid = 0
+            if pkt_id is not None:
+                valid |= HAS_PKT_ID
+            if flags is not None:
+                valid |= HAS_FLAGS
+            if pc is not None:
+                valid |= HAS_PC
+            records.append(
+                BINARY_RECORD.pack(
+                    tick,
+                    addr,
+                    pc or 0,
+                    pkt_id or 0,
+                    cmd,
+                    size,
+                    flags or 0,
+                    valid,
+                )
+            )
+            num_packets += 1
+            if len(records) == BINARY_BLOCK_RECORDS:
+                write_block(records)
+                records = []
+        if records:
+            write_block(records)
+    return num_packets
+
+
+def write_ascii(path, packets):
+    try:
+        ascii_out = open(path, "w")
+    except OSError:
+        print("Failed to open ", path, " for writing")
+        exit(-1)
 
-    # Decode the packet messages until we hit the end of the file
-    while protolib.decodeMessage(proto_in, packet):
+    num_packets = 0
+    for pkt_id, cmd, addr, size, flags, tick, pc in packets:
         num_packets += 1
         # ReadReq is 1 and WriteReq is 4 in src/mem/packet.hh Command enum
-        cmd = "r" if packet.cmd == 1 else ("w" if packet.cmd == 4 else "u")
-        if packet.HasField("pkt_id"):
-            ascii_out.write(f"{packet.pkt_id},")
-        if packet.HasField("flags"):
-            ascii_out.write(
-                f"{cmd},{packet.addr},{packet.size},{packet.flags},{packet.tick}"
-            )
+        cmd = "r" if cmd == 1 else ("w" if cmd == 4 else "u")
+        if pkt_id is not None:
+            ascii_out.write(f"{pkt_id},")
+        if flags is not None:
+            ascii_out.write(f"{cmd},{addr},{size},{flags},{tick}")
         else:
-            ascii_out.write(f"{cmd},{packet.addr},{packet.size},{packet.tick}")
-        if packet.HasField("pc"):
-            ascii_out.write(f",{packet.pc}\n")
+            ascii_out.write(f"{cmd},{addr},{size},{tick}")
+        if pc is not None:
+            ascii_out.write(f",{pc}\n")
         else:
             ascii_out.write("\n")
 
-    print("Parsed packets:", num_packets)
-
     # We're done
     ascii_out.close()
-    proto_in.close()
+    return num_packets
+
+
+def main():
+    args = sys.argv[1:]
+    to_binary = "--binary" in args
+    if to_binary:
+        args.remove("--binary")
+
+    if len(args) != 2:
+        print(
+            "Usage: ",
+            sys.argv[0],
+            " [--binary] <protobuf or binary input> <output>",
+        )
+        print("  --binary  convert a protobuf trace to a binary trace")
+        print("            instead of dumping it to ASCII")
+        exit(-1)
+
+    try:
+        if is_binary_trace(args[0]):
+            if to_binary:
+                print(args[0], "already is a binary trace")
+                exit(-1)
+            header, packets = read_binary(args[0])
+        else:
+            header, packets = read_protobuf(args[0])
+    except (OSError, ValueError) as e:
+        print(e)
+        exit(-1)
+
+    obj_id, tick_freq, id_strings = header
+    print("Object id:", obj_id)
+    print("Tick frequency:", tick_freq)
+
+    for key, value in id_strings:
+        print("Master id %d: %s" % (key, value))
+
+    print("Parsing packets")
+
+    if to_binary:
+        num_packets = write_binary(args[1], header, packets)
+    else:
+        num_packets = write_ascii(args[1], packets)
+
+    print("Parsed packets:", num_packets)
 
 
 if __name__ == "__main__":
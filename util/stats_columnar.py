@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2024 The Regents of the University of California
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Reader for the binary columnar stat files written by gem5.
+
+The columnar stat output is enabled with --stats-file=columnar://stats.bin.
+Each dump in the file only holds the values that changed since the previous
+one, this module reconstructs the full value of every stat at every dump.
+
+Example:
+    from stats_columnar import load
+    df = load("m5out/stats.bin")
+    df["system.cpu.ipc"].plot()
+
+It can also be used to convert a file to CSV:
+    stats_columnar.py m5out/stats.bin stats.csv
+
+The stat snapshots published while simulating with
+--stats-publish=stats.sock use the same records, and can be followed with:
+    for tick, values in follow("m5out/stats.sock"):
+        print(tick, values["system.cpu.ipc"])
+"""
+
+import argparse
+import gzip
+import struct
+from collections import namedtuple
+
+MAGIC = b"gem5stcf"
+VERSION = 1
+
+COLUMN_RECORD = 1
+DUMP_RECORD = 2
+
+Column = namedtuple("Column", ["name", "unit", "desc"])
+
+
+def _open(path):
+    if str(path).endswith(".gz"):
+        return gzip.open(path, "rb")
+    return open(path, "rb")
+
+
+def _read_string(data, offset):
+    (length,) = struct.unpack_from("<H", data, offset)
+    offset += 2
+    return data[offset : offset + length].decode(), offset + length
+
+
+def _check_header(data, source):
+    if data[:8] != MAGIC:
+        raise ValueError(f"{source} is not a columnar stat stream")
+    (version,) = struct.unpack_from("<I", data, 8)
+    if version != VERSION:
+        raise ValueError(f"Unsupported columnar stat version {version}")
+
+
+def _parse(data, offset, columns, dumps):
+    """Parse the records in data from offset, appending the columns and
+    dumps found to the given lists."""
+    import numpy as np
+
+    change_type = np.dtype([("id", "<u4"), ("value", "<f8")])
+    while offset < len(data):
+        kind = data[offset]
+        offset += 1
+        if kind == COLUMN_RECORD:
+            (column_id,) = struct.unpack_from("<I", data, offset)
+            offset += 4
+            name, offset = _read_string(data, offset)
+            unit, offset = _read_string(data, offset)
+            desc, offset = _read_string(data, offset)
+            if column_id != len(columns):
+                raise ValueError(f"Unexpected column id {column_id}")
+            columns.append(Column(name, unit, desc))
+        elif kind == DUMP_RECORD:
+            tick, count = struct.unpack_from("<QI", data, offset)
+            offset += 12
+            if offset + count * change_type.itemsize > len(data):
+                # The simulation was interrupted during a dump
+                break
+            changes = np.frombuffer(
+                data, dtype=change_type, count=count, offset=offset
+            )
+            offset += count * change_type.itemsize
+            dumps.append((tick, changes["id"], changes["value"]))
+        else:
+            raise ValueError(f"Unknown record kind {kind} at {offset - 1}")
+
+
+def read(path):
+    """Read a columnar stat file.
+
+    Returns a tuple (columns, dumps), where columns is a list of Column
+    indexed by column id and dumps a list of (tick, ids, values), with the
+    ids and values of the columns that changed in the dump.
+    """
+    with _open(path) as f:
+        data = f.read()
+
+    _check_header(data, path)
+    columns = []
+    dumps = []
+    _parse(data, 12, columns, dumps)
+    return columns, dumps
+
+
+def follow(path):
+    """Follow the stat snapshots published by a running simulation.
+
+    Connects to the Unix socket at path, or to the abstract socket name
+    if path is '@name', and yields a tuple (tick, values) for each
+    snapshot, values being a dict of the value of each published stat
+    by name. Returns when the simulation ends.
+    """
+    import socket
+
+    def recv_exactly(sock, size):
+        data = bytearray()
+        while len(data) < size:
+            chunk = sock.recv(size - len(data))
+            if not chunk:
+                return None
+            data += chunk
+        return bytes(data)
+
+    address = "\0" + path[1:] if path.startswith("@") else path
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+        sock.connect(address)
+        header = recv_exactly(sock, 12)
+        if header is None:
+            return
+        _check_header(header, path)
+
+        columns = []
+        while True:
+            length = recv_exactly(sock, 4)
+            if length is None:
+                return
+            message = recv_exactly(sock, struct.unpack("<I", length)[0])
+            if message is None:
+                return
+            dumps = []
+            _parse(message, 0, columns, dumps)
+            for tick, ids, values in dumps:
+                yield tick, {
+                    columns[i].name: v for i, v in zip(ids, values.tolist())
+                }
+
+
+def load(path, stats=None):
+    """Load a columnar stat file into a pandas DataFrame.
+
+    The DataFrame has one row per dump, indexed by the tick of the dump,
+    and one column per stat value. Stats that were not dumped yet are NaN.
+
+    Parameters:
+        path: Path of the stat file, which may be gzip compressed
+        stats: Optional list of the names of the stats to load
+    """
+    import numpy as np
+    import pandas as pd
+
+    columns, dumps = read(path)
+
+    values = np.full((len(dumps), len(columns)), np.nan)
+    changed = np.zeros((len(dumps), len(columns)), dtype=bool)
+    for row, (_, ids, vals) in enumerate(dumps):
+        values[row, ids] = vals
+        changed[row, ids] = True
+
+    # Carry the last value of each column forward to the dumps where it
+    # did not change
+    last = np.where(changed, np.arange(len(dumps))[:, None], 0)
+    np.maximum.accumulate(last, axis=0, out=last)
+    values = values[last, np.arange(len(columns))]
+    seen = np.logical_or.accumulate(changed, axis=0)
+    values[~seen] = np.nan
+
+    df = pd.DataFrame(
+        values,
+        index=pd.Index([tick for tick, _, _ in dumps], name="tick"),
+        columns=[c.name for c in columns],
+    )
+    if stats is not None:
+        df = df[list(stats)]
+    return df
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert a gem5 columnar stat file to CSV"
+    )
+    parser.add_argument("input", help="Columnar stat file")
+    parser.add_argument("output", help="CSV file to write")
+    parser.add_argument(
+        "--stat",
+        action="append",
+        dest="stats",
+        help="Only output the given stat (can be repeated)",
+    )
+    args = parser.parse_args()
+
+    load(args.input, args.stats).to_csv(args.output)
+
+
+if __name__ == "__main__":
+    main()